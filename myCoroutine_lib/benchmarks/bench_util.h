@@ -0,0 +1,101 @@
+#ifndef __MYCOROUTINE_BENCH_UTIL_H_
+#define __MYCOROUTINE_BENCH_UTIL_H_
+
+/**
+ * @file bench_util.h
+ * @brief 基准测试共用的辅助函数
+ * @details 被测的IOManager一律以use_caller=false构造：调用者线程只负责投递任务和等待结果，
+ *          工作线程数就是命令行指定的线程数
+ */
+
+#include "mycoroutine/iomanager.h"   // IO事件管理器
+#include "mycoroutine/thread.h"      // Semaphore
+#include "mycoroutine/utils.h"       // steady_us
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mycoroutine {
+namespace bench {
+
+/**
+ * @brief 获取单调时钟的当前时间（微秒）
+ */
+inline uint64_t now_us()
+{
+    return steady_us();
+}
+
+/**
+ * @brief 等待一组任务全部完成
+ * @details 挂起在IO、锁或加载上的协程不计入调度器的待处理任务，析构IOManager之前必须先等它们结束；
+ *          调用者线程阻塞在信号量上，不轮询，也不受调用者线程是否开启hook的影响
+ */
+class Completion
+{
+public:
+    /**
+     * @param count 需要等待的任务数
+     */
+    explicit Completion(size_t count): m_count(count) {}
+
+    /**
+     * @brief 任务结束时调用一次
+     */
+    void done() {m_sem.signal();}
+
+    /**
+     * @brief 等待count次done()
+     */
+    void wait()
+    {
+        for(size_t i = 0; i < m_count; ++i)
+        {
+            m_sem.wait();
+        }
+    }
+
+private:
+    Semaphore m_sem;
+    size_t m_count;
+};
+
+/**
+ * @brief 计时阶段：投递count个任务并等待全部完成
+ * @param iom 执行任务的IO管理器
+ * @param count 任务数
+ * @param task 任务函数，参数为任务序号
+ * @param during 投递之后、等待之前在调用者线程中执行（如驱动负载的客户端线程），计入耗时
+ * @return 从投递第一个任务到最后一个任务完成的秒数，不含IOManager的启动和停止
+ */
+template<class Task, class During>
+double timed_phase(IOManager& iom, size_t count, Task task, During during)
+{
+    Completion completion(count);
+    uint64_t start = now_us();
+    for(size_t i = 0; i < count; ++i)
+    {
+        iom.scheduleLock([&task, &completion, i]()
+        {
+            task(i);
+            completion.done();
+        });
+    }
+    during();
+    completion.wait();
+    return (now_us() - start) / 1e6;
+}
+
+/**
+ * @brief 计时阶段：投递count个任务并等待全部完成
+ */
+template<class Task>
+double timed_phase(IOManager& iom, size_t count, Task task)
+{
+    return timed_phase(iom, count, task, [](){});
+}
+
+} // end namespace bench
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_BENCH_UTIL_H_
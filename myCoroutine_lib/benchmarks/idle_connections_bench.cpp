@@ -0,0 +1,347 @@
+/**
+ * @file idle_connections_bench.cpp
+ * @brief 空闲长连接内存与扩展性基准测试
+ * @details 建立大量本地连接（socketpair或回环TCP），每个连接一个协程挂起在hook后的recv上，
+ *          统计每连接内存占用、epoll注册耗时以及随机抽样连接的唤醒延迟，并在多个线程数下分别运行。
+ *
+ * 用法：idle_connections_bench [-n 连接数] [-t 线程数列表] [-s 抽样数] [-m socketpair|tcp] [-w]
+ * 例如：idle_connections_bench -n 1000000 -t 1,2,4,8 -s 2000
+ */
+
+#include "mycoroutine/iomanager.h"   // IO事件管理器
+#include "mycoroutine/hook.h"        // 系统调用钩子
+#include "mycoroutine/fd_manager.h"  // 文件描述符管理器
+#include "mycoroutine/histogram.h"   // 延迟直方图
+#include "bench_util.h"              // now_us
+
+#include <unistd.h>         // close/sysconf
+#include <sys/socket.h>     // socketpair
+#include <sys/resource.h>   // setrlimit
+#include <netinet/in.h>     // sockaddr_in
+#include <arpa/inet.h>      // inet_addr
+#include <sched.h>          // sched_yield
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace mycoroutine;
+using namespace mycoroutine::bench;
+
+/**
+ * @brief 命令行参数
+ */
+struct Options
+{
+    size_t conns = 100000;                 // 连接数
+    std::vector<size_t> threads{1, 2, 4};  // 需要测试的工作线程数
+    size_t samples = 1000;                 // 唤醒延迟抽样数
+    bool tcp = false;                      // 使用回环TCP连接代替socketpair
+    bool warmup = false;                   // 启动时按RLIMIT_NOFILE预分配fd表
+};
+
+/**
+ * @brief 单次运行的结果
+ */
+struct Result
+{
+    size_t threads = 0;        // 工作线程数
+    size_t conns = 0;          // 连接数
+    double registerUs = 0;     // 平均每连接注册耗时（微秒，含协程创建和epoll_ctl）
+    double rssBytes = 0;       // 平均每连接新增RSS（字节）
+    uint64_t wakeP50 = 0;      // 唤醒延迟P50（微秒）
+    uint64_t wakeP99 = 0;      // 唤醒延迟P99（微秒）
+    uint64_t wakeMax = 0;      // 唤醒延迟最大值（微秒）
+    double teardownMs = 0;     // 关闭所有连接并等待协程退出的耗时（毫秒）
+};
+
+// 抽样唤醒：发送时间（微秒）、已唤醒次数、已退出协程数
+static std::atomic<uint64_t> s_sendTime{0};
+static std::atomic<uint64_t> s_woken{0};
+static std::atomic<uint64_t> s_exited{0};
+static Histogram s_wakeup;
+
+/**
+ * @brief 获取当前进程的常驻内存（字节）
+ */
+static size_t current_rss()
+{
+    FILE* fp = fopen("/proc/self/statm", "r");
+    if(!fp)
+    {
+        return 0;
+    }
+    unsigned long size = 0, resident = 0;
+    if(fscanf(fp, "%lu %lu", &size, &resident) != 2)
+    {
+        resident = 0;
+    }
+    fclose(fp);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * @brief 把文件描述符上限提高到硬上限
+ * @return 可用的文件描述符数量
+ */
+static size_t raise_nofile_limit()
+{
+    struct rlimit rl;
+    getrlimit(RLIMIT_NOFILE, &rl);
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+    getrlimit(RLIMIT_NOFILE, &rl);
+    return rl.rlim_cur;
+}
+
+/**
+ * @brief 连接处理协程，挂起在hook后的recv上
+ * @param fd 连接的本端文件描述符
+ */
+static void park_connection(int fd)
+{
+    set_hook_enable(true);
+
+    char c;
+    while(true)
+    {
+        ssize_t n = recv(fd, &c, 1, 0);
+        if(n <= 0)
+        {
+            break;
+        }
+        s_wakeup.record(now_us() - s_sendTime.load(std::memory_order_acquire));
+        s_woken.fetch_add(1, std::memory_order_release);
+    }
+    s_exited.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief 建立连接
+ * @param opt 命令行参数
+ * @param local 输出参数，本端（由协程读取）
+ * @param peer 输出参数，对端（由主线程写入）
+ * @return 成功建立的连接数
+ */
+static size_t open_connections(const Options& opt, std::vector<int>& local, std::vector<int>& peer)
+{
+    int listen_fd = -1;
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if(opt.tcp)
+    {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        if(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) || listen(listen_fd, 4096) ||
+           getsockname(listen_fd, (struct sockaddr*)&addr, &len))
+        {
+            perror("listen");
+            exit(1);
+        }
+    }
+
+    for(size_t i = 0; i < opt.conns; ++i)
+    {
+        int fds[2] = {-1, -1};
+        if(!opt.tcp)
+        {
+            if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+            {
+                perror("socketpair");
+                break;
+            }
+        }
+        else
+        {
+            // 每个源地址最多约6万个临时端口，超过后换用127.0.0.x的下一个地址
+            fds[1] = socket(AF_INET, SOCK_STREAM, 0);
+            struct sockaddr_in src;
+            memset(&src, 0, sizeof(src));
+            src.sin_family = AF_INET;
+            src.sin_addr.s_addr = htonl(0x7f000001 + (uint32_t)(i / 50000) + 1);
+            if(fds[1] < 0 || bind(fds[1], (struct sockaddr*)&src, sizeof(src)) ||
+               connect(fds[1], (struct sockaddr*)&addr, sizeof(addr)))
+            {
+                perror("connect");
+                if(fds[1] >= 0)
+                {
+                    close(fds[1]);
+                }
+                break;
+            }
+            fds[0] = accept(listen_fd, nullptr, nullptr);
+            if(fds[0] < 0)
+            {
+                perror("accept");
+                close(fds[1]);
+                break;
+            }
+        }
+        local.push_back(fds[0]);
+        peer.push_back(fds[1]);
+    }
+
+    if(listen_fd >= 0)
+    {
+        close(listen_fd);
+    }
+    return local.size();
+}
+
+/**
+ * @brief 在指定线程数下运行一次测试
+ * @param opt 命令行参数
+ * @param threads 工作线程数
+ * @return 测试结果
+ */
+static Result run_once(const Options& opt, size_t threads)
+{
+    Result result;
+    result.threads = threads;
+
+    std::vector<int> local, peer;
+    local.reserve(opt.conns);
+    peer.reserve(opt.conns);
+    size_t conns = open_connections(opt, local, peer);
+    result.conns = conns;
+    if(conns == 0)
+    {
+        return result;
+    }
+
+    s_woken = 0;
+    s_exited = 0;
+    s_wakeup.reset();
+
+    size_t rss_before = current_rss();
+    {
+        WarmupConfig warmup;
+        warmup.fd_table_from_rlimit = opt.warmup;
+        IOManager iom(threads, false, "bench", warmup);
+
+        // 1 注册：创建协程并等待全部挂起在epoll上
+        uint64_t start = now_us();
+        for(size_t i = 0; i < conns; ++i)
+        {
+            FdMgr::GetInstance()->get(local[i], true);
+            int fd = local[i];
+            iom.scheduleLock([fd](){ park_connection(fd); });
+        }
+        while(iom.getPendingEventCount() < conns)
+        {
+            usleep(1000);
+        }
+        result.registerUs = (double)(now_us() - start) / conns;
+        result.rssBytes = ((double)current_rss() - (double)rss_before) / conns;
+
+        // 2 唤醒：逐个唤醒随机抽样的连接，测量从write到协程恢复执行的延迟
+        std::mt19937_64 rng(12345);
+        for(size_t i = 0; i < opt.samples; ++i)
+        {
+            size_t idx = rng() % conns;
+            uint64_t expect = s_woken.load(std::memory_order_acquire) + 1;
+            s_sendTime.store(now_us(), std::memory_order_release);
+            if(write(peer[idx], "x", 1) != 1)
+            {
+                perror("write");
+                break;
+            }
+            while(s_woken.load(std::memory_order_acquire) < expect)
+            {
+                sched_yield();
+            }
+        }
+        result.wakeP50 = s_wakeup.percentile(50);
+        result.wakeP99 = s_wakeup.percentile(99);
+        result.wakeMax = s_wakeup.max();
+
+        // 3 关闭：关闭对端，所有协程读到EOF后退出
+        start = now_us();
+        for(size_t i = 0; i < conns; ++i)
+        {
+            close(peer[i]);
+        }
+        while(s_exited.load(std::memory_order_acquire) < conns)
+        {
+            usleep(1000);
+        }
+        result.teardownMs = (now_us() - start) / 1000.0;
+    }
+
+    for(size_t i = 0; i < conns; ++i)
+    {
+        FdMgr::GetInstance()->del(local[i]);
+        close(local[i]);
+    }
+    return result;
+}
+
+/**
+ * @brief 解析逗号分隔的线程数列表
+ */
+static std::vector<size_t> parse_list(const char* s)
+{
+    std::vector<size_t> out;
+    while(*s)
+    {
+        char* end = nullptr;
+        size_t v = strtoul(s, &end, 10);
+        if(end == s)
+        {
+            break;
+        }
+        if(v > 0)
+        {
+            out.push_back(v);
+        }
+        s = *end == ',' ? end + 1 : end;
+    }
+    return out;
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    int c;
+    while((c = getopt(argc, argv, "n:t:s:m:wh")) != -1)
+    {
+        switch(c)
+        {
+        case 'n': opt.conns = strtoul(optarg, nullptr, 10); break;
+        case 't': opt.threads = parse_list(optarg); break;
+        case 's': opt.samples = strtoul(optarg, nullptr, 10); break;
+        case 'm': opt.tcp = strcmp(optarg, "tcp") == 0; break;
+        case 'w': opt.warmup = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-n conns] [-t 1,2,4] [-s samples] [-m socketpair|tcp] [-w]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // 每个连接占用两个文件描述符，预留少量给epoll、eventfd等
+    size_t limit = raise_nofile_limit();
+    size_t max_conns = limit > 64 ? (limit - 64) / 2 : 0;
+    if(opt.conns > max_conns)
+    {
+        fprintf(stderr, "RLIMIT_NOFILE=%zu, connections capped at %zu\n", limit, max_conns);
+        opt.conns = max_conns;
+    }
+
+    printf("mode=%s conns=%zu samples=%zu warmup=%d\n", opt.tcp ? "tcp" : "socketpair", opt.conns, opt.samples, (int)opt.warmup);
+    printf("%8s %10s %14s %14s %10s %10s %10s %12s\n",
+           "threads", "conns", "register(us)", "rss/conn(B)", "wake p50", "wake p99", "wake max", "teardown(ms)");
+    for(size_t threads : opt.threads)
+    {
+        Result r = run_once(opt, threads);
+        printf("%8zu %10zu %14.2f %14.0f %10lu %10lu %10lu %12.1f\n",
+               r.threads, r.conns, r.registerUs, r.rssBytes,
+               (unsigned long)r.wakeP50, (unsigned long)r.wakeP99, (unsigned long)r.wakeMax, r.teardownMs);
+        fflush(stdout);
+    }
+    return 0;
+}
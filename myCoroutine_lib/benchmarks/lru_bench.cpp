@@ -0,0 +1,231 @@
+/**
+ * @file lru_bench.cpp
+ * @brief 分片LRU缓存基准测试
+ * @details 多个工作线程上的协程按Zipfian分布访问键，每次访问调用getOrLoad()，未命中时加载函数直接算出值；
+ *          对比不同分片数下的吞吐和命中率。分片数为1即一把互斥锁保护的普通LRU，作为对照。
+ *          键经过哈希打散（YCSB的ScrambledZipfian），热点键分布在不同分片上。
+ *          计时前按热度预先放入容量个键，测量的是稳态而不是冷启动
+ *
+ * 用法：lru_bench [-n 每线程操作数] [-k 键空间] [-c 容量] [-z 偏斜度] [-t 工作线程数,...] [-s 分片数,...] [-f 每线程协程数] [-l 加载耗时us]
+ */
+
+#include "mycoroutine/iomanager.h"     // IO事件管理器
+#include "mycoroutine/sharded_lru.h"   // 分片LRU缓存
+#include "bench_util.h"                // timed_phase
+
+#include <unistd.h>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace mycoroutine;
+using namespace mycoroutine::bench;
+
+/**
+ * @brief 命令行参数
+ */
+struct Options
+{
+    size_t ops = 1000000;           // 每个工作线程的操作数
+    size_t keys = 1000000;          // 键空间大小
+    size_t capacity = 100000;       // 缓存容量
+    double theta = 0.99;            // Zipfian偏斜度（YCSB默认0.99）
+    std::string threads = "1,2,4";  // 工作线程数列表
+    std::string shards = "1,16,64"; // 分片数列表
+    size_t fibers = 8;              // 每个工作线程的协程数
+    uint64_t load_us = 0;           // 加载函数耗时（微秒），非0时加载函数在hook后的usleep中挂起协程
+};
+
+/**
+ * @brief Zipfian分布生成器（Gray等人的算法，与YCSB的ZipfianGenerator相同）
+ * @details 预先计算zeta(n)，之后每次生成只需一次随机数和一次pow
+ */
+class Zipfian
+{
+public:
+    Zipfian(size_t n, double theta):
+        m_n(n), m_theta(theta)
+    {
+        m_zetan = zeta(n, theta);
+        double zeta2 = zeta(2, theta);
+        m_alpha = 1.0 / (1.0 - theta);
+        m_eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / m_zetan);
+    }
+
+    /**
+     * @brief 生成[0, n)中的一个排名，0最热
+     * @param seed 调用者的随机数状态（xorshift64）
+     */
+    size_t next(uint64_t& seed) const
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        double u = (double)(seed >> 11) / (double)(1ULL << 53);
+        double uz = u * m_zetan;
+        if(uz < 1.0)
+        {
+            return 0;
+        }
+        if(uz < 1.0 + std::pow(0.5, m_theta))
+        {
+            return 1;
+        }
+        size_t rank = (size_t)(m_n * std::pow(m_eta * u - m_eta + 1.0, m_alpha));
+        return rank < m_n ? rank : m_n - 1;
+    }
+
+private:
+    static double zeta(size_t n, double theta)
+    {
+        double sum = 0;
+        for(size_t i = 1; i <= n; ++i)
+        {
+            sum += 1.0 / std::pow((double)i, theta);
+        }
+        return sum;
+    }
+
+private:
+    size_t m_n;
+    double m_theta;
+    double m_zetan;
+    double m_alpha;
+    double m_eta;
+};
+
+/**
+ * @brief 把排名打散为键（FNV-1a），热点键不集中在相邻的键上
+ */
+static uint64_t scramble(size_t rank, size_t keys)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for(int i = 0; i < 8; ++i)
+    {
+        h ^= (rank >> (i * 8)) & 0xff;
+        h *= 0x100000001b3ULL;
+    }
+    return h % keys;
+}
+
+/**
+ * @brief 解析逗号分隔的数字列表
+ */
+static std::vector<size_t> parse_list(const std::string& s)
+{
+    std::vector<size_t> values;
+    std::stringstream ss(s);
+    std::string item;
+    while(std::getline(ss, item, ','))
+    {
+        if(!item.empty())
+        {
+            values.push_back(strtoul(item.c_str(), nullptr, 10));
+        }
+    }
+    return values;
+}
+
+/**
+ * @brief 运行一轮并输出结果
+ */
+static void run_once(const Options& opt, const Zipfian& zipf, size_t threads, size_t shards)
+{
+    ShardedLru<uint64_t, uint64_t> cache(opt.capacity, shards);
+    size_t fibers = threads * opt.fibers;
+    size_t per_fiber = opt.ops / opt.fibers;
+    std::atomic<size_t> failed{0};
+    WarmupConfig warmup;
+    warmup.hook_enable = opt.load_us > 0;
+
+    ShardedLru<uint64_t, uint64_t>::Loader loader = [&opt](const uint64_t& key, uint64_t& value)
+    {
+        if(opt.load_us)
+        {
+            usleep(opt.load_us);
+        }
+        value = key * 2 + 1;
+        return true;
+    };
+
+    // 预热：放入最热的capacity个键，统计只计算之后的访问
+    for(size_t rank = 0; rank < opt.capacity && rank < opt.keys; ++rank)
+    {
+        uint64_t key = scramble(rank, opt.keys);
+        cache.put(key, key * 2 + 1);
+    }
+    ShardedLruStats base = cache.getStats();
+
+    double seconds = 0;
+    {
+        IOManager iom(threads, false, "lru", warmup);
+        seconds = timed_phase(iom, fibers, [&](size_t i)
+        {
+            uint64_t seed = 0x9e3779b97f4a7c15ULL * (i + 1);
+            for(size_t j = 0; j < per_fiber; ++j)
+            {
+                uint64_t key = scramble(zipf.next(seed), opt.keys);
+                uint64_t value = 0;
+                if(!cache.getOrLoad(key, loader, value) || value != key * 2 + 1)
+                {
+                    ++failed;
+                }
+            }
+        });
+    }
+
+    ShardedLruStats stats = cache.getStats();
+    size_t total = fibers * per_fiber;
+    uint64_t hits = stats.hits - base.hits;
+    double lookups = hits + stats.misses - base.misses;
+    printf("%7zu %7zu %12.0f %9.2f%% %10lu %10lu %8zu\n", threads, cache.getShardCount(), total / seconds,
+           lookups ? hits * 100.0 / lookups : 0.0, (unsigned long)(stats.loads - base.loads),
+           (unsigned long)(stats.evictions - base.evictions), failed.load());
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    int c;
+    while((c = getopt(argc, argv, "n:k:c:z:t:s:f:l:h")) != -1)
+    {
+        switch(c)
+        {
+        case 'n': opt.ops = strtoul(optarg, nullptr, 10); break;
+        case 'k': opt.keys = std::max(1UL, strtoul(optarg, nullptr, 10)); break;
+        case 'c': opt.capacity = strtoul(optarg, nullptr, 10); break;
+        case 'z': opt.theta = strtod(optarg, nullptr); break;
+        case 't': opt.threads = optarg; break;
+        case 's': opt.shards = optarg; break;
+        case 'f': opt.fibers = std::max(1UL, strtoul(optarg, nullptr, 10)); break;
+        case 'l': opt.load_us = strtoull(optarg, nullptr, 10); break;
+        default:
+            fprintf(stderr, "usage: %s [-n ops] [-k keys] [-c capacity] [-z theta] [-t threads,...] [-s shards,...] "
+                    "[-f fibers] [-l load_us]\n", argv[0]);
+            return 1;
+        }
+    }
+    if(opt.theta <= 0 || opt.theta >= 1)
+    {
+        fprintf(stderr, "theta must be in (0, 1)\n");
+        return 1;
+    }
+
+    Zipfian zipf(opt.keys, opt.theta);
+    printf("ops/thread=%zu keys=%zu capacity=%zu theta=%.2f fibers/thread=%zu load_us=%lu\n", opt.ops, opt.keys,
+           opt.capacity, opt.theta, opt.fibers, (unsigned long)opt.load_us);
+    printf("%7s %7s %12s %10s %10s %10s %8s\n", "threads", "shards", "ops/s", "hit rate", "loads", "evictions",
+           "failed");
+    for(size_t threads : parse_list(opt.threads))
+    {
+        for(size_t shards : parse_list(opt.shards))
+        {
+            run_once(opt, zipf, std::max<size_t>(1, threads), shards);
+        }
+    }
+    return 0;
+}
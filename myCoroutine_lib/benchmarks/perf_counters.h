@@ -0,0 +1,167 @@
+#ifndef __MYCOROUTINE_BENCH_PERF_COUNTERS_H_
+#define __MYCOROUTINE_BENCH_PERF_COUNTERS_H_
+
+/**
+ * @file perf_counters.h
+ * @brief 基准测试用的硬件计数器
+ * @details 通过perf_event_open统计被测代码的周期、指令、缓存未命中、分支预测失败、dTLB未命中，
+ *          以及任务时钟、上下文切换、缺页三个软件计数器。计数器以inherit方式打开，
+ *          之后创建的线程（如IOManager的工作线程）也被计入；各计数器单独打开，
+ *          不支持的计数器（虚拟机中常见没有PMU）或权限不足时标记为不可用，其余照常统计。
+ *          计数器被内核分时复用时按 time_enabled/time_running 换算
+ */
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+
+namespace mycoroutine {
+namespace bench {
+
+/**
+ * @brief 计数器编号
+ */
+enum PerfCounter
+{
+    PERF_CYCLES = 0,       // CPU周期
+    PERF_INSTRUCTIONS,     // 指令数
+    PERF_CACHE_MISSES,     // 末级缓存未命中
+    PERF_BRANCH_MISSES,    // 分支预测失败
+    PERF_DTLB_MISSES,      // dTLB读未命中
+    PERF_TASK_CLOCK,       // 任务时钟（纳秒，所有被统计线程的CPU时间之和）
+    PERF_CONTEXT_SWITCHES, // 内核上下文切换
+    PERF_PAGE_FAULTS,      // 缺页
+    PERF_COUNTER_NUM
+};
+
+/**
+ * @brief 计数器的一次读数
+ */
+struct PerfSample
+{
+    double value[PERF_COUNTER_NUM] = {0};   // 换算后的计数
+    bool valid[PERF_COUNTER_NUM] = {false}; // 计数器是否可用
+
+    /**
+     * @brief 计算两次读数之差
+     */
+    PerfSample operator-(const PerfSample& start) const
+    {
+        PerfSample delta;
+        for(int i = 0; i < PERF_COUNTER_NUM; ++i)
+        {
+            delta.valid[i] = valid[i] && start.valid[i];
+            delta.value[i] = delta.valid[i] ? value[i] - start.value[i] : 0;
+        }
+        return delta;
+    }
+};
+
+/**
+ * @brief 一组perf计数器
+ * @note 只统计当前线程和之后创建的线程；exclude_kernel时不含内核态
+ *       （/proc/sys/kernel/perf_event_paranoid为2时只能统计用户态）
+ */
+class PerfCounters
+{
+public:
+    /**
+     * @brief 打开计数器
+     * @param include_kernel 是否统计内核态
+     */
+    explicit PerfCounters(bool include_kernel = false)
+    {
+        static const struct
+        {
+            uint32_t type;
+            uint64_t config;
+        } events[PERF_COUNTER_NUM] =
+        {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        };
+
+        for(int i = 0; i < PERF_COUNTER_NUM; ++i)
+        {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].type;
+            attr.config = events[i].config;
+            attr.inherit = 1;
+            attr.exclude_kernel = include_kernel ? 0 : 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            m_fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        }
+    }
+
+    /**
+     * @brief 析构函数，关闭计数器
+     */
+    ~PerfCounters()
+    {
+        for(int fd : m_fds)
+        {
+            if(fd >= 0)
+            {
+                close(fd);
+            }
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * @brief 是否至少有一个计数器可用
+     */
+    bool available() const
+    {
+        for(int fd : m_fds)
+        {
+            if(fd >= 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 读取所有计数器（含已退出的子线程）
+     */
+    PerfSample read() const
+    {
+        PerfSample sample;
+        for(int i = 0; i < PERF_COUNTER_NUM; ++i)
+        {
+            uint64_t buf[3];   // value, time_enabled, time_running
+            if(m_fds[i] < 0 || ::read(m_fds[i], buf, sizeof(buf)) != sizeof(buf))
+            {
+                continue;
+            }
+            sample.valid[i] = buf[2] > 0;
+            sample.value[i] = buf[2] ? (double)buf[0] * buf[1] / buf[2] : 0;
+        }
+        return sample;
+    }
+
+private:
+    int m_fds[PERF_COUNTER_NUM] = {-1, -1, -1, -1, -1, -1, -1, -1};   // 计数器描述符，-1表示不可用
+};
+
+} // end namespace bench
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_BENCH_PERF_COUNTERS_H_
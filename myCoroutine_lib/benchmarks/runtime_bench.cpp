@@ -0,0 +1,462 @@
+/**
+ * @file runtime_bench.cpp
+ * @brief 运行时微基准测试（可选硬件计数器）
+ * @details 测量协程切换、协程创建、任务调度、定时器插入/取消、epoll唤醒和hook后IO调用的单次操作耗时；
+ *          -p时通过perf_event_open同时统计每次操作的周期、指令、缓存未命中、分支预测失败、dTLB未命中，
+ *          以及任务时钟、内核上下文切换和缺页，用于直接观察栈布局、队列结构等改动的效果。
+ *          涉及IOManager的用例在计数器打开之后创建IOManager，工作线程也被计入
+ *
+ * 用法：runtime_bench [-n 操作数] [-r 重复次数] [-c 用例,...] [-t 工作线程数] [-q 队列深度] [-s 栈大小] [-C 栈缓存数] [-p] [-k]
+ */
+
+#include "mycoroutine/iomanager.h"   // IO事件管理器
+#include "mycoroutine/fiber.h"       // 协程
+#include "mycoroutine/fd_manager.h"  // 为socketpair创建FdCtx
+#include "mycoroutine/hook.h"        // 原始read/write
+#include "perf_counters.h"           // perf计数器
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace mycoroutine;
+using namespace mycoroutine::bench;
+
+/**
+ * @brief 命令行参数
+ */
+struct Options
+{
+    size_t ops = 1000000;          // 每轮操作数
+    size_t repeat = 5;             // 每个用例的轮数，报告耗时中位数的一轮
+    std::string cases = "fiber_switch,fiber_spawn,schedule,timer_insert,timer_cancel,epoll_wakeup,hook_io,raw_io";
+    size_t threads = 1;            // schedule用例的工作线程数
+    size_t depth = 64;             // schedule用例每批投递的任务数（队列深度）
+    size_t stack_size = 0;         // 协程栈大小，0为默认值（只有默认大小的栈会进入栈缓存）
+    size_t stack_cache = Fiber::GetStackCacheSize(); // Fiber::SetStackCacheSize
+    bool perf = false;             // 是否统计perf计数器
+    bool kernel = false;           // 计数器是否包含内核态
+};
+
+/**
+ * @brief 一轮测量结果
+ */
+struct Result
+{
+    size_t ops = 0;         // 操作数
+    double ns_per_op = 0;   // 墙钟时间
+    PerfSample counters;    // 计数器增量
+};
+
+/**
+ * @brief 被测区间的计时和计数
+ * @details 用例在准备工作完成后调用begin()，被测操作完成后调用end()
+ */
+class Measure
+{
+public:
+    explicit Measure(PerfCounters* counters): m_counters(counters) {}
+
+    void begin()
+    {
+        if(m_counters)
+        {
+            m_start = m_counters->read();
+        }
+        m_begin = std::chrono::steady_clock::now();
+    }
+
+    void end()
+    {
+        m_end = std::chrono::steady_clock::now();
+        if(m_counters)
+        {
+            m_result.counters = m_counters->read() - m_start;
+        }
+    }
+
+    Result result(size_t ops)
+    {
+        m_result.ops = ops;
+        m_result.ns_per_op = std::chrono::duration<double, std::nano>(m_end - m_begin).count() / ops;
+        return m_result;
+    }
+
+private:
+    PerfCounters* m_counters;
+    PerfSample m_start;
+    std::chrono::steady_clock::time_point m_begin;
+    std::chrono::steady_clock::time_point m_end;
+    Result m_result;
+};
+
+/**
+ * @brief 协程切换：resume + yield 往返一次（两次上下文切换）
+ */
+static size_t case_fiber_switch(const Options& opt, Measure& m)
+{
+    Fiber::GetThis();
+    bool stop = false;
+    std::shared_ptr<Fiber> fiber = Fiber::Create([&]()
+    {
+        while(!stop)
+        {
+            Fiber::GetThis()->yield();
+        }
+    }, opt.stack_size, false);
+
+    fiber->resume();
+    m.begin();
+    for(size_t i = 0; i < opt.ops; ++i)
+    {
+        fiber->resume();
+    }
+    m.end();
+    stop = true;
+    fiber->resume();
+    return opt.ops;
+}
+
+/**
+ * @brief 协程创建：分配协程和栈、运行到结束、析构
+ */
+static size_t case_fiber_spawn(const Options& opt, Measure& m)
+{
+    Fiber::GetThis();
+    size_t ops = opt.ops / 10;
+    m.begin();
+    for(size_t i = 0; i < ops; ++i)
+    {
+        std::shared_ptr<Fiber> fiber = Fiber::Create([](){}, opt.stack_size, false);
+        fiber->resume();
+    }
+    m.end();
+    return ops;
+}
+
+/**
+ * @brief 任务调度：调用者线程scheduleLock，工作线程取出并执行回调
+ * @details 每批投递opt.depth个任务，等这一批执行完再投递下一批；队列深度影响出队开销
+ */
+static size_t case_schedule(const Options& opt, Measure& m)
+{
+    IOManager iom(opt.threads, false, "bench");
+    std::atomic<size_t> done{0};
+    Semaphore finished;
+    size_t depth = std::max<size_t>(1, opt.depth);
+    size_t batches = std::max<size_t>(1, opt.ops / depth);
+
+    m.begin();
+    for(size_t b = 0; b < batches; ++b)
+    {
+        size_t target = (b + 1) * depth;
+        for(size_t i = 0; i < depth; ++i)
+        {
+            iom.scheduleLock([&, target]()
+            {
+                if(done.fetch_add(1, std::memory_order_relaxed) + 1 == target)
+                {
+                    finished.signal();
+                }
+            });
+        }
+        finished.wait();
+    }
+    m.end();
+    return batches * depth;
+}
+
+/**
+ * @brief 定时器插入和取消（到期时间互不相同，不会在测量期间触发）
+ * @param cancel true测量取消，false测量插入
+ */
+static size_t case_timer(const Options& opt, Measure& m, bool cancel)
+{
+    IOManager iom(1, false, "bench");
+    size_t ops = opt.ops / 10;
+    std::vector<std::shared_ptr<Timer>> timers;
+    timers.reserve(ops);
+
+    if(!cancel)
+    {
+        m.begin();
+    }
+    for(size_t i = 0; i < ops; ++i)
+    {
+        timers.push_back(iom.addTimer(3600 * 1000 + (i * 7919) % 100000, [](){}));
+    }
+    if(!cancel)
+    {
+        m.end();
+    }
+    else
+    {
+        m.begin();
+    }
+    for(auto& timer : timers)
+    {
+        timer->cancel();
+    }
+    if(cancel)
+    {
+        m.end();
+    }
+    timers.clear();
+    return ops;
+}
+
+/**
+ * @brief epoll唤醒：同一工作线程上的两个协程通过eventfd乒乓，每次唤醒都经过epoll_wait
+ */
+static size_t case_epoll_wakeup(const Options& opt, Measure& m)
+{
+    IOManager iom(1, false, "bench");
+    int ping = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int pong = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    size_t rounds = opt.ops / 10;
+    Semaphore ready;
+    Semaphore finished;
+
+    // 等待fd可读并消费计数
+    auto consume = [](int fd)
+    {
+        uint64_t value;
+        while(read(fd, &value, sizeof(value)) < 0)
+        {
+            IOManager::GetThis()->waitEvent(fd, IOManager::READ);
+        }
+    };
+    auto notify = [](int fd)
+    {
+        uint64_t one = 1;
+        if(write(fd, &one, sizeof(one)) != sizeof(one))
+        {
+            perror("eventfd write");
+        }
+    };
+
+    int worker = iom.getWorkerThreadIds().front();
+    iom.scheduleLock([&]()
+    {
+        ready.signal();
+        for(size_t i = 0; i < rounds; ++i)
+        {
+            consume(ping);
+            notify(pong);
+        }
+    }, worker);
+    iom.scheduleLock([&]()
+    {
+        ready.wait();
+        m.begin();
+        for(size_t i = 0; i < rounds; ++i)
+        {
+            notify(ping);
+            consume(pong);
+        }
+        m.end();
+        finished.signal();
+    }, worker);
+    finished.wait();
+    close(ping);
+    close(pong);
+    return rounds * 2;
+}
+
+/**
+ * @brief 数据已就绪时的IO调用：工作线程上的协程对socketpair交替write和read一个字节
+ * @param hooked true经过hook（套接字登记了FdCtx、线程启用了hook），false直接调用原始函数作为对照
+ * @details 每次调用都不会阻塞，两者之差就是hook快速路径的开销
+ */
+static size_t case_io(const Options& opt, Measure& m, bool hooked)
+{
+    WarmupConfig warmup;
+    warmup.hook_enable = true;
+    IOManager iom(1, false, "bench", warmup);
+    int sv[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0)
+    {
+        perror("socketpair");
+        exit(1);
+    }
+    // socketpair不经过hook，手动登记上下文（同时设置为系统层面非阻塞）
+    FdMgr::GetInstance()->get(sv[0], true);
+    FdMgr::GetInstance()->get(sv[1], true);
+    size_t rounds = opt.ops / 2;
+    Semaphore finished;
+
+    iom.scheduleLock([&]()
+    {
+        char c = 0;
+        m.begin();
+        for(size_t i = 0; i < rounds; ++i)
+        {
+            ssize_t w = hooked ? write(sv[0], &c, 1) : write_f(sv[0], &c, 1);
+            ssize_t r = hooked ? read(sv[1], &c, 1) : read_f(sv[1], &c, 1);
+            if(w != 1 || r != 1)
+            {
+                perror("io");
+                exit(1);
+            }
+        }
+        m.end();
+        finished.signal();
+    }, iom.getWorkerThreadIds().front());
+    finished.wait();
+    FdMgr::GetInstance()->del(sv[0]);
+    FdMgr::GetInstance()->del(sv[1]);
+    close(sv[0]);
+    close(sv[1]);
+    return rounds * 2;
+}
+
+/**
+ * @brief 运行一轮
+ */
+static Result run_case(const std::string& name, const Options& opt)
+{
+    std::unique_ptr<PerfCounters> counters;
+    if(opt.perf)
+    {
+        counters.reset(new PerfCounters(opt.kernel));
+    }
+    Measure m(counters.get());
+    size_t ops = 0;
+    if(name == "fiber_switch") ops = case_fiber_switch(opt, m);
+    else if(name == "fiber_spawn") ops = case_fiber_spawn(opt, m);
+    else if(name == "schedule") ops = case_schedule(opt, m);
+    else if(name == "timer_insert") ops = case_timer(opt, m, false);
+    else if(name == "timer_cancel") ops = case_timer(opt, m, true);
+    else if(name == "epoll_wakeup") ops = case_epoll_wakeup(opt, m);
+    else if(name == "hook_io") ops = case_io(opt, m, true);
+    else if(name == "raw_io") ops = case_io(opt, m, false);
+    else
+    {
+        fprintf(stderr, "unknown case: %s\n", name.c_str());
+        exit(1);
+    }
+    return m.result(ops);
+}
+
+/**
+ * @brief 输出每次操作的计数，不可用时输出"-"
+ */
+static void print_counter(const Result& r, int counter)
+{
+    if(r.counters.valid[counter])
+    {
+        printf(" %9.2f", r.counters.value[counter] / r.ops);
+    }
+    else
+    {
+        printf(" %9s", "-");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    int c;
+    while((c = getopt(argc, argv, "n:r:c:t:q:s:C:pkh")) != -1)
+    {
+        switch(c)
+        {
+        case 'n': opt.ops = strtoul(optarg, nullptr, 10); break;
+        case 'r': opt.repeat = std::max(1UL, strtoul(optarg, nullptr, 10)); break;
+        case 'c': opt.cases = optarg; break;
+        case 't': opt.threads = strtoul(optarg, nullptr, 10); break;
+        case 'q': opt.depth = strtoul(optarg, nullptr, 10); break;
+        case 's': opt.stack_size = strtoul(optarg, nullptr, 10); break;
+        case 'C': opt.stack_cache = strtoul(optarg, nullptr, 10); break;
+        case 'p': opt.perf = true; break;
+        case 'k': opt.kernel = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-n ops] [-r repeat] [-c case,...] [-t threads] [-q depth] "
+                            "[-s stack_size] [-C stack_cache] [-p] [-k]\n", argv[0]);
+            return 1;
+        }
+    }
+    Fiber::SetStackCacheSize(opt.stack_cache);
+
+    if(opt.perf)
+    {
+        PerfCounters probe(opt.kernel);
+        PerfSample sample = probe.read();
+        static const char* names[PERF_COUNTER_NUM] = {"cycles", "instructions", "cache-misses", "branch-misses",
+                                                      "dTLB-load-misses", "task-clock", "context-switches",
+                                                      "page-faults"};
+        std::string missing;
+        for(int i = 0; i < PERF_COUNTER_NUM; ++i)
+        {
+            if(!sample.valid[i])
+            {
+                missing += std::string(missing.empty() ? "" : ",") + names[i];
+            }
+        }
+        if(!missing.empty())
+        {
+            printf("unavailable counters: %s (no PMU, or perf_event_paranoid too high%s)\n", missing.c_str(),
+                   opt.kernel ? " for -k" : "");
+        }
+    }
+
+    printf("ops=%zu repeat=%zu threads=%zu depth=%zu stack_size=%zu stack_cache=%zu perf=%s%s\n", opt.ops,
+           opt.repeat, opt.threads, opt.depth, opt.stack_size, opt.stack_cache, opt.perf ? "on" : "off",
+           opt.kernel ? "(+kernel)" : "");
+    printf("%-14s %9s", "case", "ns/op");
+    if(opt.perf)
+    {
+        printf(" %9s %9s %6s %9s %9s %9s %9s %9s %9s", "cycles", "instr", "IPC", "cache-mis", "br-miss",
+               "dTLB-miss", "cpu-ns", "ctx-sw", "faults");
+    }
+    printf("\n");
+
+    std::stringstream ss(opt.cases);
+    std::string name;
+    while(std::getline(ss, name, ','))
+    {
+        std::vector<Result> results;
+        for(size_t i = 0; i < opt.repeat; ++i)
+        {
+            results.push_back(run_case(name, opt));
+        }
+        std::sort(results.begin(), results.end(), [](const Result& a, const Result& b)
+        {
+            return a.ns_per_op < b.ns_per_op;
+        });
+        const Result& r = results[results.size() / 2];
+
+        printf("%-14s %9.1f", name.c_str(), r.ns_per_op);
+        if(opt.perf)
+        {
+            print_counter(r, PERF_CYCLES);
+            print_counter(r, PERF_INSTRUCTIONS);
+            if(r.counters.valid[PERF_CYCLES] && r.counters.valid[PERF_INSTRUCTIONS] && r.counters.value[PERF_CYCLES] > 0)
+            {
+                printf(" %6.2f", r.counters.value[PERF_INSTRUCTIONS] / r.counters.value[PERF_CYCLES]);
+            }
+            else
+            {
+                printf(" %6s", "-");
+            }
+            print_counter(r, PERF_CACHE_MISSES);
+            print_counter(r, PERF_BRANCH_MISSES);
+            print_counter(r, PERF_DTLB_MISSES);
+            print_counter(r, PERF_TASK_CLOCK);
+            print_counter(r, PERF_CONTEXT_SWITCHES);
+            print_counter(r, PERF_PAGE_FAULTS);
+        }
+        printf("\n");
+    }
+    return 0;
+}
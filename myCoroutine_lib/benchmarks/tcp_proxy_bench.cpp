@@ -0,0 +1,239 @@
+/**
+ * @file tcp_proxy_bench.cpp
+ * @brief 四层TCP转发基准测试
+ * @details 回环上搭建 客户端 -> 代理 -> 后端，对比两种转发方式的吞吐和代理消耗的CPU：
+ *          copy   —— read/send经过用户态缓冲区；
+ *          splice —— 套接字 -> 管道 -> 套接字，数据不经过用户态。
+ *          客户端和后端运行在普通线程中，代理CPU = 进程总CPU - 客户端线程CPU - 后端线程CPU。
+ *          客户端写完后半关闭，后端读到EOF后回传收到的字节数，顺带验证半关闭的转发。
+ *
+ * 用法：tcp_proxy_bench [-s 每连接MB] [-c 连接数] [-t 代理工作线程数] [-k 块大小KB]
+ */
+
+#include "mycoroutine/iomanager.h"   // IO事件管理器
+#include "mycoroutine/tcp_proxy.h"   // 四层TCP转发
+#include "mycoroutine/hook.h"        // 原始系统调用
+#include "bench_util.h"              // timed_phase
+
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace mycoroutine;
+using namespace mycoroutine::bench;
+
+/**
+ * @brief 命令行参数
+ */
+struct Options
+{
+    size_t mb = 1024;        // 每个连接发送的数据量（MB）
+    size_t conns = 1;        // 并发连接数
+    size_t threads = 1;      // 代理工作线程数
+    size_t chunk_kb = 64;    // TcpProxyConfig::chunk_size（KB）
+};
+
+/**
+ * @brief 获取CPU时间（微秒，用户态+内核态）
+ * @param who RUSAGE_SELF或RUSAGE_THREAD
+ */
+static uint64_t cpu_us(int who)
+{
+    struct rusage ru;
+    getrusage(who, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000ULL + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+/**
+ * @brief 在127.0.0.1的随机端口上监听
+ * @param port 输出参数，端口（网络字节序）
+ * @details 客户端和后端运行在普通线程中，使用原始系统调用创建阻塞套接字
+ *          （hook后的socket/accept总会把套接字设为O_NONBLOCK）
+ */
+static int listen_loopback(uint16_t& port)
+{
+    int fd = socket_f(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if(bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 1024) < 0 ||
+       getsockname(fd, (sockaddr*)&addr, &len) < 0)
+    {
+        perror("listen");
+        exit(1);
+    }
+    port = addr.sin_port;
+    return fd;
+}
+
+/**
+ * @brief 阻塞连接127.0.0.1:port
+ */
+static int connect_loopback(uint16_t port)
+{
+    int fd = socket_f(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = port;
+    if(connect_f(fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        perror("connect");
+        exit(1);
+    }
+    return fd;
+}
+
+/**
+ * @brief 运行一轮并输出结果
+ * @param opt 命令行参数
+ * @param splice true使用splice，false使用read/send拷贝
+ */
+static void run_once(const Options& opt, bool splice)
+{
+    uint16_t backend_port, proxy_port;
+    int backend_listen = listen_loopback(backend_port);
+    int proxy_listen = listen_loopback(proxy_port);
+    fcntl_f(proxy_listen, F_SETFL, fcntl_f(proxy_listen, F_GETFL, 0) | O_NONBLOCK);
+
+    std::atomic<uint64_t> side_cpu{0};     // 客户端和后端线程的CPU时间
+    std::atomic<size_t> failed{0};
+    const uint64_t total = opt.mb * 1024 * 1024;
+
+    // 后端：读到EOF后回传收到的字节数
+    std::vector<std::thread> sinks;
+    for(size_t i = 0; i < opt.conns; ++i)
+    {
+        sinks.emplace_back([&]()
+        {
+            int fd = accept_f(backend_listen, nullptr, nullptr);
+            std::vector<char> buf(256 * 1024);
+            uint64_t received = 0;
+            ssize_t n;
+            while((n = read_f(fd, buf.data(), buf.size())) > 0)
+            {
+                received += n;
+            }
+            write_f(fd, &received, sizeof(received));
+            close_f(fd);
+            side_cpu += cpu_us(RUSAGE_THREAD);
+        });
+    }
+
+    double seconds = 0;
+    uint64_t cpu = 0;
+    {
+        IOManager iom(opt.threads, false);
+        // 只计转发阶段，不计IOManager的启动和停止
+        uint64_t cpu_start = cpu_us(RUSAGE_SELF);
+        seconds = timed_phase(iom, opt.conns, [&](size_t)
+        {
+            int client;
+            while((client = accept4(proxy_listen, nullptr, nullptr, SOCK_NONBLOCK)) < 0)
+            {
+                IOManager::GetThis()->waitEvent(proxy_listen, IOManager::READ);
+            }
+            int backend = connect_loopback(backend_port);
+
+            TcpProxyConfig config;
+            config.use_splice = splice;
+            config.chunk_size = opt.chunk_kb * 1024;
+            TcpProxy proxy(client, backend, config);
+            if(proxy.run() < 0 || proxy.getUpstreamBytes() != total)
+            {
+                ++failed;
+            }
+            close_f(client);
+            close_f(backend);
+        }, [&]()
+        {
+            // 客户端：写完后半关闭，读取后端回传的字节数
+            std::vector<std::thread> clients;
+            for(size_t i = 0; i < opt.conns; ++i)
+            {
+                clients.emplace_back([&]()
+                {
+                    int fd = connect_loopback(proxy_port);
+                    std::vector<char> buf(256 * 1024, 'x');
+                    uint64_t left = total;
+                    while(left)
+                    {
+                        ssize_t n = write_f(fd, buf.data(), std::min<uint64_t>(left, buf.size()));
+                        if(n <= 0)
+                        {
+                            ++failed;
+                            break;
+                        }
+                        left -= n;
+                    }
+                    shutdown(fd, SHUT_WR);
+                    uint64_t received = 0;
+                    if(read_f(fd, &received, sizeof(received)) != sizeof(received) || received != total)
+                    {
+                        ++failed;
+                    }
+                    close_f(fd);
+                    side_cpu += cpu_us(RUSAGE_THREAD);
+                });
+            }
+            for(auto& t : clients)
+            {
+                t.join();
+            }
+        });
+
+        // 后端线程回传字节数后即退出，回收后side_cpu才完整
+        for(auto& t : sinks)
+        {
+            t.join();
+        }
+        cpu = cpu_us(RUSAGE_SELF) - cpu_start;
+    }
+    double proxy_cpu = (cpu > side_cpu ? cpu - side_cpu : 0) / 1e6;
+    close_f(backend_listen);
+    close_f(proxy_listen);
+
+    double gb = (double)total * opt.conns / (1024.0 * 1024 * 1024);
+    printf("%-8s %10.0f %12.3f %14.3f %8zu\n", splice ? "splice" : "copy",
+           gb * 1024 / seconds, proxy_cpu, proxy_cpu / gb, failed.load());
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    int c;
+    while((c = getopt(argc, argv, "s:c:t:k:h")) != -1)
+    {
+        switch(c)
+        {
+        case 's': opt.mb = strtoul(optarg, nullptr, 10); break;
+        case 'c': opt.conns = strtoul(optarg, nullptr, 10); break;
+        case 't': opt.threads = strtoul(optarg, nullptr, 10); break;
+        case 'k': opt.chunk_kb = strtoul(optarg, nullptr, 10); break;
+        default:
+            fprintf(stderr, "usage: %s [-s mb_per_conn] [-c conns] [-t threads] [-k chunk_kb]\n", argv[0]);
+            return 1;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("mb_per_conn=%zu conns=%zu threads=%zu chunk_kb=%zu\n", opt.mb, opt.conns, opt.threads, opt.chunk_kb);
+    printf("%-8s %10s %12s %14s %8s\n", "mode", "MB/s", "proxy cpu(s)", "cpu s/GB", "failed");
+    run_once(opt, false);
+    run_once(opt, true);
+    return 0;
+}
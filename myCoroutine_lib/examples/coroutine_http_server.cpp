@@ -6,6 +6,8 @@
 
 #include "mycoroutine/iomanager.h"   // IO事件管理器头文件
 #include "mycoroutine/hook.h"          // 系统调用钩子头文件
+#include "mycoroutine/buffer_pool.h"   // 线程级读缓冲区池
+#include "mycoroutine/http_parser.h"   // HTTP请求解析器
 #include <unistd.h>         // UNIX标准函数库
 #include <sys/types.h>      // 系统数据类型定义
 #include <sys/socket.h>     // 套接字API
@@ -14,6 +16,7 @@
 #include <iostream>         // 标准输入输出
 #include <stack>
 #include <cstring>          // 字符串处理函数
+#include <string>           // 跨段请求头的累积缓冲区
 #include <chrono>
 #include <thread>
 
@@ -23,6 +26,12 @@
  */
 static int sock_listen_fd = -1;
 
+/**
+ * @brief 请求头最大长度（字节）
+ * @details 超过该长度仍未收到完整请求头时返回400
+ */
+static const size_t kMaxHeaderBytes = 16 * 1024;
+
 /**
  * @brief 函数声明
  */
@@ -79,54 +88,69 @@ void test_accept()
         // 为新连接添加读事件回调
         mycoroutine::IOManager::GetThis()->addEvent(fd, mycoroutine::IOManager::READ, [fd]()
         {
-            char buffer[1024];         // 接收缓冲区
-            memset(buffer, 0, sizeof(buffer)); // 清零初始化
-            
+            // 请求头跨多个TCP段到达时，累积已收到的数据直到请求头完整或超过上限
+            std::string pending;
+            int parsed = -2;
+            int ret;
             while (true)
             {
-                // 接收数据（这里会被hook，变为非阻塞协程挂起操作）
-                int ret = recv(fd, buffer, sizeof(buffer), 0);
-                
-                if (ret > 0)
+                // 不预先持有接收缓冲区：数据就绪后才从线程级缓冲区池借用，空闲连接不占用读缓冲区
+                mycoroutine::PooledBuffer buffer;
+
+                // 接收数据（没有数据时挂起协程等待READ事件，等待期间不持有缓冲区）
+                ret = mycoroutine::recv_pooled(fd, buffer);
+                if (ret <= 0)
                 {
-                    // 收到数据
-                    //std::cout << "received data, fd = " << fd << ", data = " << buffer << std::endl;
-                    
-                    // 构建HTTP响应
-                    const char *response = "HTTP/1.1 200 OK\r\n"
-                                           "Content-Type: text/plain\r\n"
-                                           "Content-Length: 13\r\n"
-                                           "Connection: keep-alive\r\n"
-                                           "\r\n"
-                                           "Hello, World!";
-                    
-                    // 发送HTTP响应（这里会被hook，变为非阻塞协程挂起操作）
-                    ret = send(fd, response, strlen(response), 0);
-                    //std::cout << "sent data, fd = " << fd << ", ret = " << ret << std::endl;
-
-                    // 关闭连接
-                    close(fd);
                     break;
                 }
-                
-                if (ret <= 0)
+
+                // 解析请求行和请求头；常见情况下一次收齐，直接在池化缓冲区上解析，不拷贝
+                mycoroutine::HttpRequest request;
+                if (pending.empty())
                 {
-                    // 连接关闭或发生错误
-                    if (ret == 0 || errno != EAGAIN)
-                    {
-                        // 连接被客户端关闭或发生非临时性错误
-                        //std::cout << "closing connection, fd = " << fd << std::endl;
-                        close(fd);
-                        break;
-                    }
-                    else if (errno == EAGAIN)
+                    parsed = mycoroutine::parse_http_request(buffer.data(), buffer.size(), request);
+                    if (parsed == -2)
                     {
-                        // 资源暂时不可用，非阻塞模式下的正常返回
-                        //std::cout << "recv returned EAGAIN, fd = " << fd << std::endl;
-                        //std::this_thread::sleep_for(std::chrono::milliseconds(50)); // 注释掉，因为有IO事件机制
+                        pending.assign(buffer.data(), buffer.size());
                     }
                 }
+                else
+                {
+                    pending.append(buffer.data(), buffer.size());
+                    parsed = mycoroutine::parse_http_request(pending.data(), pending.size(), request);
+                }
+
+                // 尽早归还缓冲区（request中的string_view此后失效）
+                buffer.reset();
+                if (parsed != -2 || pending.size() >= kMaxHeaderBytes)
+                {
+                    break;
+                }
             }
+
+            if (ret > 0)
+            {
+                // 构建HTTP响应：格式错误或请求头超过上限时返回400
+                const char *response = parsed > 0 ?
+                                       "HTTP/1.1 200 OK\r\n"
+                                       "Content-Type: text/plain\r\n"
+                                       "Content-Length: 13\r\n"
+                                       "Connection: keep-alive\r\n"
+                                       "\r\n"
+                                       "Hello, World!" :
+                                       "HTTP/1.1 400 Bad Request\r\n"
+                                       "Content-Length: 0\r\n"
+                                       "Connection: close\r\n"
+                                       "\r\n";
+
+                // 发送HTTP响应（这里会被hook，变为非阻塞协程挂起操作）
+                ret = send(fd, response, strlen(response), 0);
+                //std::cout << "sent data, fd = " << fd << ", ret = " << ret << std::endl;
+            }
+
+            // 处理完毕、连接被客户端关闭或发生错误，关闭连接
+            //std::cout << "closing connection, fd = " << fd << std::endl;
+            close(fd);
         });
     }
     
@@ -155,6 +179,12 @@ void test_iomanager()
     // 设置SO_REUSEADDR选项，解决"address already in use"错误
     setsockopt(sock_listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
 
+    // 设置TCP_NODELAY、TCP_DEFER_ACCEPT和TCP_FASTOPEN，失败时仅提示
+    if (mycoroutine::tune_listen_socket(sock_listen_fd) < 0)
+    {
+        perror("tune_listen_socket");
+    }
+
     // 初始化服务器地址结构体
     memset((char *)&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;          // IPv4地址族
@@ -0,0 +1,131 @@
+/**
+ * @file websocket_server.cpp
+ * @brief WebSocket广播示例程序
+ * @details 每个连接收到的文本消息广播给所有在线连接，广播帧只编码一次
+ */
+
+#include "mycoroutine/iomanager.h"   // IO事件管理器头文件
+#include "mycoroutine/websocket.h"   // WebSocket服务端
+#include <unistd.h>         // UNIX标准函数库
+#include <sys/socket.h>     // 套接字API
+#include <arpa/inet.h>      // 网络地址转换函数
+#include <fcntl.h>          // 文件控制函数
+#include <iostream>         // 标准输入输出
+#include <cstring>          // 字符串处理函数
+
+/**
+ * @brief 监听套接字文件描述符
+ */
+static int sock_listen_fd = -1;
+
+/**
+ * @brief 所有在线连接
+ */
+static mycoroutine::WebSocketGroup s_group;
+
+/**
+ * @brief 函数声明
+ */
+void on_accept();
+
+/**
+ * @brief 错误处理函数
+ * @param msg 错误描述信息
+ */
+void error(const char *msg)
+{
+    perror(msg);
+    exit(1);
+}
+
+/**
+ * @brief 处理单个连接：握手后循环接收消息并广播
+ * @param fd 已连接的套接字
+ */
+void handle_client(int fd)
+{
+    mycoroutine::WebSocketConfig config;
+    config.ping_interval_ms = 20000;  // 20秒发送一次ping
+    config.idle_timeout_ms = 60000;   // 60秒没有收到任何帧则断开
+
+    std::shared_ptr<mycoroutine::WebSocket> ws = mycoroutine::WebSocket::Accept(fd, config);
+    if (ws)
+    {
+        s_group.add(ws);
+        std::cout << "websocket connected, fd = " << fd << ", online = " << s_group.size() << std::endl;
+
+        mycoroutine::WebSocket::Message msg;
+        while (ws->recvMessage(msg))
+        {
+            // 文本消息广播给所有连接（包括发送者），二进制消息原样回显
+            if (msg.opcode == mycoroutine::WebSocket::TEXT)
+            {
+                s_group.broadcast(msg.data);
+            }
+            else
+            {
+                ws->send(msg.data, msg.opcode);
+            }
+        }
+
+        s_group.remove(ws);
+        ws->close();
+        std::cout << "websocket closed, fd = " << fd << ", online = " << s_group.size() << std::endl;
+    }
+    close(fd);
+}
+
+/**
+ * @brief 接受新连接的回调函数
+ */
+void on_accept()
+{
+    int fd = accept(sock_listen_fd, nullptr, nullptr);
+    if (fd >= 0)
+    {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        mycoroutine::IOManager::GetThis()->scheduleLock(std::bind(&handle_client, fd));
+    }
+
+    // 重新为监听套接字添加读事件，继续接受新连接
+    mycoroutine::IOManager::GetThis()->addEvent(sock_listen_fd, mycoroutine::IOManager::READ, on_accept);
+}
+
+/**
+ * @brief 程序入口函数
+ */
+int main()
+{
+    int portno = 8081;  // 服务器监听端口
+    struct sockaddr_in server_addr;
+
+    sock_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock_listen_fd < 0)
+    {
+        error("Error creating socket..\n");
+    }
+
+    int yes = 1;
+    setsockopt(sock_listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(portno);
+    server_addr.sin_addr.s_addr = INADDR_ANY;
+
+    if (bind(sock_listen_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0)
+    {
+        error("Error binding socket..\n");
+    }
+    if (listen(sock_listen_fd, 1024) < 0)
+    {
+        error("Error listening..\n");
+    }
+
+    printf("websocket server listening on port: %d\n", portno);
+    fcntl(sock_listen_fd, F_SETFL, O_NONBLOCK);
+
+    mycoroutine::IOManager iom(4);
+    iom.addEvent(sock_listen_fd, mycoroutine::IOManager::READ, on_accept);
+    return 0;
+}
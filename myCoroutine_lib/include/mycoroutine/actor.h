@@ -0,0 +1,238 @@
+#ifndef __MYCOROUTINE_ACTOR_H_
+#define __MYCOROUTINE_ACTOR_H_
+
+/**
+ * @file actor.h
+ * @brief Actor模型头文件
+ * @details 每个Actor拥有一个无锁的多生产者单消费者邮箱，消息串行处理，Actor内部状态不需要加锁。
+ *          Actor只在有消息时被激活：发送方压入消息后，若Actor尚未被调度则投递一个任务到调度器，
+ *          任务在工作线程的回调协程中处理至多一批消息；空闲的Actor不占用协程和栈
+ */
+
+#include <mycoroutine/scheduler.h>   // 调度器
+
+#include <atomic>       // 邮箱与调度标志
+#include <memory>       // 智能指针
+#include <utility>      // std::move
+
+namespace mycoroutine {
+
+/**
+ * @brief Actor基类
+ * @tparam Msg 消息类型，只要求可移动构造
+ * @details 邮箱是Vyukov的侵入式MPSC队列：发送只有一次原子交换（tail）和一次release写（前驱的next），
+ *          不加锁、不会因其他发送方而失败重试。调度标志m_scheduled保证同一时刻至多有一个任务处理该Actor：
+ *          - send()：压入消息，再exchange调度标志，由false变为true的发送方调用scheduleLock()
+ *          - 处理任务：每次激活至多处理batch_limit条消息；还有剩余时重新投递自己，把工作线程让给其他任务；
+ *            邮箱为空时清除调度标志后再检查一次，避免丢失与清除并发的发送
+ *          调度期间Actor持有对自身的引用，即使外部已不再持有也会处理完已发送的消息
+ * @note Actor必须由std::shared_ptr持有（send()在激活时调用shared_from_this()）；
+ *       receive()中可以调用hook后的阻塞IO或其他会挂起协程的操作，挂起期间新消息留在邮箱中，顺序不变
+ */
+template<class Msg>
+class Actor : public std::enable_shared_from_this<Actor<Msg>>
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param scheduler 处理消息的调度器
+     * @param batch_limit 每次激活最多处理的消息数，之后重新投递，避免一个繁忙的Actor长期占住工作线程
+     * @param thread 处理消息的线程ID，-1表示任意工作线程
+     */
+    explicit Actor(Scheduler* scheduler = Scheduler::GetThis(), size_t batch_limit = 64, int thread = -1):
+        m_scheduler(scheduler), m_batchLimit(batch_limit ? batch_limit : 1), m_thread(thread)
+    {
+        m_head = &m_stub;
+        m_tail.store(&m_stub, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 析构函数，丢弃未处理的消息
+     */
+    virtual ~Actor()
+    {
+        while(Node* node = pop())
+        {
+            delete node;
+        }
+    }
+
+    Actor(const Actor&) = delete;
+    Actor& operator=(const Actor&) = delete;
+
+    /**
+     * @brief 发送消息（任意线程、任意协程）
+     * @param msg 消息
+     * @details 一次原子压入；Actor空闲时再加一次scheduleLock()激活它。
+     *          tail的交换与调度标志的读取都是seq_cst，与run()中清除标志后读取tail构成对称的两组操作，
+     *          两边至少有一边看到对方的写，消息不会滞留在无人处理的邮箱中
+     */
+    void send(Msg msg)
+    {
+        push(new Node(std::move(msg)));
+        // Actor正在被处理时只读不写调度标志，繁忙Actor的发送方之间不争抢这个缓存行
+        if(!m_scheduled.load(std::memory_order_seq_cst) && !m_scheduled.exchange(true, std::memory_order_seq_cst))
+        {
+            activate(this->shared_from_this());
+        }
+    }
+
+    /**
+     * @brief 获取已处理的消息数
+     */
+    uint64_t getProcessedCount() const {return m_processed.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 获取激活次数（投递到调度器的处理任务数）
+     */
+    uint64_t getActivationCount() const {return m_activations.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 获取处理消息的调度器
+     */
+    Scheduler* getScheduler() const {return m_scheduler;}
+
+protected:
+    /**
+     * @brief 处理一条消息，由派生类实现
+     * @param msg 消息
+     * @details 同一个Actor的receive()不会并发执行，且按每个发送方的发送顺序调用
+     * @note 不能抛出异常
+     */
+    virtual void receive(Msg& msg) = 0;
+
+private:
+    /**
+     * @brief 邮箱节点的链接部分，哨兵节点只有这一部分，因此不要求Msg可默认构造
+     */
+    struct Link
+    {
+        std::atomic<Link*> next{nullptr};   // 下一个节点
+    };
+
+    /**
+     * @brief 邮箱节点
+     */
+    struct Node : Link
+    {
+        explicit Node(Msg&& m): msg(std::move(m)) {}
+        Msg msg;                            // 消息
+    };
+
+    /**
+     * @brief 压入节点（多生产者）
+     */
+    void push(Link* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Link* prev = m_tail.exchange(node, std::memory_order_seq_cst);
+        // 在这一步之前消费者看不到node，pop()把这个短暂的窗口当作空队列处理
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief 取出节点（单消费者）
+     * @return 节点，邮箱为空或有发送方尚未完成链接时返回nullptr
+     */
+    Node* pop()
+    {
+        Link* head = m_head;
+        Link* next = head->next.load(std::memory_order_acquire);
+        if(head == &m_stub)
+        {
+            if(!next)
+            {
+                return nullptr;
+            }
+            m_head = next;
+            head = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if(next)
+        {
+            m_head = next;
+            return static_cast<Node*>(head);
+        }
+        if(head != m_tail.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        // head是最后一个节点：重新压入哨兵，使head可以被取出
+        push(&m_stub);
+        next = head->next.load(std::memory_order_acquire);
+        if(next)
+        {
+            m_head = next;
+            return static_cast<Node*>(head);
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 投递处理任务（调用方已把调度标志由false置为true）
+     * @param self 对自身的引用，处理期间保持Actor存活
+     */
+    void activate(std::shared_ptr<Actor> self)
+    {
+        m_self = std::move(self);
+        m_activations.fetch_add(1, std::memory_order_relaxed);
+        // 捕获裸指针，std::function可以把回调放在内部存储中，不额外分配
+        m_scheduler->scheduleLock([this]() {run();}, m_thread);
+    }
+
+    /**
+     * @brief 处理任务：处理至多一批消息
+     */
+    void run()
+    {
+        size_t processed = 0;
+        while(processed < m_batchLimit)
+        {
+            Node* node = pop();
+            if(!node)
+            {
+                break;
+            }
+            receive(node->msg);
+            delete node;
+            ++processed;
+        }
+        m_processed.fetch_add(processed, std::memory_order_relaxed);
+
+        // 取出自身引用；本任务结束时它可能是最后一个引用，之后不能再访问成员
+        std::shared_ptr<Actor> self = std::move(m_self);
+        if(processed == m_batchLimit)
+        {
+            // 处理满一批：重新投递，让同一线程上的其他任务有机会运行
+            activate(std::move(self));
+            return;
+        }
+
+        // 邮箱已空（或有发送方尚未完成链接）：先清除调度标志再检查，
+        // 与清除并发的send()要么看到false自己激活，要么它交换过的tail在这里被看到。
+        // 清除之后可能已有新任务在别的线程消费邮箱，因此只比较tail与清除前的head快照：
+        // 发送方压入的总是新节点，tail不等于快照即说明有未处理的消息
+        Link* head = m_head;
+        m_scheduled.store(false, std::memory_order_seq_cst);
+        if(m_tail.load(std::memory_order_seq_cst) != head && !m_scheduled.exchange(true, std::memory_order_seq_cst))
+        {
+            activate(std::move(self));
+        }
+    }
+
+private:
+    Scheduler* m_scheduler;                     // 处理消息的调度器
+    size_t m_batchLimit;                        // 每次激活最多处理的消息数
+    int m_thread;                               // 处理消息的线程，-1表示任意
+    Link m_stub;                                // 邮箱哨兵节点
+    Link* m_head;                               // 邮箱头部（仅消费者访问）
+    alignas(64) std::atomic<Link*> m_tail;      // 邮箱尾部（发送方交换），与消费者字段分开缓存行
+    std::atomic<bool> m_scheduled{false};       // 是否已投递处理任务
+    std::shared_ptr<Actor> m_self;              // 调度期间对自身的引用（仅持有调度标志的一方访问）
+    alignas(64) std::atomic<uint64_t> m_processed{0};   // 已处理的消息数
+    std::atomic<uint64_t> m_activations{0};     // 激活次数
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_ACTOR_H_
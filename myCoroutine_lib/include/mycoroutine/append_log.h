@@ -0,0 +1,156 @@
+#ifndef __MYCOROUTINE_APPEND_LOG_H_
+#define __MYCOROUTINE_APPEND_LOG_H_
+
+/**
+ * @file append_log.h
+ * @brief 组提交追加日志头文件
+ * @details 多个协程追加的记录由专用刷盘线程合并成一组，每组只执行一次pwritev和一次fdatasync，
+ *          组持久化后唤醒该组内所有等待的协程
+ */
+
+#include <mycoroutine/scheduler.h>  // 调度器，用于恢复等待的协程
+#include <mycoroutine/thread.h>     // 刷盘线程
+
+#include <sys/uio.h>              // iovec
+#include <string>                 // 文件路径
+#include <deque>                  // 待提交记录
+#include <vector>                 // 当前组
+#include <memory>                 // 智能指针
+#include <mutex>                  // 互斥锁
+#include <condition_variable>     // 唤醒刷盘线程
+#include <atomic>                 // 统计计数
+#include <cstdint>                // uint64_t
+
+namespace mycoroutine {
+
+/**
+ * @brief 组提交参数
+ */
+struct AppendLogConfig
+{
+    size_t max_group_records = 1024;          // 单组最多记录数
+    size_t max_group_bytes = 4 * 1024 * 1024; // 单组最多字节数（单条记录超过该值时独占一组）
+    uint64_t max_group_delay_us = 0;          // 凑组的最长等待时间（微秒），0表示上一组完成后立即提交已到达的记录
+    bool sync = true;                         // 每组写入后是否fdatasync，false时只保证写入页缓存
+};
+
+/**
+ * @brief 组提交追加日志
+ * @details append()不拷贝记录：调用协程挂起期间记录内存保持有效，刷盘线程直接用iovec引用它们。
+ *          刷盘线程写一组的同时新到达的记录在队列中自然积累成下一组，
+ *          max_group_delay_us可以在负载较低时用延迟换取更大的组。
+ *          一组持久化后刷盘线程把组内每条记录的协程放回它所属调度器，不会唤醒其他组的协程
+ * @note append()只能在调度器调度的协程中调用；挂起在append()中的协程不计入调度器的待处理任务，
+ *       停止调度器之前需要等待所有append()返回
+ */
+class AppendLog
+{
+public:
+    /**
+     * @brief 打开（或创建）日志文件并启动刷盘线程
+     * @param path 文件路径
+     * @param config 组提交参数
+     * @return 成功返回日志对象，失败返回nullptr（errno指示原因）
+     */
+    static std::shared_ptr<AppendLog> Open(const std::string& path, const AppendLogConfig& config = AppendLogConfig());
+
+    /**
+     * @brief 构造函数（通过Open创建）
+     * @param fd 已打开的文件描述符，日志对象拥有它
+     * @param offset 追加起始位置（文件当前长度）
+     * @param config 组提交参数
+     */
+    AppendLog(int fd, uint64_t offset, const AppendLogConfig& config);
+
+    /**
+     * @brief 析构函数，提交剩余记录后关闭文件
+     */
+    ~AppendLog();
+
+    /**
+     * @brief 追加一条记录，挂起当前协程直到它所在的组持久化
+     * @param data 记录数据，返回前必须保持有效
+     * @param len 记录长度
+     * @return 成功返回记录在文件中的偏移；日志已关闭或写入出错返回-1
+     */
+    int64_t append(const void* data, size_t len);
+
+    /**
+     * @brief 提交剩余记录，停止刷盘线程并关闭文件
+     * @details 可重复调用；之后的append()返回-1
+     */
+    void close();
+
+    /**
+     * @brief 获取首个写入错误的errno，0表示没有错误
+     */
+    int getError() const {return m_error;}
+
+    /**
+     * @brief 获取已持久化的文件长度
+     */
+    uint64_t getDurableOffset() const {return m_durableOffset;}
+
+    /**
+     * @brief 获取已提交的组数
+     */
+    uint64_t getGroupCount() const {return m_groups;}
+
+    /**
+     * @brief 获取已持久化的记录数
+     */
+    uint64_t getRecordCount() const {return m_records;}
+
+private:
+    /**
+     * @brief 待提交记录
+     */
+    struct Record
+    {
+        struct iovec iov;              // 记录数据（引用调用者内存）
+        int64_t* result;               // 调用协程栈上的结果（记录偏移），写入失败时置为-1
+        Scheduler* scheduler;          // 调用协程所属的调度器
+        std::shared_ptr<Fiber> fiber;  // 挂起中的调用协程
+    };
+
+    /**
+     * @brief 刷盘线程主循环
+     */
+    void run();
+
+    /**
+     * @brief 当前待提交记录是否已达到组上限
+     */
+    bool groupFull() const;
+
+    /**
+     * @brief 写入一组记录并刷盘
+     * @param offset 写入位置
+     * @return 成功返回0，失败返回errno
+     */
+    int writeGroup(uint64_t offset);
+
+private:
+    int m_fd;                                  // 日志文件描述符
+    AppendLogConfig m_config;                  // 组提交参数
+
+    std::mutex m_mutex;                        // 保护以下五个成员
+    std::condition_variable m_pendingCond;     // 有新记录或停止时唤醒刷盘线程
+    std::deque<Record> m_pending;              // 尚未提交的记录
+    size_t m_pendingBytes = 0;                 // 尚未提交的字节数
+    uint64_t m_tail;                           // 下一条记录的文件偏移
+    bool m_stopping = false;                   // 是否正在关闭
+
+    std::vector<Record> m_group;               // 正在提交的组（只由刷盘线程访问）
+    std::vector<struct iovec> m_iov;           // 正在提交的组的iovec（只由刷盘线程访问）
+
+    std::atomic<int> m_error{0};               // 首个写入错误
+    std::atomic<uint64_t> m_durableOffset;     // 已持久化的文件长度
+    std::atomic<uint64_t> m_groups{0};         // 已提交的组数
+    std::atomic<uint64_t> m_records{0};        // 已持久化的记录数
+    std::unique_ptr<Thread> m_thread;          // 刷盘线程
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_APPEND_LOG_H_
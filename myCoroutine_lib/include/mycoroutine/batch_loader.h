@@ -0,0 +1,217 @@
+#ifndef __MYCOROUTINE_BATCH_LOADER_H_
+#define __MYCOROUTINE_BATCH_LOADER_H_
+
+/**
+ * @file batch_loader.h
+ * @brief 微批聚合（DataLoader）头文件
+ * @details 把不同协程在一个短时间窗口内提交的键聚合成一次批量后端调用，
+ *          调用完成后每个协程各自拿到自己键的结果，摊薄逐键请求的往返开销
+ */
+
+#include <mycoroutine/iomanager.h>   // IO管理器（定时器与调度）
+#include <mycoroutine/fiber_sync.h>  // 协程条件变量
+
+#include <vector>       // 键与结果
+#include <functional>   // 批量调用
+#include <memory>       // 智能指针
+#include <mutex>        // 互斥锁
+#include <atomic>       // 统计
+#include <exception>    // 批量调用抛出的异常
+#include <stdexcept>    // std::length_error
+
+namespace mycoroutine {
+
+/**
+ * @brief 微批聚合器
+ * @tparam K 键类型
+ * @tparam V 结果类型
+ * @details 批次的第一个键启动一个窗口定时器（TimerManager），窗口到期或键数达到上限时分发：
+ *          - 窗口到期：在定时器回调协程中执行批量调用
+ *          - 达到上限：由提交最后一个键的协程直接执行批量调用，并取消窗口定时器
+ *          批量调用期间到达的键进入下一个批次，批次之间互不阻塞
+ * @note load()只能在IOManager调度的协程中调用；聚合器必须比所有进行中的load()活得更久
+ */
+template<class K, class V>
+class BatchLoader
+{
+public:
+    /**
+     * @brief 批量调用：为keys[i]填写values[i]
+     * @details values在调用前已被调整为keys.size()个默认值，未填写的位置返回默认值。
+     *          同一批次内可能出现重复的键。不能改变values的大小，否则整个批次按std::length_error失败
+     */
+    typedef std::function<void(const std::vector<K>& keys, std::vector<V>& values)> BatchFunc;
+
+    /**
+     * @brief 构造函数
+     * @param fn 批量调用
+     * @param max_batch 单个批次的最大键数
+     * @param window_ms 聚合窗口（毫秒），0表示在当前这一轮调度结束后立即分发
+     * @param iom 运行窗口定时器和批量调用的IO管理器
+     */
+    BatchLoader(BatchFunc fn, size_t max_batch = 128, uint64_t window_ms = 1,
+                IOManager* iom = IOManager::GetThis()):
+        m_fn(std::move(fn)), m_maxBatch(max_batch ? max_batch : 1), m_windowMs(window_ms), m_iom(iom)
+    {
+    }
+
+    BatchLoader(const BatchLoader&) = delete;
+    BatchLoader& operator=(const BatchLoader&) = delete;
+
+    /**
+     * @brief 提交一个键并挂起当前协程直到所在批次完成
+     * @param key 键
+     * @return 批量调用为该键填写的结果
+     * @details 批量调用抛出异常时，批次内的每个协程都重新抛出同一个异常
+     */
+    V load(const K& key)
+    {
+        std::shared_ptr<Batch> batch;
+        size_t index;
+        bool full = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(!m_current)
+            {
+                // 批次的第一个键：启动窗口定时器
+                m_current = std::make_shared<Batch>();
+                std::shared_ptr<Batch> b = m_current;
+                m_current->timer = m_iom->addTimer(m_windowMs, [this, b]()
+                {
+                    if(detach(b))
+                    {
+                        execute(b);
+                    }
+                });
+            }
+            batch = m_current;
+            index = batch->keys.size();
+            batch->keys.push_back(key);
+            if(batch->keys.size() >= m_maxBatch)
+            {
+                m_current.reset();
+                full = true;
+            }
+        }
+
+        if(full)
+        {
+            batch->timer->cancel();
+            execute(batch);
+        }
+
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        while(!batch->done)
+        {
+            batch->cond.wait(lock);
+        }
+        if(batch->error)
+        {
+            std::exception_ptr error = batch->error;
+            lock.unlock();
+            std::rethrow_exception(error);
+        }
+        return batch->values[index];
+    }
+
+    /**
+     * @brief 立即分发当前批次（不等待窗口到期）
+     * @details 在当前协程中执行批量调用；当前没有待分发的键时什么也不做。
+     *          批量调用抛出的异常交给批次内的等待者，不从flush()抛出
+     */
+    void flush()
+    {
+        std::shared_ptr<Batch> batch;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            batch.swap(m_current);
+        }
+        if(batch)
+        {
+            batch->timer->cancel();
+            execute(batch);
+        }
+    }
+
+    /**
+     * @brief 获取已分发的批次数
+     */
+    uint64_t getBatchCount() const {return m_batches.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 获取已分发的键数
+     */
+    uint64_t getKeyCount() const {return m_keys.load(std::memory_order_relaxed);}
+
+private:
+    /**
+     * @brief 批次
+     */
+    struct Batch
+    {
+        std::vector<K> keys;            // 键（在m_mutex下追加，分发后只读）
+        std::vector<V> values;          // 结果
+        std::shared_ptr<Timer> timer;   // 窗口定时器
+        std::mutex mutex;               // 保护done
+        FiberCondition cond;            // 批次完成时唤醒等待者
+        bool done = false;              // 是否已完成
+        std::exception_ptr error;       // 批量调用失败的原因（分发后只读）
+    };
+
+    /**
+     * @brief 窗口到期时把批次从聚合器中摘下
+     * @return 批次仍未被分发返回true
+     */
+    bool detach(const std::shared_ptr<Batch>& batch)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_current != batch)
+        {
+            return false;
+        }
+        m_current.reset();
+        return true;
+    }
+
+    /**
+     * @brief 执行批量调用并唤醒批次内所有协程
+     * @details 无论批量调用是否成功都会完成批次：异常保存在批次中由每个等待者重新抛出，
+     *          不会留下永远挂起的协程，也不会从定时器回调中抛出
+     */
+    void execute(const std::shared_ptr<Batch>& batch)
+    {
+        batch->values.resize(batch->keys.size());
+        try
+        {
+            m_fn(batch->keys, batch->values);
+            if(batch->values.size() != batch->keys.size())
+            {
+                throw std::length_error("BatchLoader: batch function changed the size of values");
+            }
+        }
+        catch(...)
+        {
+            batch->error = std::current_exception();
+        }
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+        m_keys.fetch_add(batch->keys.size(), std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        batch->done = true;
+        batch->cond.notifyAll();
+    }
+
+private:
+    BatchFunc m_fn;                         // 批量调用
+    size_t m_maxBatch;                      // 单个批次的最大键数
+    uint64_t m_windowMs;                    // 聚合窗口（毫秒）
+    IOManager* m_iom;                       // IO管理器
+    std::mutex m_mutex;                     // 保护m_current
+    std::shared_ptr<Batch> m_current;       // 正在聚合的批次
+    std::atomic<uint64_t> m_batches{0};     // 已分发的批次数
+    std::atomic<uint64_t> m_keys{0};        // 已分发的键数
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_BATCH_LOADER_H_
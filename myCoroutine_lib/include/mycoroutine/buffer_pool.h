@@ -0,0 +1,156 @@
+#ifndef __MYCOROUTINE_BUFFER_POOL_H_
+#define __MYCOROUTINE_BUFFER_POOL_H_
+
+/**
+ * @file buffer_pool.h
+ * @brief 线程级读缓冲区池头文件
+ * @details 连接空闲时不持有读缓冲区，数据就绪后才从当前线程的缓冲区池借用，
+ *          使大量空闲长连接的内存占用接近于零
+ */
+
+#include <cstddef>       // size_t
+#include <sys/types.h>   // ssize_t
+
+namespace mycoroutine {
+
+/**
+ * @brief 池化缓冲区
+ * @details 独占所有权，析构时归还给当前线程的缓冲区池（协程可能已迁移到其他线程）
+ */
+class PooledBuffer
+{
+public:
+    PooledBuffer() = default;
+    ~PooledBuffer();
+
+    PooledBuffer(PooledBuffer&& other) noexcept;
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    /**
+     * @brief 获取缓冲区首地址
+     */
+    char* data() const {return m_data;}
+
+    /**
+     * @brief 获取缓冲区容量
+     */
+    size_t capacity() const {return m_capacity;}
+
+    /**
+     * @brief 获取有效数据长度
+     */
+    size_t size() const {return m_size;}
+
+    /**
+     * @brief 设置有效数据长度
+     * @param n 有效数据长度，不能超过容量
+     */
+    void setSize(size_t n) {m_size = n;}
+
+    /**
+     * @brief 是否持有缓冲区
+     */
+    explicit operator bool() const {return m_data != nullptr;}
+
+    /**
+     * @brief 立即归还缓冲区
+     */
+    void reset();
+
+private:
+    friend class BufferPool;
+
+    /**
+     * @brief 构造函数（仅由BufferPool调用）
+     * @param data 缓冲区首地址
+     * @param capacity 缓冲区容量
+     */
+    PooledBuffer(char* data, size_t capacity): m_data(data), m_capacity(capacity) {}
+
+private:
+    char* m_data = nullptr;    // 缓冲区首地址
+    size_t m_capacity = 0;     // 缓冲区容量
+    size_t m_size = 0;         // 有效数据长度
+};
+
+/**
+ * @brief 线程级缓冲区池
+ * @details 每个线程缓存若干固定大小的缓冲区，借用和归还都不加锁
+ */
+class BufferPool
+{
+public:
+    /**
+     * @brief 从当前线程的缓冲区池借用一个缓冲区
+     * @return 池化缓冲区，分配失败时data()为nullptr、容量为0，并设置errno为ENOMEM
+     */
+    static PooledBuffer Acquire();
+
+    /**
+     * @brief 设置缓冲区大小（默认16KB），应在使用前设置
+     * @param size 缓冲区大小（字节）
+     */
+    static void SetBufferSize(size_t size);
+
+    /**
+     * @brief 获取缓冲区大小
+     */
+    static size_t GetBufferSize();
+
+    /**
+     * @brief 设置每个线程最多缓存的空闲缓冲区数量（默认64）
+     * @param count 缓存数量
+     */
+    static void SetMaxCached(size_t count);
+
+    /**
+     * @brief 获取每个线程最多缓存的空闲缓冲区数量
+     */
+    static size_t GetMaxCached();
+
+    /**
+     * @brief 获取当前线程缓存的空闲缓冲区数量
+     */
+    static size_t GetCachedCount();
+
+    /**
+     * @brief 在当前线程预先分配并触页若干缓冲区
+     * @param count 缓冲区数量，不超过每线程缓存上限
+     * @return 当前线程缓存的空闲缓冲区数量
+     */
+    static size_t Reserve(size_t count);
+
+    /**
+     * @brief 释放当前线程缓存的所有空闲缓冲区
+     */
+    static void Trim();
+
+private:
+    friend class PooledBuffer;
+
+    /**
+     * @brief 归还缓冲区
+     * @param data 缓冲区首地址
+     * @param capacity 缓冲区容量，与当前缓冲区大小不同时直接释放
+     */
+    static void Release(char* data, size_t capacity);
+};
+
+/**
+ * @brief 就绪驱动的接收
+ * @details 先在缓冲区池借用缓冲区尝试非阻塞recv；没有数据（EAGAIN）时立即归还缓冲区，
+ *          再挂起当前协程等待READ事件，因此等待期间连接不持有任何读缓冲区。
+ *          接收超时沿用setsockopt(SO_RCVTIMEO)设置到FdCtx中的值
+ * @param fd 套接字文件描述符
+ * @param out 输出参数，成功时持有包含数据的缓冲区
+ * @param flags recv标志
+ * @return 成功返回接收的字节数（0表示对端关闭），失败返回-1并设置errno
+ * @note 需要等待时只能在IOManager调度的协程中调用
+ */
+ssize_t recv_pooled(int fd, PooledBuffer& out, int flags = 0);
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_BUFFER_POOL_H_
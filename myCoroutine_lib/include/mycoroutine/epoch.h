@@ -0,0 +1,99 @@
+#ifndef __MYCOROUTINE_EPOCH_H_
+#define __MYCOROUTINE_EPOCH_H_
+
+/**
+ * @file epoch.h
+ * @brief 基于纪元的内存回收（EBR）头文件
+ * @details 为无锁发布的运行时数据结构（fd表等）提供延迟释放：对象从数据结构中摘除后调用Retire()，
+ *          等到所有线程都经过了两个纪元、不可能再持有旧指针时才真正释放。
+ *
+ *          两类读者：
+ *          1. 调度器工作线程：在Scheduler::run()中登记为在线，每次回到调度循环就是一个静止点（Quiescent），
+ *             两个静止点之间读到的指针一直有效，读路径不需要任何引用计数或额外指令；
+ *             进入idle（epoll_wait）前转为离线，阻塞期间不会拖住纪元推进
+ *          2. 其他线程（主线程、辅助线程等）：用EpochGuard划定临界区
+ */
+
+#include <cstdint>   // uint64_t
+#include <cstddef>   // size_t
+
+namespace mycoroutine {
+
+/**
+ * @brief 纪元回收域（进程内唯一）
+ * @note 在线线程持有的指针只在两个静止点之间有效，不能跨越协程yield保存
+ */
+class Epoch
+{
+public:
+    /**
+     * @brief 延迟释放对象
+     * @param ptr 已从数据结构中摘除的对象
+     * @param deleter 释放函数
+     * @details 对象被放入当前线程的待回收列表，在静止点或列表过长时回收
+     */
+    static void Retire(void* ptr, void (*deleter)(void*));
+
+    /**
+     * @brief 延迟delete对象
+     * @param ptr 已从数据结构中摘除的对象
+     */
+    template<class T>
+    static void Retire(T* ptr)
+    {
+        Retire(static_cast<void*>(ptr), [](void* p) {delete static_cast<T*>(p);});
+    }
+
+    /**
+     * @brief 当前线程登记为在线读者（调度器工作线程进入调度循环时调用）
+     */
+    static void Online();
+
+    /**
+     * @brief 当前线程转为离线（进入阻塞等待或退出调度循环时调用）
+     * @details 离线线程不阻止纪元推进，再次读取共享数据前需要Online()或使用EpochGuard
+     */
+    static void Offline();
+
+    /**
+     * @brief 静止点：当前在线线程声明不再持有任何受保护的指针
+     * @details 刷新本线程观察到的纪元，并在有待回收对象时尝试推进纪元、释放过期对象
+     */
+    static void Quiescent();
+
+    /**
+     * @brief 获取全局纪元
+     */
+    static uint64_t GetEpoch();
+
+    /**
+     * @brief 获取当前线程待回收的对象数
+     */
+    static size_t GetPendingCount();
+
+    /**
+     * @brief 获取累计已释放的对象数
+     */
+    static uint64_t GetFreedCount();
+};
+
+/**
+ * @brief 纪元临界区
+ * @details 在非在线线程上进入临界区，析构时离开，可以嵌套；在线线程上什么也不做
+ */
+class EpochGuard
+{
+public:
+    EpochGuard();
+    ~EpochGuard();
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+private:
+    bool m_pinned;   // 本次是否真正进入了临界区
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_EPOCH_H_
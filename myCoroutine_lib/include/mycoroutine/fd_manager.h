@@ -8,7 +8,9 @@
  */
 
 #include <memory>          // 智能指针
-#include <shared_mutex>    // 读写锁
+#include <mutex>           // 写者互斥锁
+#include <atomic>          // 无锁发布的查找表
+#include <vector>          // 上下文数组
 #include <mycoroutine/thread.h>        // 线程相关头文件
 
 
@@ -26,6 +28,7 @@ private:
 	bool m_sysNonblock = false;  // 系统层面是否非阻塞
 	bool m_userNonblock = false; // 用户层面是否非阻塞
 	bool m_isClosed = false;     // 文件描述符是否已关闭
+	bool m_rxTimestamping = false; // 是否开启了内核接收软件时间戳（SO_TIMESTAMPING）
 	int m_fd;                    // 文件描述符值
 
 	uint64_t m_recvTimeout = (uint64_t)-1; // 接收超时时间（毫秒）
@@ -91,6 +94,19 @@ public:
 	 */
 	bool getSysNonblock() const {return m_sysNonblock;}
 
+	/**
+	 * @brief 设置是否开启了内核接收软件时间戳
+	 * @param v 是否开启
+	 * @details 由hook的setsockopt(SO_TIMESTAMPING)维护，开启后hook的recvmsg会统计接收延迟
+	 */
+	void setRxTimestamping(bool v) {m_rxTimestamping = v;}
+
+	/**
+	 * @brief 获取是否开启了内核接收软件时间戳
+	 * @return 是否开启
+	 */
+	bool isRxTimestamping() const {return m_rxTimestamping;}
+
 	/**
 	 * @brief 设置文件描述符超时时间
 	 * @param type 超时类型，SO_RCVTIMEO(接收超时)或SO_SNDTIMEO(发送超时)
@@ -108,7 +124,9 @@ public:
 
 /**
  * @brief 文件描述符管理器类
- * @details 管理所有文件描述符的上下文对象，提供获取和删除功能
+ * @details 管理所有文件描述符的上下文对象，提供获取和删除功能。
+ *          上下文由m_datas中的shared_ptr持有，另有一张按描述符索引的裸指针表供无锁查找：
+ *          表在扩容/收缩时整体替换并原子发布，旧表和被删除的上下文交给纪元回收延迟释放
  */
 class FdManager
 {
@@ -118,11 +136,38 @@ public:
 	 */
 	FdManager();
 
+	/**
+	 * @brief 析构函数
+	 */
+	~FdManager();
+
+	/**
+	 * @brief 借用文件描述符对应的上下文对象（不增加引用计数、不加锁）
+	 * @param fd 文件描述符
+	 * @return 上下文指针，不存在时返回nullptr
+	 * @note 只能在纪元临界区内使用（调度器工作线程两个静止点之间，或EpochGuard作用域内），
+	 *       不能跨越协程yield保存；需要长期持有时使用get()
+	 */
+	FdCtx* lookup(int fd) const
+	{
+		if(fd < 0)
+		{
+			return nullptr;
+		}
+		std::vector<std::atomic<FdCtx*>>* table = m_table.load(std::memory_order_acquire);
+		if((size_t)fd >= table->size())
+		{
+			return nullptr;
+		}
+		return (*table)[fd].load(std::memory_order_acquire);
+	}
+
 	/**
 	 * @brief 获取文件描述符对应的上下文对象
 	 * @param fd 文件描述符
 	 * @param auto_create 是否自动创建上下文对象
 	 * @return 文件描述符上下文智能指针
+	 * @details 已存在的上下文经无锁查找返回，只有创建时才加锁
 	 */
 	std::shared_ptr<FdCtx> get(int fd, bool auto_create = false);
 	
@@ -132,22 +177,49 @@ public:
 	 */
 	void del(int fd);
 
+	/**
+	 * @brief 预分配上下文数组，避免运行期扩容
+	 * @param size 数组大小（可容纳的最大文件描述符+1）
+	 */
+	void reserve(size_t size);
+
+	/**
+	 * @brief 收缩上下文数组，释放末尾未使用的部分
+	 * @return 释放的槽位数量
+	 * @details 数组截断到最后一个仍在使用的描述符之后（至少保留初始的64个），
+	 *          仍被持有的上下文不受影响；之后更大的描述符会重新扩容
+	 */
+	size_t trim();
+
+	/**
+	 * @brief 获取存活的上下文数量（已登记、尚未删除的文件描述符数）
+	 */
+	size_t getContextCount() const {return m_count.load(std::memory_order_relaxed);}
+
 private:
-	std::shared_mutex m_mutex;                        // 读写锁，保护m_datas
-	std::vector<std::shared_ptr<FdCtx>> m_datas;      // 文件描述符上下文数组
+	/**
+	 * @brief 按m_datas的大小重建并发布查找表，旧表交给纪元回收（需持有m_mutex）
+	 */
+	void publishTable();
+
+private:
+	std::mutex m_mutex;                               // 互斥锁，串行化写者，保护m_datas
+	std::vector<std::shared_ptr<FdCtx>> m_datas;      // 文件描述符上下文数组（持有上下文）
+	std::atomic<std::vector<std::atomic<FdCtx*>>*> m_table{nullptr}; // 无锁查找表，与m_datas同样大小
+	std::atomic<size_t> m_count{0};                   // 存活的上下文数量（写者持有m_mutex，读者无锁读取）
 };
 
 /**
  * @brief 单例模板类
- * @details 提供线程安全的单例实现
+ * @details 提供线程安全的单例实现；实例创建后GetInstance()只有一次acquire读，不加锁
  * @tparam T 单例类型
  */
 template<typename T>
 class Singleton
 {
 private:
-    static T* instance;     // 单例实例指针
-    static std::mutex mutex; // 互斥锁，保证线程安全
+    static std::atomic<T*> instance; // 单例实例指针
+    static std::mutex mutex;         // 互斥锁，串行化创建和销毁
 
 protected:
     /**
@@ -166,22 +238,30 @@ public:
      */
     static T* GetInstance() 
     {
-        std::lock_guard<std::mutex> lock(mutex); // 加锁确保线程安全
-        if (instance == nullptr) 
+        T* p = instance.load(std::memory_order_acquire);
+        if (p != nullptr) 
+        {
+            return p;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex); // 首次创建时加锁，双重检查
+        p = instance.load(std::memory_order_relaxed);
+        if (p == nullptr) 
         {
-            instance = new T();  // 创建单例实例
+            p = new T();  // 创建单例实例
+            instance.store(p, std::memory_order_release);
         }
-        return instance;
+        return p;
     }
 
     /**
      * @brief 销毁单例实例
+     * @note 调用时不能有其他线程仍在使用实例
      */
     static void DestroyInstance() 
     {
         std::lock_guard<std::mutex> lock(mutex);
-        delete instance;
-        instance = nullptr;
+        delete instance.exchange(nullptr, std::memory_order_acq_rel);
     }
 };
 
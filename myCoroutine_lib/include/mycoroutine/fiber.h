@@ -6,16 +6,26 @@
 #include <atomic>       // 原子操作
 #include <functional>   // 函数对象
 #include <cassert>      // 断言
-#include <ucontext.h>   // 上下文切换
 #include <unistd.h>     // 系统调用
 #include <mutex>        // 互斥锁
 
+// x86-64以外的平台，或定义了MYCOROUTINE_FIBER_UCONTEXT（如配合sanitizer调试）时使用ucontext切换
+#if !defined(__x86_64__) && !defined(MYCOROUTINE_FIBER_UCONTEXT)
+#define MYCOROUTINE_FIBER_UCONTEXT
+#endif
+
+#ifdef MYCOROUTINE_FIBER_UCONTEXT
+#include <ucontext.h>   // 上下文切换
+#endif
+
 namespace mycoroutine {
 
 /**
- * @brief 协程类，基于ucontext_t实现的用户级协程
+ * @brief 协程类，用户级有栈协程
  * @details 该类实现了用户级协程功能，支持协程的创建、切换、恢复和销毁
- *          使用智能指针管理协程生命周期，避免资源泄漏
+ *          使用智能指针管理协程生命周期，避免资源泄漏。
+ *          x86-64上切换只保存被调用者保存的寄存器（压在协程自己的栈上），协程对象只记录栈指针；
+ *          Create()创建的协程与其shared_ptr控制块位于栈映射的顶端，一次mmap即得到整个协程
  */
 class Fiber : public std::enable_shared_from_this<Fiber>
 {
@@ -32,6 +42,11 @@ public:
     };
 
 private:
+    /**
+     * @brief Create()专用的构造函数标记，外部无法构造
+     */
+    struct MappingTag {};
+
     /**
      * @brief 私有构造函数，仅用于创建主协程
      * @details 主协程构造函数，由GetThis()调用
@@ -48,6 +63,26 @@ public:
      * @details 创建一个新的协程，分配栈空间并设置执行上下文
      */
     Fiber(std::function<void()> cb, size_t stacksize = 0, bool run_in_scheduler = true);
+
+    /**
+     * @brief 构造函数（通过Create创建），栈由控制块所在的映射提供
+     * @param stack 栈底地址
+     * @param stacksize 栈大小
+     * @param cb 协程要执行的回调函数
+     * @param run_in_scheduler 是否在调度器中运行
+     */
+    Fiber(const MappingTag&, void* stack, size_t stacksize, std::function<void()> cb, bool run_in_scheduler);
+
+    /**
+     * @brief 创建子协程：栈、协程对象和shared_ptr控制块在同一个mmap映射中
+     * @param cb 协程要执行的回调函数
+     * @param stacksize 协程栈大小，默认为0（使用默认大小128KB）
+     * @param run_in_scheduler 是否在调度器中运行
+     * @return 协程智能指针，映射不足时抛出std::bad_alloc
+     * @details 控制块和协程对象放在映射顶端，栈从其下方向低地址增长；
+     *          最后一个shared_ptr/weak_ptr释放时整个映射一起回到栈缓存或被解除映射
+     */
+    static std::shared_ptr<Fiber> Create(std::function<void()> cb, size_t stacksize = 0, bool run_in_scheduler = true);
     
     /**
      * @brief 析构函数
@@ -117,6 +152,39 @@ public:
      */
     static uint64_t GetFiberId();
 
+    /**
+     * @brief 设置每个线程最多缓存的空闲协程栈数量
+     * @param count 缓存数量，默认16，0表示不缓存，协程析构时直接解除映射
+     * @details 只缓存默认大小的栈映射（Create()创建的协程连同控制块一起缓存）；
+     *          缓存的映射在同一线程上创建新协程时复用，避免mmap/munmap和重新缺页
+     */
+    static void SetStackCacheSize(size_t count);
+
+    /**
+     * @brief 获取每个线程最多缓存的空闲协程栈数量
+     */
+    static size_t GetStackCacheSize();
+
+    /**
+     * @brief 在当前线程预先分配并触页若干协程栈，放入栈缓存
+     * @param count 栈数量，不超过栈缓存上限
+     * @return 当前线程缓存的栈数量
+     * @details 逐页写入一次，使首次运行协程时不再产生缺页中断
+     */
+    static size_t PrefaultStacks(size_t count);
+
+    /**
+     * @brief 获取当前线程缓存的空闲协程栈数量
+     */
+    static size_t GetCachedStackCount();
+
+    /**
+     * @brief 释放当前线程缓存的所有空闲协程栈
+     * @return 释放的栈数量
+     * @details 不改变缓存上限，之后析构的协程仍会放回缓存
+     */
+    static size_t TrimStackCache();
+
     /**
      * @brief 协程入口函数
      * @details 所有协程的统一入口点，负责执行协程回调函数
@@ -125,13 +193,30 @@ public:
     static void MainFunc();
 
 private:
-    uint64_t m_id = 0;            ///< 协程ID，唯一标识一个协程
-    uint32_t m_stacksize = 0;     ///< 协程栈大小
-    State m_state = READY;        ///< 协程状态
+    /**
+     * @brief 在栈上构造初始上下文，使首次切换进入MainFunc
+     */
+    void initContext();
+
+    /**
+     * @brief 保存当前上下文到from并切换到to
+     */
+    static void SwitchContext(Fiber* from, Fiber* to);
+
+private:
+    // 切换时访问的字段放在前面，与enable_shared_from_this的弱引用共占第一个缓存行
+#ifdef MYCOROUTINE_FIBER_UCONTEXT
     ucontext_t m_ctx;             ///< 协程上下文，保存执行环境
+#else
+    void* m_sp = nullptr;         ///< 挂起时的栈指针，寄存器保存在协程自己的栈上
+#endif
+    State m_state = READY;        ///< 协程状态
+    bool m_runInScheduler = true; ///< 是否在调度器中运行，决定让出时返回到哪个协程
+    bool m_ownsStack = false;     ///< 析构时是否释放栈（Create()创建的协程由控制块释放整个映射）
+    uint32_t m_stacksize = 0;     ///< 协程栈大小
     void* m_stack = nullptr;      ///< 协程栈指针，指向分配的栈空间
+    uint64_t m_id = 0;            ///< 协程ID，唯一标识一个协程
     std::function<void()> m_cb;   ///< 协程回调函数，协程要执行的任务
-    bool m_runInScheduler;        ///< 是否在调度器中运行，决定让出时返回到哪个协程
 
 public:
     std::mutex m_mutex;           ///< 协程互斥锁，用于同步操作
@@ -0,0 +1,98 @@
+#ifndef __MYCOROUTINE_FIBER_SYNC_H_
+#define __MYCOROUTINE_FIBER_SYNC_H_
+
+/**
+ * @file fiber_sync.h
+ * @brief 协程同步原语头文件
+ * @details 提供协程级别的条件变量：等待时挂起当前协程而不是阻塞工作线程
+ */
+
+#include <mycoroutine/scheduler.h>  // 调度器，用于重新调度被唤醒的协程
+
+#include <list>       // 等待队列
+#include <mutex>      // 互斥锁
+#include <memory>     // 智能指针
+#include <atomic>     // 原子操作
+
+namespace mycoroutine {
+
+/**
+ * @brief 协程条件变量
+ * @details 语义与std::condition_variable相同，但wait()只挂起当前协程，
+ *          工作线程可以继续执行其他任务。notify可以在任意线程（包括非协程线程）中调用，
+ *          被唤醒的协程会被重新放回它所属调度器的任务队列
+ * @note wait()/waitFor()只能在调度器调度的协程中调用
+ */
+class FiberCondition
+{
+public:
+    FiberCondition() = default;
+    FiberCondition(const FiberCondition&) = delete;
+    FiberCondition& operator=(const FiberCondition&) = delete;
+
+    /**
+     * @brief 挂起当前协程直到被唤醒
+     * @param lock 调用者持有的锁，挂起前释放，恢复后重新获取
+     */
+    void wait(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * @brief 带超时的等待
+     * @param lock 调用者持有的锁，挂起前释放，恢复后重新获取
+     * @param timeout_ms 超时时间（毫秒），(uint64_t)-1表示永不超时
+     * @return 被唤醒返回true，超时返回false
+     * @details 超时依赖当前线程的IOManager定时器
+     */
+    bool waitFor(std::unique_lock<std::mutex>& lock, uint64_t timeout_ms);
+
+    /**
+     * @brief 唤醒一个等待的协程
+     */
+    void notifyOne();
+
+    /**
+     * @brief 唤醒所有等待的协程
+     */
+    void notifyAll();
+
+private:
+    /**
+     * @brief 等待者信息
+     */
+    struct Waiter
+    {
+        Scheduler* scheduler = nullptr;     // 协程所属的调度器
+        std::shared_ptr<Fiber> fiber;       // 等待中的协程
+        std::atomic<bool> woken = {false};  // 是否已被唤醒（notify或超时），保证只调度一次
+        bool timedout = false;              // 是否因超时被唤醒
+    };
+
+    /**
+     * @brief 为当前协程创建等待者信息
+     * @return 等待者信息
+     */
+    static std::shared_ptr<Waiter> newWaiter();
+
+    /**
+     * @brief 将当前协程加入等待队列并让出执行权
+     * @param lock 调用者持有的锁
+     * @param waiter 当前协程的等待者信息
+     */
+    void suspend(std::unique_lock<std::mutex>& lock, const std::shared_ptr<Waiter>& waiter);
+
+    /**
+     * @brief 唤醒一个等待者
+     * @param waiter 等待者
+     * @param timedout 是否由超时定时器唤醒
+     * @return 若该等待者此前尚未被唤醒则返回true
+     */
+    static bool wake(const std::shared_ptr<Waiter>& waiter, bool timedout = false);
+
+private:
+    std::mutex m_mutex;                             // 保护等待队列
+    std::list<std::shared_ptr<Waiter>> m_waiters;   // 等待队列（FIFO）
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_FIBER_SYNC_H_
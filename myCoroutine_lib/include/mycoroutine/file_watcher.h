@@ -0,0 +1,171 @@
+#ifndef __MYCOROUTINE_FILE_WATCHER_H_
+#define __MYCOROUTINE_FILE_WATCHER_H_
+
+/**
+ * @file file_watcher.h
+ * @brief 文件变更监视头文件
+ * @details 把inotify fd注册到IOManager，可读时批量解析变更事件，
+ *          递增订阅的代数（generation）、唤醒等待的协程并调度回调。
+ *          缓存只需比较代数即可判断文件是否变化，请求路径上不再需要stat
+ */
+
+#include <mycoroutine/iomanager.h>   // IO管理器
+#include <mycoroutine/fiber_sync.h>  // 协程条件变量
+
+#include <sys/inotify.h>    // IN_*事件掩码
+#include <string>           // 路径
+#include <vector>           // 事件批次
+#include <map>              // wd到订阅的映射
+#include <memory>           // 智能指针
+#include <mutex>            // 互斥锁
+#include <atomic>           // 代数
+#include <functional>       // 回调
+
+namespace mycoroutine {
+
+/**
+ * @brief 文件变更事件
+ */
+struct FileEvent
+{
+    std::string path;   // 订阅的路径
+    std::string name;   // 订阅目录时为目录内的文件名，订阅文件本身时为空
+    uint32_t mask;      // IN_*事件掩码
+};
+
+/**
+ * @brief 文件变更监视器
+ * @details 同一次read()读到的事件按订阅分组并去重后一次性投递。
+ *          inotify队列溢出（IN_Q_OVERFLOW）时所有订阅的代数都会递增，缓存应全部重新校验
+ * @note inotify fd上始终注册着READ事件，IOManager停止前必须调用stop()
+ */
+class FileWatcher : public std::enable_shared_from_this<FileWatcher>
+{
+public:
+    /**
+     * @brief 批量事件回调，在IOManager调度的新协程中执行
+     */
+    typedef std::function<void(const std::vector<FileEvent>&)> Callback;
+
+    // 默认关注的事件：内容修改、写关闭、属性变化、目录内创建/删除/移入移出，以及被监视对象本身被删除或移动
+    static const uint32_t kDefaultMask = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE |
+                                         IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+    /**
+     * @brief 订阅
+     */
+    class Watch
+    {
+    friend class FileWatcher;
+    public:
+        /**
+         * @brief 构造函数（通过FileWatcher::watch创建）
+         */
+        Watch(const std::string& path, uint32_t mask, Callback cb);
+
+        /**
+         * @brief 获取代数，每批事件加一
+         */
+        uint64_t getGeneration() const {return m_generation.load(std::memory_order_acquire);}
+
+        /**
+         * @brief 挂起当前协程直到代数不等于seen
+         * @param seen 调用者已经处理过的代数
+         * @param timeout_ms 超时时间（毫秒），(uint64_t)-1表示永不超时
+         * @return 代数已变化返回true；超时或订阅已失效返回false
+         */
+        bool waitChange(uint64_t seen, uint64_t timeout_ms = (uint64_t)-1);
+
+        /**
+         * @brief 获取订阅的路径
+         */
+        const std::string& getPath() const {return m_path;}
+
+        /**
+         * @brief 订阅是否仍然有效
+         * @details 被监视对象删除或移动、取消订阅、监视器停止后失效
+         */
+        bool isActive() const {return m_active;}
+
+    private:
+        /**
+         * @brief 代数加一并唤醒等待者
+         * @param active 之后订阅是否仍然有效
+         */
+        void bump(bool active);
+
+    private:
+        std::string m_path;                    // 订阅的路径
+        uint32_t m_mask;                       // 关注的事件
+        Callback m_cb;                         // 回调，可以为空
+        int m_wd = -1;                         // inotify监视描述符
+        std::atomic<uint64_t> m_generation{0}; // 代数
+        std::atomic<bool> m_active{true};      // 是否有效
+        std::mutex m_mutex;                    // 配合m_cond使用
+        FiberCondition m_cond;                 // 代数变化时唤醒waitChange()
+    };
+
+    /**
+     * @brief 创建监视器并在IOManager中注册inotify fd
+     * @param iom 事件处理和回调所在的IO管理器
+     * @return 成功返回监视器，失败返回nullptr（errno指示原因）
+     */
+    static std::shared_ptr<FileWatcher> Create(IOManager* iom = IOManager::GetThis());
+
+    /**
+     * @brief 构造函数（通过Create创建）
+     * @param fd inotify文件描述符
+     * @param iom IO管理器
+     */
+    FileWatcher(int fd, IOManager* iom);
+
+    /**
+     * @brief 析构函数，关闭inotify fd
+     */
+    ~FileWatcher();
+
+    /**
+     * @brief 订阅文件或目录
+     * @param path 路径
+     * @param mask 关注的事件
+     * @param cb 批量事件回调，可以为空（只使用代数或waitChange）
+     * @return 成功返回订阅，失败返回nullptr（errno指示原因）
+     * @details 被原子替换（写临时文件后rename）的文件应订阅其所在目录，订阅文件本身会在替换后失效
+     */
+    std::shared_ptr<Watch> watch(const std::string& path, uint32_t mask = kDefaultMask, Callback cb = nullptr);
+
+    /**
+     * @brief 取消订阅
+     * @param watch 订阅
+     */
+    void unwatch(const std::shared_ptr<Watch>& watch);
+
+    /**
+     * @brief 取消inotify fd上的READ事件，所有订阅失效
+     */
+    void stop();
+
+private:
+    /**
+     * @brief inotify fd可读时的回调：读空事件队列，投递后重新注册READ事件
+     */
+    void onReadable();
+
+    /**
+     * @brief 解析一次read()读到的事件并投递
+     * @param buf 事件数据
+     * @param len 数据长度
+     */
+    void dispatch(const char* buf, size_t len);
+
+private:
+    int m_fd;                                                  // inotify文件描述符
+    IOManager* m_iom;                                          // IO管理器
+    std::mutex m_mutex;                                        // 保护m_watches和m_stopping
+    std::map<int, std::vector<std::shared_ptr<Watch>>> m_watches; // 监视描述符到订阅的映射
+    bool m_stopping = false;                                   // 是否正在停止
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_FILE_WATCHER_H_
@@ -0,0 +1,156 @@
+#ifndef __MYCOROUTINE_HISTOGRAM_H_
+#define __MYCOROUTINE_HISTOGRAM_H_
+
+/**
+ * @file histogram.h
+ * @brief 延迟直方图头文件
+ * @details 对数-线性分桶的无锁直方图，用于记录各类延迟分布
+ */
+
+#include <atomic>     // 原子计数
+#include <cstdint>    // uint64_t
+#include <cstddef>    // size_t
+#include <memory>     // unique_ptr
+
+namespace mycoroutine {
+
+/**
+ * @brief 延迟直方图
+ * @details 小于16的值每个值一个桶；之后每个2的幂区间再等分为8个子桶，相对误差不超过12.5%。
+ *          记录操作只有几次relaxed原子加法，可以在热路径上多线程并发调用。
+ *          数值单位由调用者决定（运行时内部统一使用微秒）
+ */
+class Histogram
+{
+public:
+    static const size_t kLinearBuckets = 16;   // 线性区桶数
+    static const size_t kSubBuckets = 8;       // 每个2的幂区间的子桶数
+    static const size_t kBuckets = kLinearBuckets + (64 - 4) * kSubBuckets;  // 总桶数
+
+    Histogram();
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    /**
+     * @brief 记录一个样本
+     * @param value 样本值
+     */
+    void record(uint64_t value);
+
+    /**
+     * @brief 合并另一个直方图的样本
+     * @param other 另一个直方图
+     */
+    void merge(const Histogram& other);
+
+    /**
+     * @brief 清空所有样本
+     */
+    void reset();
+
+    /**
+     * @brief 获取样本数
+     */
+    uint64_t count() const {return m_count.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 获取样本最大值
+     */
+    uint64_t max() const {return m_max.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 获取样本平均值
+     */
+    double mean() const;
+
+    /**
+     * @brief 获取分位数
+     * @param p 分位（0~100），例如99表示P99
+     * @return 分位数所在桶的上界，没有样本时返回0
+     */
+    uint64_t percentile(double p) const;
+
+private:
+    /**
+     * @brief 计算样本所在桶的下标
+     * @param value 样本值
+     */
+    static size_t bucketIndex(uint64_t value);
+
+    /**
+     * @brief 计算桶的上界
+     * @param index 桶下标
+     */
+    static uint64_t bucketUpper(size_t index);
+
+private:
+    std::atomic<uint64_t> m_buckets[kBuckets];  // 各桶计数
+    std::atomic<uint64_t> m_count;              // 样本数
+    std::atomic<uint64_t> m_sum;                // 样本和
+    std::atomic<uint64_t> m_max;                // 样本最大值
+};
+
+/**
+ * @brief 滚动窗口直方图
+ * @details 把时间划分为若干固定长度的时间片，每个时间片一个Histogram，环形复用。
+ *          查询时只合并最近一个窗口内的时间片，旧数据自然过期，适合长期运行时观察近期延迟。
+ *          时间片切换时由第一个写入者清空旧数据，切换瞬间并发写入的少量样本可能丢失
+ */
+class RollingHistogram
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param slots 时间片数量
+     * @param slot_ms 每个时间片的长度（毫秒），窗口长度为slots*slot_ms
+     */
+    RollingHistogram(size_t slots = 6, uint64_t slot_ms = 10000);
+    RollingHistogram(const RollingHistogram&) = delete;
+    RollingHistogram& operator=(const RollingHistogram&) = delete;
+
+    /**
+     * @brief 记录一个样本到当前时间片
+     * @param value 样本值
+     */
+    void record(uint64_t value);
+
+    /**
+     * @brief 把窗口内的样本合并到out中
+     * @param out 输出直方图，调用者通常先reset()
+     */
+    void snapshot(Histogram& out) const;
+
+    /**
+     * @brief 清空所有样本
+     */
+    void reset();
+
+    /**
+     * @brief 获取窗口长度（毫秒）
+     */
+    uint64_t getWindowMs() const {return m_slotCount * m_slotMs;}
+
+private:
+    /**
+     * @brief 时间片
+     */
+    struct Slot
+    {
+        std::atomic<uint64_t> epoch{0};  // 时间片编号（当前时间/时间片长度）
+        Histogram hist;                  // 时间片内的样本
+    };
+
+    /**
+     * @brief 获取当前时间片编号
+     */
+    uint64_t currentEpoch() const;
+
+private:
+    std::unique_ptr<Slot[]> m_slots;  // 环形时间片数组
+    size_t m_slotCount;               // 时间片数量
+    uint64_t m_slotMs;                // 时间片长度（毫秒）
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_HISTOGRAM_H_
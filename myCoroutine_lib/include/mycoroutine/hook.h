@@ -12,6 +12,9 @@
 #include <sys/uio.h>
 #include <sys/ioctl.h>
 #include <fcntl.h>
+#include <netdb.h>
+#include <stdint.h>
+#include <mycoroutine/histogram.h>
 
 namespace mycoroutine{
 
@@ -27,6 +30,79 @@ bool is_hook_enable();
  */
 void set_hook_enable(bool flag);
 
+/**
+ * @brief 为监听套接字设置服务端默认选项
+ * @details 依次设置TCP_NODELAY（accept得到的连接会继承）、TCP_DEFER_ACCEPT（数据到达后才唤醒accept）
+ *          和TCP_FASTOPEN（允许客户端在SYN中携带数据），应在listen()之前调用。
+ *          某个选项设置失败不影响其余选项
+ * @param fd 监听套接字文件描述符
+ * @param fastopen_qlen TCP Fast Open等待队列长度，0表示不开启
+ * @param defer_accept_secs TCP_DEFER_ACCEPT等待数据的秒数，0表示不开启
+ * @return 全部成功返回0，任一选项失败返回-1（errno为第一个失败选项的错误码）
+ */
+int tune_listen_socket(int fd, int fastopen_qlen = 256, int defer_accept_secs = 1);
+
+/**
+ * @brief 建立连接并发送第一段数据（TCP Fast Open）
+ * @details 优先使用TCP_FASTOPEN_CONNECT，否则使用sendto(MSG_FASTOPEN)，
+ *          对已有Fast Open cookie的对端，数据随SYN一起发出，省去一次往返；
+ *          内核或对端不支持时退化为普通connect+send。等待期间挂起当前协程
+ * @param fd 套接字文件描述符（通过hook的socket()创建）
+ * @param addr 目标地址
+ * @param addrlen 地址长度
+ * @param buf 要发送的数据
+ * @param len 数据长度
+ * @param timeout_ms 连接超时时间（毫秒），(uint64_t)-1表示永不超时
+ * @return 成功返回发送的字节数（等于len），失败返回-1并设置errno
+ */
+ssize_t connect_and_send(int fd, const struct sockaddr* addr, socklen_t addrlen,
+                         const void* buf, size_t len, uint64_t timeout_ms = (uint64_t)-1);
+
+/**
+ * @brief 并行连接多个候选地址（Happy Eyeballs，RFC 8305）
+ * @details 候选地址按地址族交替排列（保留getaddrinfo给出的优先顺序，首个地址族优先），
+ *          每隔attempt_delay_ms发起下一个非阻塞连接，某个尝试失败时立即发起下一个；
+ *          所有进行中的连接通过IOManager::addEvent(WRITE)等待，发起间隔和总超时共用一个定时器。
+ *          第一个成功的连接被返回，其余连接被关闭。等待期间挂起当前协程，不在协程中时依次阻塞连接
+ * @param addrs 候选地址链表（getaddrinfo的结果，只使用SOCK_STREAM地址）
+ * @param timeout_ms 总超时时间（毫秒），(uint64_t)-1表示永不超时
+ * @param attempt_delay_ms 相邻两次尝试的发起间隔（毫秒），RFC 8305建议250ms
+ * @return 成功返回已连接的套接字（在协程中时已登记到FdManager，与hook的socket()创建的套接字相同），
+ *         失败返回-1并设置errno（超时为ETIMEDOUT，否则为最后一次尝试的错误）
+ */
+int connect_any(const struct addrinfo* addrs, uint64_t timeout_ms = (uint64_t)-1, uint64_t attempt_delay_ms = 250);
+
+/**
+ * @brief 接收延迟统计（单位：微秒）
+ * @details 由开启了内核接收时间戳的套接字上的hook recvmsg记录：
+ *          total    内核收到报文 -> recvmsg返回给用户
+ *          wakeup   内核收到报文 -> epoll_wait报告就绪（仅协程曾挂起等待时记录）
+ *          queueing epoll报告就绪 -> 协程在工作线程上恢复执行，即调度队列排队时间（仅协程曾挂起等待时记录）
+ *          数据在协程到来之前已经在套接字中积压时只记录total
+ */
+struct RxLatencyStats
+{
+    Histogram total;     // 端到端接收延迟
+    Histogram wakeup;    // epoll唤醒延迟
+    Histogram queueing;  // 调度排队延迟
+};
+
+/**
+ * @brief 获取全局接收延迟统计
+ * @return 接收延迟统计
+ */
+RxLatencyStats& rx_latency_stats();
+
+/**
+ * @brief 为套接字开启内核接收软件时间戳
+ * @details 设置SO_TIMESTAMPING(SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE)并标记FdCtx。
+ *          之后通过hook的recvmsg接收时（需提供msg_control缓冲区，建议CMSG_SPACE(3 * sizeof(timespec))以上），
+ *          会解析SCM_TIMESTAMPING控制消息并记录到rx_latency_stats()
+ * @param fd 套接字文件描述符
+ * @return 成功返回0，失败返回-1并设置errno
+ */
+int enable_rx_timestamping(int fd);
+
 }
 
 // 使用C链接，确保函数名不被C++编译器修饰
@@ -91,6 +167,15 @@ extern "C"
 	 */
 	extern accept_fun accept_f;
 
+	/**
+	 * @brief accept4函数指针类型
+	 */
+	typedef int (*accept4_fun) (int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags);
+	/**
+	 * @brief 原始accept4函数指针
+	 */
+	extern accept4_fun accept4_f;
+
 	/**
 	 * @brief read函数指针类型
 	 */
@@ -290,6 +375,17 @@ extern "C"
 	 */
 	int accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen);
 
+	/**
+	 * @brief accept4函数钩子
+	 * @details 与accept相同，flags中的SOCK_NONBLOCK使新连接的IO返回EAGAIN而不是挂起协程
+	 * @param sockfd 监听socket文件描述符
+	 * @param addr 客户端地址结构（输出参数）
+	 * @param addrlen 地址结构长度（输入/输出参数）
+	 * @param flags SOCK_NONBLOCK、SOCK_CLOEXEC
+	 * @return 成功返回新的连接socket文件描述符，失败返回-1并设置errno
+	 */
+	int accept4(int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags);
+
 	/**
 	 * @brief 读取相关函数钩子
 	 */
@@ -0,0 +1,90 @@
+#ifndef __MYCOROUTINE_HTTP_PARSER_H_
+#define __MYCOROUTINE_HTTP_PARSER_H_
+
+/**
+ * @file http_parser.h
+ * @brief HTTP/1.x请求解析器头文件
+ * @details 零拷贝解析请求行和请求头，结果以string_view指向原始缓冲区。
+ *          分隔符和头部名称的扫描按CPU能力在运行时选择AVX2、SSE4.2或标量实现。
+ *          属于独立的mycoroutine_http库，不依赖协程运行时
+ */
+
+#include <cstddef>       // size_t
+#include <string_view>   // string_view
+
+namespace mycoroutine {
+
+/**
+ * @brief 单个请求头
+ */
+struct HttpHeader
+{
+    std::string_view name;   // 头部名称
+    std::string_view value;  // 头部值（已去掉首尾空白）
+};
+
+/**
+ * @brief 解析后的请求
+ * @details 所有string_view都指向传入parse_http_request()的缓冲区，缓冲区释放后失效
+ */
+struct HttpRequest
+{
+    static const size_t kMaxHeaders = 64;  // 最多解析的请求头数量
+
+    std::string_view method;               // 请求方法
+    std::string_view path;                 // 请求目标
+    int minorVersion = 0;                  // HTTP/1.x中的x
+    HttpHeader headers[kMaxHeaders];       // 请求头
+    size_t headerCount = 0;                // 请求头数量
+
+    /**
+     * @brief 查找请求头（名称不区分大小写）
+     * @param name 头部名称
+     * @return 找到返回指向该请求头的指针，否则返回nullptr
+     */
+    const HttpHeader* findHeader(std::string_view name) const;
+};
+
+/**
+ * @brief 扫描实现
+ */
+enum class HttpScanImpl
+{
+    AUTO = 0,   // 按CPU能力自动选择
+    SCALAR,     // 查表逐字节扫描
+    SSE42,      // SSE4.2 PCMPESTRI区间匹配
+    AVX2        // AVX2 PCMPEQB/PSHUFB掩码
+};
+
+/**
+ * @brief 解析HTTP/1.x请求行和请求头
+ * @param buf 数据缓冲区
+ * @param len 数据长度
+ * @param req 输出参数，解析结果
+ * @return 成功返回请求头结束位置（含空行）的字节数；数据不完整返回-2；格式错误返回-1
+ * @note 不支持obs-fold续行，请求头超过kMaxHeaders视为格式错误
+ */
+int parse_http_request(const char* buf, size_t len, HttpRequest& req);
+
+/**
+ * @brief 指定扫描实现
+ * @param impl 扫描实现，AUTO表示按CPU能力选择；CPU不支持的实现会退回到自动选择
+ * @return 实际生效的实现
+ * @details 主要用于基准测试和对比验证，应在开始解析之前调用
+ */
+HttpScanImpl set_http_scan_impl(HttpScanImpl impl);
+
+/**
+ * @brief 获取当前生效的扫描实现
+ */
+HttpScanImpl get_http_scan_impl();
+
+/**
+ * @brief 获取扫描实现的名称
+ * @param impl 扫描实现
+ */
+const char* http_scan_impl_name(HttpScanImpl impl);
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_HTTP_PARSER_H_
@@ -47,6 +47,8 @@ private:
         EventContext write;     // 写事件上下文
         int fd = 0;             // 文件描述符
         Event events = NONE;    // 当前注册的事件
+        uint64_t readReadyTime = 0; // 最近一次epoll报告读就绪的时间（微秒，CLOCK_REALTIME）
+        bool retired = false;   // 已被收缩从表中摘除，等待纪元回收
         std::mutex mutex;       // 用于保护该结构体的互斥锁
 
         /**
@@ -75,8 +77,10 @@ public:
      * @param threads 工作线程数量
      * @param use_caller 是否将调用者线程作为工作线程
      * @param name IO管理器名称
+     * @param warmup 启动预热配置，默认不预热
      */
-    IOManager(size_t threads = 1, bool use_caller = true, const std::string &name = "IOManager");
+    IOManager(size_t threads = 1, bool use_caller = true, const std::string &name = "IOManager",
+              const WarmupConfig &warmup = WarmupConfig());
     
     /**
      * @brief 析构函数
@@ -115,12 +119,49 @@ public:
      */
     bool cancelAll(int fd);
 
+    /**
+     * @brief 挂起当前协程直到文件描述符上的事件就绪或超时
+     * @param fd 文件描述符
+     * @param event 事件类型（READ或WRITE）
+     * @param timeout_ms 超时时间（毫秒），(uint64_t)-1表示永不超时
+     * @return 事件就绪返回0；超时返回-1且errno为ETIMEDOUT；注册事件失败返回-1
+     * @details 只能在调度器调度的协程中调用，供不经过hook的组件等待IO就绪
+     */
+    int waitEvent(int fd, Event event, uint64_t timeout_ms = (uint64_t)-1);
+
+    /**
+     * @brief 获取最近一次epoll报告文件描述符读就绪的时间
+     * @param fd 文件描述符
+     * @return 微秒时间戳（CLOCK_REALTIME，可与内核接收时间戳直接比较），未就绪过返回0
+     */
+    uint64_t getReadReadyTime(int fd);
+
+    /**
+     * @brief 获取已注册但尚未触发的IO事件数量
+     * @return 待处理事件数量
+     */
+    size_t getPendingEventCount() const {return m_pendingEventCount;}
+
     /**
      * @brief 获取当前线程的IO管理器实例
      * @return IO管理器指针
      */
     static IOManager* GetThis();
 
+    /**
+     * @brief 收缩文件描述符上下文数组，释放末尾没有注册事件的上下文
+     * @param min_size 至少保留的数组大小
+     * @return 释放的上下文数量
+     * @details 旧表和被摘除的上下文交给纪元回收；之后更大的文件描述符会重新扩容
+     */
+    size_t trimFdContexts(size_t min_size = 32);
+
+    /**
+     * @brief 释放缓存以降低内存占用
+     * @details 在基类的基础上收缩fd上下文表和FdManager的表
+     */
+    void trimCaches() override;
+
 protected:
     /**
      * @brief 唤醒一个空闲线程
@@ -149,16 +190,24 @@ protected:
 
     /**
      * @brief 调整文件描述符上下文数组大小
-     * @param size 新的数组大小
+     * @param size 新的数组大小（只增不减）
      */
     void contextResize(size_t size);
 
+    /**
+     * @brief 获取文件描述符上下文
+     * @param fd 文件描述符
+     * @param auto_create 表不够大时是否扩容
+     * @return 文件描述符上下文，不存在返回nullptr
+     */
+    FdContext* getFdContext(int fd, bool auto_create = false);
+
 private:
     int m_epfd = 0;                      // epoll文件描述符
     int m_tickleFds = 0;                 // 线程唤醒eventfd
     std::atomic<size_t> m_pendingEventCount = {0}; // 待处理事件数量
-    std::shared_mutex m_mutex;           // 用于保护m_fdContexts的读写锁
-    std::vector<FdContext *> m_fdContexts; // 文件描述符上下文数组
+    std::mutex m_resizeMutex;            // 串行化m_fdContexts扩容
+    std::atomic<std::vector<FdContext *>*> m_fdContexts{nullptr}; // 文件描述符上下文数组（无锁读取，旧表由纪元回收释放）
 };
 
 } // end namespace mycoroutine
@@ -0,0 +1,135 @@
+#ifndef __MYCOROUTINE_MEMORY_PRESSURE_H_
+#define __MYCOROUTINE_MEMORY_PRESSURE_H_
+
+/**
+ * @file memory_pressure.h
+ * @brief 内存压力感知头文件
+ * @details 通过PSI（/proc/pressure/memory或cgroup v2的memory.pressure）注册停顿阈值触发器，
+ *          触发时释放运行时的各级缓存：回调协程池、协程栈缓存、读缓冲池、fd上下文表的空闲尾部，
+ *          并调用malloc_trim()把空闲堆内存还给内核；压力解除后恢复缓存上限，缓存按需重新增长
+ */
+
+#include <mycoroutine/iomanager.h>   // IO管理器
+
+#include <string>           // 路径
+#include <memory>           // 智能指针
+#include <mutex>            // 互斥锁
+#include <atomic>           // 计数器
+
+namespace mycoroutine {
+
+/**
+ * @brief 内存压力监视配置
+ */
+struct MemoryPressureConfig
+{
+    std::string path;               // PSI文件，为空时优先使用所在cgroup v2的memory.pressure，否则/proc/pressure/memory
+    bool full = false;              // false监视some（至少一个任务因内存停顿），true监视full（所有任务同时停顿）
+    uint64_t stall_us = 150000;     // 统计窗口内累计停顿超过该值时触发
+    uint64_t window_us = 2000000;   // 统计窗口；没有CAP_SYS_RESOURCE时必须是2秒的整数倍
+    uint64_t recover_ms = 10000;    // 最后一次触发后经过该时间没有新的触发，认为压力解除
+};
+
+/**
+ * @brief 内存压力监视器
+ * @details PSI fd始终报告可读，只有POLLPRI表示触发，不能直接注册到只监听EPOLLIN的IOManager；
+ *          因此把它以EPOLLPRI注册到一个内部epoll实例，再把内部epoll fd以READ注册到IOManager。
+ *          压力期间缓存上限置0、暂停回调协程池的填充，避免刚释放的内存又被缓存占回
+ * @note 内部epoll fd上始终注册着READ事件，IOManager停止前必须调用stop()
+ */
+class MemoryPressureMonitor : public std::enable_shared_from_this<MemoryPressureMonitor>
+{
+public:
+    /**
+     * @brief 创建监视器并注册PSI触发器
+     * @param iom 事件处理和释放任务所在的IO管理器
+     * @param config 配置
+     * @return 成功返回监视器，内核不支持PSI或没有权限时返回nullptr（errno指示原因）
+     */
+    static std::shared_ptr<MemoryPressureMonitor> Create(IOManager* iom = IOManager::GetThis(),
+                                                         const MemoryPressureConfig& config = MemoryPressureConfig());
+
+    /**
+     * @brief 构造函数（通过Create创建）
+     * @param psi_fd 已写入触发器的PSI文件描述符
+     * @param epfd 监听psi_fd的内部epoll文件描述符
+     * @param path PSI文件路径
+     * @param iom IO管理器
+     * @param config 配置
+     */
+    MemoryPressureMonitor(int psi_fd, int epfd, const std::string& path, IOManager* iom,
+                          const MemoryPressureConfig& config);
+
+    /**
+     * @brief 析构函数，关闭文件描述符
+     */
+    ~MemoryPressureMonitor();
+
+    /**
+     * @brief 取消内部epoll fd上的READ事件和恢复定时器，已降低的缓存上限立即恢复
+     */
+    void stop();
+
+    /**
+     * @brief 手动触发一次内存压力处理
+     * @details 与PSI触发的处理相同，可用于接入其他信号源或测试
+     */
+    void trigger();
+
+    /**
+     * @brief 是否处于内存压力状态
+     */
+    bool isUnderPressure() const {return m_underPressure.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 获取触发次数（含手动触发）
+     */
+    uint64_t getTriggerCount() const {return m_triggers.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 获取进入压力状态的次数
+     */
+    uint64_t getPressureCount() const {return m_pressures.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 获取PSI文件路径
+     */
+    const std::string& getPath() const {return m_path;}
+
+private:
+    /**
+     * @brief 内部epoll fd可读时的回调：取走触发事件，处理后重新注册READ事件
+     */
+    void onReadable();
+
+    /**
+     * @brief 恢复定时器回调：压力解除，恢复缓存上限
+     * @param generation 定时器的代数，不是最新的定时器时忽略
+     */
+    void onRecover(uint64_t generation);
+
+    /**
+     * @brief 恢复进入压力状态前的缓存上限（需持有m_mutex）
+     */
+    void restoreLimits();
+
+private:
+    int m_psiFd;                                 // PSI文件描述符
+    int m_epfd;                                  // 内部epoll文件描述符
+    std::string m_path;                          // PSI文件路径
+    IOManager* m_iom;                            // IO管理器
+    MemoryPressureConfig m_config;               // 配置
+    std::mutex m_mutex;                          // 保护以下状态
+    bool m_stopping = false;                     // 是否正在停止
+    std::shared_ptr<Timer> m_recoverTimer;       // 压力解除定时器
+    uint64_t m_recoverGeneration = 0;            // 压力解除定时器的代数
+    size_t m_savedStackCache = 0;                // 进入压力前的协程栈缓存上限
+    size_t m_savedBufferCache = 0;               // 进入压力前的缓冲池上限
+    std::atomic<bool> m_underPressure{false};    // 是否处于压力状态
+    std::atomic<uint64_t> m_triggers{0};         // 触发次数
+    std::atomic<uint64_t> m_pressures{0};        // 进入压力状态的次数
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_MEMORY_PRESSURE_H_
@@ -0,0 +1,306 @@
+#ifndef __MYCOROUTINE_METRICS_H_
+#define __MYCOROUTINE_METRICS_H_
+
+/**
+ * @file metrics.h
+ * @brief 共享内存指标导出头文件
+ * @details 运行时计数器写入/dev/shm下mmap的文件：文件头记录版本和布局，之后是全局量和每个调度线程一个槽位。
+ *          每个槽位只由所属线程写入，用seqlock保护，其他进程不需要服务端配合即可读到一致的快照；
+ *          写入只是对本线程独占缓存行的几次普通存储，导出指标不占用调度时间
+ */
+
+#include <atomic>     // 原子计数器
+#include <cstdint>    // 定长整数
+#include <memory>     // 智能指针
+#include <string>     // 路径
+#include <vector>     // 快照
+
+namespace mycoroutine {
+
+static const uint64_t METRICS_MAGIC = 0x5254454d4f43594dULL;  // "MYCOMETR"
+static const uint32_t METRICS_VERSION = 2;                    // 布局变化时递增
+
+/**
+ * @brief 单个调度线程的计数器槽位
+ * @details 所属线程是唯一的写者：beginWrite()把序号加为奇数，更新字段，endWrite()再加为偶数。
+ *          读者在序号为奇数或前后不一致时重读。忙碌时间由读者计算：
+ *          (当前时间 - start_ns) - idle_ns - (idle_since_ns ? 当前时间 - idle_since_ns : 0)，
+ *          因此只在进出空闲时读取时钟，执行任务时不读取
+ */
+struct alignas(64) MetricsThreadSlot
+{
+    std::atomic<uint64_t> seq{0};            // seqlock序号，奇数表示正在写入
+    std::atomic<int64_t> thread_id{0};       // 线程ID，0表示未使用
+    std::atomic<uint64_t> tasks{0};          // 执行的任务数
+    std::atomic<uint64_t> switches{0};       // 调度循环切入协程的次数（任务协程和空闲协程）
+    std::atomic<uint64_t> epoll_waits{0};    // epoll_wait返回次数
+    std::atomic<uint64_t> epoll_events{0};   // epoll_wait返回的事件总数
+    std::atomic<uint64_t> timers_fired{0};   // 触发的定时器数
+    std::atomic<uint64_t> start_ns{0};       // 槽位启用时间（CLOCK_MONOTONIC）
+    std::atomic<uint64_t> idle_ns{0};        // 已结束的空闲时间总和
+    std::atomic<uint64_t> idle_since_ns{0};  // 当前空闲开始时间，0表示正在忙碌
+
+    /**
+     * @brief 开始写入，序号变为奇数
+     */
+    void beginWrite()
+    {
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /**
+     * @brief 结束写入，序号变为偶数
+     */
+    void endWrite()
+    {
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief 单写者自增（不需要原子读改写指令）
+     */
+    static void add(std::atomic<uint64_t>& counter, uint64_t n)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 记录执行了一个任务
+     */
+    void onTask()
+    {
+        beginWrite();
+        add(tasks, 1);
+        add(switches, 1);
+        endWrite();
+    }
+
+    /**
+     * @brief 记录进入空闲协程
+     * @param now_ns 当前时间（CLOCK_MONOTONIC）
+     */
+    void onIdleBegin(uint64_t now_ns)
+    {
+        beginWrite();
+        add(switches, 1);
+        idle_since_ns.store(now_ns, std::memory_order_relaxed);
+        endWrite();
+    }
+
+    /**
+     * @brief 记录离开空闲协程
+     * @param now_ns 当前时间（CLOCK_MONOTONIC）
+     */
+    void onIdleEnd(uint64_t now_ns)
+    {
+        uint64_t since = idle_since_ns.load(std::memory_order_relaxed);
+        beginWrite();
+        add(idle_ns, since && now_ns > since ? now_ns - since : 0);
+        idle_since_ns.store(0, std::memory_order_relaxed);
+        endWrite();
+    }
+
+    /**
+     * @brief 记录一次epoll_wait返回
+     * @param events 返回的事件数
+     * @param timers 本次触发的定时器数
+     */
+    void onPoll(uint64_t events, uint64_t timers)
+    {
+        beginWrite();
+        add(epoll_waits, 1);
+        add(epoll_events, events);
+        add(timers_fired, timers);
+        endWrite();
+    }
+};
+
+/**
+ * @brief 共享内存文件头和全局量
+ * @details 全局量是互相独立的瞬时值，各自用relaxed原子存储更新，不需要seqlock
+ */
+struct alignas(64) MetricsHeader
+{
+    uint64_t magic;                          // METRICS_MAGIC
+    uint32_t version;                        // METRICS_VERSION
+    uint32_t header_size;                    // sizeof(MetricsHeader)
+    uint32_t slot_size;                      // sizeof(MetricsThreadSlot)
+    uint32_t slot_count;                     // 槽位数量
+    int64_t pid;                             // 写入进程
+    uint64_t start_ns;                       // 创建时间（CLOCK_MONOTONIC）
+    char name[64];                           // 调度器名称
+    std::atomic<uint32_t> next_slot;         // 下一个可分配的槽位
+
+    alignas(64) std::atomic<uint64_t> queued_tasks;    // 最近一次取任务后队列中剩余的任务数
+    std::atomic<uint64_t> active_threads;    // 正在执行任务的线程数
+    std::atomic<uint64_t> idle_threads;      // 处于空闲协程中的线程数
+    std::atomic<uint64_t> pending_events;    // 已注册等待的IO事件数
+    std::atomic<uint64_t> fd_contexts;       // FdManager中存活的文件描述符上下文数
+    std::atomic<uint64_t> fd_table_size;     // IOManager的fd事件上下文表大小
+};
+
+/**
+ * @brief 指标共享内存区域（写入端）
+ * @details 文件为<dir>/mycoroutine.<name>.<pid>，析构时删除；调度线程通过acquireSlot()领取槽位，
+ *          再用SetThreadSlot()登记为线程局部槽位，运行时各处通过GetThreadSlot()更新
+ */
+class MetricsRegion
+{
+public:
+    /**
+     * @brief 创建共享内存文件并映射
+     * @param name 调度器名称（写入文件头和文件名）
+     * @param slots 槽位数量（最多记录的线程数）
+     * @param dir 文件所在目录
+     * @return 失败返回nullptr（errno指示原因）
+     */
+    static std::unique_ptr<MetricsRegion> Create(const std::string& name, size_t slots = 64,
+                                                 const std::string& dir = "/dev/shm");
+
+    /**
+     * @brief 析构函数，解除映射并删除文件
+     */
+    ~MetricsRegion();
+
+    MetricsRegion(const MetricsRegion&) = delete;
+    MetricsRegion& operator=(const MetricsRegion&) = delete;
+
+    /**
+     * @brief 获取文件路径
+     */
+    const std::string& getPath() const {return m_path;}
+
+    /**
+     * @brief 获取文件头
+     */
+    MetricsHeader* getHeader() const {return m_header;}
+
+    /**
+     * @brief 领取一个槽位
+     * @param thread_id 线程ID
+     * @return 槽位已用完时返回nullptr
+     */
+    MetricsThreadSlot* acquireSlot(int thread_id);
+
+    /**
+     * @brief 获取当前线程的槽位，未导出指标时为nullptr
+     */
+    static MetricsThreadSlot* GetThreadSlot();
+
+    /**
+     * @brief 设置当前线程的槽位
+     */
+    static void SetThreadSlot(MetricsThreadSlot* slot);
+
+private:
+    MetricsRegion() = default;
+
+private:
+    std::string m_path;                  // 文件路径
+    void* m_addr = nullptr;              // 映射地址
+    size_t m_size = 0;                   // 映射长度
+    MetricsHeader* m_header = nullptr;   // 文件头
+    MetricsThreadSlot* m_slots = nullptr;// 槽位数组
+};
+
+/**
+ * @brief 单个线程的计数器快照
+ */
+struct MetricsThreadSnapshot
+{
+    int thread_id = 0;
+    uint64_t tasks = 0;
+    uint64_t switches = 0;
+    uint64_t epoll_waits = 0;
+    uint64_t epoll_events = 0;
+    uint64_t timers_fired = 0;
+    uint64_t busy_ns = 0;        // 启用以来的忙碌时间
+    uint64_t idle_ns = 0;        // 启用以来的空闲时间（含正在进行的空闲）
+    bool idle = false;           // 读取时是否处于空闲
+};
+
+/**
+ * @brief 整个区域的快照
+ */
+struct MetricsSnapshot
+{
+    uint64_t time_ns = 0;        // 读取时间（CLOCK_MONOTONIC）
+    uint64_t queued_tasks = 0;
+    uint64_t active_threads = 0;
+    uint64_t idle_threads = 0;
+    uint64_t pending_events = 0;
+    uint64_t fd_contexts = 0;
+    uint64_t fd_table_size = 0;
+    std::vector<MetricsThreadSnapshot> threads;
+};
+
+/**
+ * @brief 指标读取端（在其他进程中使用）
+ * @details 只读映射文件，不需要写入进程配合；版本或布局不匹配时拒绝打开
+ */
+class MetricsReader
+{
+public:
+    /**
+     * @brief 打开指标文件
+     * @param path 文件路径
+     * @param error 失败时输出原因，可为nullptr
+     * @return 失败返回nullptr
+     */
+    static std::unique_ptr<MetricsReader> Open(const std::string& path, std::string* error = nullptr);
+
+    /**
+     * @brief 列出目录中的指标文件
+     * @param dir 目录
+     * @return 文件路径，按文件名排序
+     */
+    static std::vector<std::string> List(const std::string& dir = "/dev/shm");
+
+    /**
+     * @brief 析构函数，解除映射
+     */
+    ~MetricsReader();
+
+    MetricsReader(const MetricsReader&) = delete;
+    MetricsReader& operator=(const MetricsReader&) = delete;
+
+    /**
+     * @brief 读取一致快照
+     * @param snapshot 输出参数
+     */
+    void read(MetricsSnapshot& snapshot) const;
+
+    /**
+     * @brief 写入进程是否仍然存在
+     */
+    bool isAlive() const;
+
+    /**
+     * @brief 获取写入进程ID
+     */
+    int getPid() const {return (int)m_header->pid;}
+
+    /**
+     * @brief 获取调度器名称
+     */
+    std::string getName() const;
+
+private:
+    MetricsReader() = default;
+
+private:
+    void* m_addr = nullptr;                        // 映射地址
+    size_t m_size = 0;                             // 映射长度
+    const MetricsHeader* m_header = nullptr;       // 文件头
+    const MetricsThreadSlot* m_slots = nullptr;    // 槽位数组
+};
+
+/**
+ * @brief 获取CLOCK_MONOTONIC时间（纳秒），各进程之间可比较
+ */
+uint64_t metrics_now_ns();
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_METRICS_H_
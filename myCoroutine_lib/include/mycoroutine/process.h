@@ -0,0 +1,167 @@
+#ifndef __MYCOROUTINE_PROCESS_H_
+#define __MYCOROUTINE_PROCESS_H_
+
+/**
+ * @file process.h
+ * @brief 协程化子进程管理头文件
+ * @details 通过posix_spawn创建子进程，用pidfd在IOManager中等待进程退出，
+ *          标准输入/输出/错误重定向到非阻塞管道，读写时只挂起当前协程，不阻塞工作线程
+ */
+
+#include <mycoroutine/iomanager.h>  // IO管理器
+
+#include <sys/types.h>  // pid_t
+#include <string>       // 参数与输出
+#include <vector>       // 参数列表
+#include <memory>       // 智能指针
+
+namespace mycoroutine {
+
+/**
+ * @brief 子进程启动参数
+ */
+struct ProcessOptions
+{
+    std::vector<std::string> env;   // 环境变量（"KEY=VALUE"），为空时继承当前进程
+    std::string cwd;                // 工作目录，为空时继承当前进程
+    bool pipe_stdin = true;         // 标准输入是否重定向到管道，否则继承
+    bool pipe_stdout = true;        // 标准输出是否重定向到管道，否则继承
+    bool pipe_stderr = false;       // 标准错误是否重定向到管道，否则继承
+};
+
+/**
+ * @brief 子进程
+ * @details 进程退出通过pidfd（Linux 5.3+）注册到IOManager等待；内核不支持pidfd时退化为定时轮询waitpid(WNOHANG)。
+ *          子进程的信号屏蔽字被清空、SIGPIPE恢复为默认处理，不继承服务进程对它们的设置
+ * @note 读写和wait()需要在IOManager调度的协程中调用，否则需要等待时返回-1、errno为EAGAIN；向已退出进程的标准输入写入会产生SIGPIPE，
+ *       调用者应当忽略SIGPIPE（服务进程通常已经这样做）
+ */
+class Process
+{
+public:
+    /**
+     * @brief 管道类型
+     */
+    enum Stream
+    {
+        STDOUT = 1,  // 标准输出
+        STDERR = 2   // 标准错误
+    };
+
+    /**
+     * @brief 创建子进程
+     * @param argv 命令及参数，argv[0]按PATH查找
+     * @param options 启动参数
+     * @return 成功返回进程对象，失败返回nullptr（errno指示原因）
+     */
+    static std::shared_ptr<Process> Spawn(const std::vector<std::string>& argv,
+                                          const ProcessOptions& options = ProcessOptions());
+
+    /**
+     * @brief 构造函数（通过Spawn创建）
+     * @param pid 进程ID
+     * @param pidfd 进程文件描述符，-1表示不支持
+     * @param in 标准输入管道写端，-1表示未重定向
+     * @param out 标准输出管道读端，-1表示未重定向
+     * @param err 标准错误管道读端，-1表示未重定向
+     */
+    Process(pid_t pid, int pidfd, int in, int out, int err);
+
+    /**
+     * @brief 析构函数，关闭管道和pidfd
+     * @note 以WNOHANG回收已经退出的子进程，但不会等待仍在运行的子进程：
+     *       它之后退出会成为僵尸进程，需要在析构前调用wait()（或kill()后wait()）
+     */
+    ~Process();
+
+    /**
+     * @brief 向标准输入写入全部数据
+     * @param data 数据
+     * @param len 数据长度
+     * @return 成功返回len，失败返回-1（例如EPIPE：子进程已关闭标准输入）
+     */
+    ssize_t write(const void* data, size_t len);
+
+    /**
+     * @brief 关闭标准输入，子进程随后读到EOF
+     */
+    void closeStdin();
+
+    /**
+     * @brief 从标准输出或标准错误读取数据
+     * @param stream STDOUT或STDERR
+     * @param buf 缓冲区
+     * @param len 缓冲区大小
+     * @param timeout_ms 超时时间（毫秒），(uint64_t)-1表示永不超时
+     * @return 读取的字节数，0表示EOF，-1表示出错或超时（errno为ETIMEDOUT）
+     */
+    ssize_t read(Stream stream, void* buf, size_t len, uint64_t timeout_ms = (uint64_t)-1);
+
+    /**
+     * @brief 读取直到EOF
+     * @param stream STDOUT或STDERR
+     * @param out 输出参数，追加读到的数据
+     * @return 读到EOF返回true，出错返回false
+     */
+    bool readAll(Stream stream, std::string& out);
+
+    /**
+     * @brief 等待子进程退出并回收
+     * @param timeout_ms 超时时间（毫秒），(uint64_t)-1表示永不超时
+     * @return 正常退出返回退出码；被信号终止返回128+信号值；超时或出错返回-1（超时时errno为ETIMEDOUT）
+     */
+    int wait(uint64_t timeout_ms = (uint64_t)-1);
+
+    /**
+     * @brief 写入输入、同时读取标准输出和标准错误直到EOF，然后等待退出
+     * @param input 写入标准输入的数据，写完后关闭标准输入
+     * @param out 输出参数，标准输出（未重定向时不变）
+     * @param err 输出参数，标准错误（未重定向时不变）
+     * @return 同wait()
+     * @details 标准输入和标准错误在单独的协程中处理，避免子进程因某个管道写满而互相等待
+     */
+    int communicate(const std::string& input, std::string& out, std::string& err);
+
+    /**
+     * @brief 向子进程发送信号
+     * @param sig 信号
+     * @return 成功返回true；子进程已被回收或发送失败返回false
+     * @details 有pidfd时使用pidfd_send_signal，不会误发给复用了同一PID的其他进程
+     */
+    bool kill(int sig);
+
+    /**
+     * @brief 获取进程ID
+     */
+    pid_t getPid() const {return m_pid;}
+
+    /**
+     * @brief 是否已被回收
+     */
+    bool hasExited() const {return m_exited;}
+
+    /**
+     * @brief 获取waitpid得到的原始状态，未回收时返回-1
+     */
+    int getStatus() const {return m_status;}
+
+private:
+    /**
+     * @brief 非阻塞回收子进程
+     * @return 已回收返回1，仍在运行返回0，出错返回-1
+     */
+    int reap();
+
+private:
+    pid_t m_pid;              // 进程ID
+    int m_pidfd;              // 进程文件描述符，-1表示不支持
+    int m_stdin;              // 标准输入管道写端
+    int m_stdout;             // 标准输出管道读端
+    int m_stderr;             // 标准错误管道读端
+    bool m_exited = false;    // 是否已被回收
+    int m_status = -1;        // waitpid得到的原始状态
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_PROCESS_H_
@@ -10,9 +10,29 @@
 #include <mutex>      // 互斥锁头文件
 #include <vector>     // 向量容器头文件
 #include <string>     // 字符串头文件
+#include <memory>     // 指标区域
+#include <atomic>     // 指标区域指针
 
 namespace mycoroutine {  // mycoroutine命名空间
 
+class MetricsRegion;
+class IOManager;
+
+/**
+ * @brief 启动预热配置
+ * @details 默认全部关闭。开启后在start()返回前完成fd表预分配、协程栈触页和回调协程池填充，
+ *          避免第一波流量撞上写锁下的表扩容和大量缺页中断
+ */
+struct WarmupConfig
+{
+    bool fd_table_from_rlimit = false;   // 按RLIMIT_NOFILE预分配IOManager和FdManager的fd表
+    size_t max_fd_table_size = 1 << 20;  // fd表预分配上限
+    size_t fiber_stacks = 0;             // 每个线程预先触页并缓存的协程栈数量
+    size_t pooled_fibers = 0;            // 每个工作线程预先创建并复用的回调协程数量
+    size_t read_buffers = 0;             // 每个线程预先触页的读缓冲区数量（BufferPool）
+    bool hook_enable = false;            // 调度线程启用系统调用钩子（任务中阻塞的套接字IO和sleep变为协程切换）
+};
+
 /**
  * @brief 协程调度器类
  * 负责管理线程池和协程任务调度
@@ -39,6 +59,37 @@ public:
      */
     const std::string& getName() const {return m_name;}
 
+    /**
+     * @brief 获取线程池中工作线程的ID
+     * @return 工作线程ID列表，start()之前为空
+     * @details 不包含调用者线程：调用者线程只在stop()时才参与调度，
+     *          指定到该线程的任务在此之前不会被执行
+     */
+    std::vector<int> getWorkerThreadIds();
+
+    /**
+     * @brief 把运行时计数器导出到共享内存文件，供其他进程读取（见metrics.h）
+     * @param slots 最多记录的线程数
+     * @param dir 文件所在目录
+     * @return 文件路径（<dir>/mycoroutine.<name>.<pid>），失败返回空字符串；重复调用返回已有的路径
+     * @details 每个调度线程在下一次回到调度循环时领取槽位，此后每个任务只多几次对本线程缓存行的普通存储；
+     *          文件在调度器析构时删除
+     */
+    std::string exportMetrics(size_t slots = 64, const std::string& dir = "/dev/shm");
+
+    /**
+     * @brief 释放各调度线程缓存的内存
+     * @details 给每个工作线程投递一个任务，清空其回调协程池、协程栈缓存和缓冲池，
+     *          最后一个完成的线程调用malloc_trim()把空闲堆内存还给内核；异步执行，立即返回
+     */
+    virtual void trimCaches();
+
+    /**
+     * @brief 暂停或恢复回调协程池的填充
+     * @param paused 为true时执行完的回调协程直接释放，不再放回池中
+     */
+    void setCachePaused(bool paused) {m_cachePaused.store(paused, std::memory_order_relaxed);}
+
 public:    
     /**
      * @brief 获取正在运行的调度器
@@ -52,6 +103,20 @@ protected:
      * 将当前调度器实例设置为线程局部存储的调度器
      */
     void SetThis();
+
+    /**
+     * @brief 获取当前线程的IO管理器
+     * @return 当前线程的调度器是IOManager时返回它，否则返回nullptr
+     * @details 由SetThis()随调度器一起写入线程局部变量，hook的每次IO调用都会用到，避免dynamic_cast
+     */
+    static IOManager* GetThisIOManager();
+
+    /**
+     * @brief 登记派生的IO管理器（IOManager构造时调用）
+     * @param iom IO管理器，即this
+     * @details 之后SetThis()同时缓存IO管理器指针；当前线程已经设置为本调度器时立即刷新缓存
+     */
+    void setIOManager(IOManager* iom);
     
 public:    
     /**
@@ -122,6 +187,23 @@ protected:
      */
     virtual bool stopping();
 
+    /**
+     * @brief 获取指标区域，未导出时为nullptr
+     */
+    MetricsRegion* getMetricsRegion() const {return m_metrics.load(std::memory_order_acquire);}
+
+    /**
+     * @brief 设置启动预热配置，需在start()之前调用
+     * @param warmup 预热配置
+     */
+    void setWarmup(const WarmupConfig& warmup);
+
+    /**
+     * @brief 预热当前线程的线程局部结构
+     * @param worker 是否是线程池中的工作线程（只有工作线程填充回调协程池）
+     */
+    void warmupThread(bool worker);
+
     /**
      * @brief 检查是否有空闲线程
      * @return 是否有空闲线程
@@ -218,6 +300,12 @@ private:
     std::shared_ptr<Fiber> m_schedulerFiber;  // 调度协程（仅当m_useCaller为true时有效）
     int m_rootThread = -1;               // 主线程ID（仅当m_useCaller为true时有效）
     bool m_stopping = false;             // 是否正在关闭调度器
+    WarmupConfig m_warmup;               // 启动预热配置
+    Semaphore m_warmupSem;               // 工作线程预热完成信号
+    std::unique_ptr<MetricsRegion> m_metricsOwner;   // 指标区域（m_mutex保护创建）
+    std::atomic<MetricsRegion*> m_metrics{nullptr};  // 调度线程无锁读取的指标区域
+    std::atomic<bool> m_cachePaused{false};          // 是否暂停填充回调协程池
+    IOManager* m_ioManager = nullptr;                // 本调度器是IOManager时指向自身
 };
 
 } // end namespace mycoroutine
@@ -0,0 +1,140 @@
+#ifndef __MYCOROUTINE_SCHEDULER_PROBE_H_
+#define __MYCOROUTINE_SCHEDULER_PROBE_H_
+
+/**
+ * @file scheduler_probe.h
+ * @brief 调度延迟探针头文件
+ * @details 周期性地向每个工作线程投递一个空任务（金丝雀），测量从入队到开始执行的延迟；
+ *          同时汇总定时器的延迟触发数据。调度器接近饱和时这两个指标会先于业务延迟上升
+ */
+
+#include <mycoroutine/iomanager.h>   // IO管理器
+#include <mycoroutine/histogram.h>   // 滚动直方图
+
+#include <memory>     // 智能指针
+#include <vector>     // 线程列表
+#include <atomic>     // 原子标志
+#include <mutex>      // 互斥锁
+
+namespace mycoroutine {
+
+/**
+ * @brief 延迟统计摘要（单位微秒）
+ */
+struct LatencySummary
+{
+    uint64_t count = 0;   // 样本数
+    double mean = 0;      // 平均值
+    uint64_t p50 = 0;     // P50
+    uint64_t p90 = 0;     // P90
+    uint64_t p99 = 0;     // P99
+    uint64_t p999 = 0;    // P99.9
+    uint64_t max = 0;     // 最大值
+
+    /**
+     * @brief 从直方图生成摘要
+     * @param hist 直方图
+     */
+    static LatencySummary FromHistogram(const Histogram& hist);
+};
+
+/**
+ * @brief 调度延迟探针
+ * @details 每隔interval_ms向每个工作线程投递一个指定线程的回调任务，
+ *          任务执行时记录(执行时间 - 入队时间)；上一个探测任务还没执行时不重复投递，
+ *          避免在已经饱和的线程上继续堆积任务。结果保存在滚动直方图中，只反映最近一个窗口
+ * @note 必须通过std::make_shared创建，并在IOManager::start()之后调用start()；
+ *       探针运行期间其定时器会阻止IOManager停止，停止IOManager前应先调用stop()或销毁探针
+ */
+class SchedulerProbe : public std::enable_shared_from_this<SchedulerProbe>
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param iom 被探测的IO管理器，默认为当前线程的IO管理器
+     * @param interval_ms 探测间隔（毫秒）
+     * @param slots 滚动窗口的时间片数量
+     * @param slot_ms 每个时间片的长度（毫秒）
+     */
+    SchedulerProbe(IOManager* iom = IOManager::GetThis(), uint64_t interval_ms = 100,
+                   size_t slots = 6, uint64_t slot_ms = 10000);
+
+    /**
+     * @brief 析构函数，取消探测定时器
+     */
+    ~SchedulerProbe();
+
+    /**
+     * @brief 开始探测
+     * @details 按当前的工作线程列表创建每线程直方图，并注册循环定时器
+     */
+    void start();
+
+    /**
+     * @brief 停止探测，已投递的探测任务仍会执行并记录
+     */
+    void stop();
+
+    /**
+     * @brief 获取被探测的工作线程ID
+     */
+    std::vector<int> getThreadIds() const;
+
+    /**
+     * @brief 获取调度延迟
+     * @param thread 工作线程ID，-1表示所有线程汇总
+     * @return 最近一个窗口内的延迟摘要，线程不存在时返回空摘要
+     */
+    LatencySummary getScheduleDelay(int thread = -1) const;
+
+    /**
+     * @brief 获取定时器延迟触发统计
+     * @return 最近一个窗口内IOManager所有定时器的延迟摘要
+     */
+    LatencySummary getTimerLateness() const;
+
+    /**
+     * @brief 获取尚未执行的探测任务数
+     * @details 持续不为0说明对应线程长时间没有回到调度循环
+     */
+    size_t getPendingCount() const;
+
+private:
+    /**
+     * @brief 单个工作线程的探测状态
+     */
+    struct ThreadProbe
+    {
+        ThreadProbe(int id, size_t slots, uint64_t slot_ms): thread(id), delay(slots, slot_ms) {}
+
+        int thread;                       // 工作线程ID
+        std::atomic<bool> pending{false}; // 是否有已投递但未执行的探测任务
+        RollingHistogram delay;           // 调度延迟（微秒）
+    };
+
+    /**
+     * @brief 定时器回调，向每个工作线程投递探测任务
+     */
+    void onTick();
+
+    /**
+     * @brief 探测任务，在目标线程上执行
+     * @param probe 目标线程的探测状态
+     * @param enqueue_us 入队时间（微秒）
+     */
+    void onCanary(ThreadProbe* probe, uint64_t enqueue_us);
+
+private:
+    IOManager* m_iom;                                  // 被探测的IO管理器
+    uint64_t m_interval;                               // 探测间隔（毫秒）
+    size_t m_slots;                                    // 滚动窗口的时间片数量
+    uint64_t m_slotMs;                                 // 时间片长度（毫秒）
+    mutable std::mutex m_mutex;                        // 保护m_timer
+    std::shared_ptr<Timer> m_timer;                    // 探测定时器
+    std::vector<std::unique_ptr<ThreadProbe>> m_threads; // 每线程探测状态，start()后不再变化
+    RollingHistogram m_all;                            // 所有线程汇总的调度延迟
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_SCHEDULER_PROBE_H_
@@ -0,0 +1,422 @@
+#ifndef __MYCOROUTINE_SHARDED_LRU_H_
+#define __MYCOROUTINE_SHARDED_LRU_H_
+
+/**
+ * @file sharded_lru.h
+ * @brief 分片LRU缓存头文件
+ * @details 进程内共享缓存按键的哈希分成多个分片，每个分片有独立的锁、LRU链表和容量，
+ *          不同分片上的访问互不争用；条目可以带TTL，过期条目在访问时惰性删除，
+ *          也可以由IOManager上的循环定时器定期清扫。未命中时getOrLoad()经SingleFlight合并加载：
+ *          同一个键上并发的未命中只有一个协程执行加载函数，其余协程挂起等待，不阻塞工作线程
+ */
+
+#include <mycoroutine/iomanager.h>      // 清扫定时器
+#include <mycoroutine/single_flight.h>  // 合并加载
+#include <mycoroutine/utils.h>          // steady_ms
+
+#include <list>           // LRU链表
+#include <unordered_map>  // 键索引
+#include <functional>     // 加载函数
+#include <memory>         // 智能指针
+#include <mutex>          // 分片锁
+#include <atomic>         // 加载计数
+
+namespace mycoroutine {
+
+/**
+ * @brief 分片LRU缓存统计
+ */
+struct ShardedLruStats
+{
+    size_t size = 0;            // 当前条目数（含尚未清除的过期条目）
+    uint64_t hits = 0;          // 命中次数
+    uint64_t misses = 0;        // 未命中次数（含过期）
+    uint64_t loads = 0;         // 加载函数执行次数
+    uint64_t evictions = 0;     // 因容量淘汰的条目数
+    uint64_t expirations = 0;   // 因过期删除的条目数
+};
+
+/**
+ * @brief 分片LRU缓存
+ * @tparam Key 键类型
+ * @tparam Value 值类型，get()返回拷贝；值较大时可以使用std::shared_ptr<const T>
+ * @tparam Hash 键的哈希函数
+ * @details 每个分片的容量为总容量除以分片数（向上取整），淘汰只在分片内进行，
+ *          键分布不均匀时整体命中率略低于同容量的全局LRU。分片锁只保护链表和哈希表操作，
+ *          加载函数和值的构造都在锁外执行
+ * @note getOrLoad()只能在调度器调度的协程中调用；get()/put()/erase()可以在任意线程调用
+ */
+template<class Key, class Value, class Hash = std::hash<Key>>
+class ShardedLru
+{
+public:
+    /**
+     * @brief 加载函数：为key填写value
+     * @return 成功返回true；返回false时结果不进入缓存，但同样交给等待同一次加载的协程
+     */
+    typedef std::function<bool(const Key& key, Value& value)> Loader;
+
+    /**
+     * @brief 构造函数
+     * @param capacity 总容量（条目数）
+     * @param shards 分片数，向上取整为2的幂；1时退化为一把锁保护的普通LRU
+     * @param default_ttl_ms put()/getOrLoad()未指定TTL时使用的过期时间（毫秒），(uint64_t)-1表示永不过期
+     */
+    explicit ShardedLru(size_t capacity, size_t shards = 16, uint64_t default_ttl_ms = (uint64_t)-1):
+        m_core(std::make_shared<Core>()), m_flight(shards), m_defaultTtl(default_ttl_ms)
+    {
+        m_core->shardCount = 1;
+        while(m_core->shardCount < shards)
+        {
+            m_core->shardCount <<= 1;
+        }
+        m_core->shards.reset(new Shard[m_core->shardCount]);
+        size_t per_shard = (capacity + m_core->shardCount - 1) / m_core->shardCount;
+        for(size_t i = 0; i < m_core->shardCount; ++i)
+        {
+            m_core->shards[i].capacity = per_shard ? per_shard : 1;
+        }
+    }
+
+    /**
+     * @brief 析构函数，停止清扫定时器
+     */
+    ~ShardedLru()
+    {
+        stopSweeper();
+    }
+
+    ShardedLru(const ShardedLru&) = delete;
+    ShardedLru& operator=(const ShardedLru&) = delete;
+
+    /**
+     * @brief 查找key
+     * @param key 键
+     * @param value 输出参数，命中时写入值的拷贝
+     * @return 命中且未过期返回true
+     */
+    bool get(const Key& key, Value& value)
+    {
+        Shard& shard = shardOf(key);
+        uint64_t now = steady_ms();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if(it == shard.index.end())
+        {
+            ++shard.misses;
+            return false;
+        }
+        if(it->second->expire <= now)
+        {
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+            ++shard.expirations;
+            ++shard.misses;
+            return false;
+        }
+        // 移到链表头部（最近使用）
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        value = it->second->value;
+        ++shard.hits;
+        return true;
+    }
+
+    /**
+     * @brief 插入或更新key
+     * @param key 键
+     * @param value 值
+     * @param ttl_ms 过期时间（毫秒），0表示使用默认TTL，(uint64_t)-1表示永不过期
+     */
+    void put(const Key& key, const Value& value, uint64_t ttl_ms = 0)
+    {
+        Shard& shard = shardOf(key);
+        uint64_t expire = expireAt(ttl_ms);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if(it != shard.index.end())
+        {
+            it->second->value = value;
+            it->second->expire = expire;
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return;
+        }
+
+        // 分片已满时复用链表尾部（最久未使用）的节点，避免一次释放和一次分配
+        if(shard.index.size() >= shard.capacity)
+        {
+            auto last = std::prev(shard.lru.end());
+            shard.index.erase(last->key);
+            last->key = key;
+            last->value = value;
+            last->expire = expire;
+            shard.lru.splice(shard.lru.begin(), shard.lru, last);
+            ++shard.evictions;
+        }
+        else
+        {
+            shard.lru.push_front(Entry{key, value, expire});
+        }
+        shard.index.emplace(key, shard.lru.begin());
+    }
+
+    /**
+     * @brief 查找key，未命中时加载并放入缓存
+     * @param key 键
+     * @param loader 加载函数，同一个键上并发的未命中只有一个协程执行
+     * @param value 输出参数，结果
+     * @param ttl_ms 加载结果的过期时间（毫秒），0表示使用默认TTL
+     * @param wait_ms 等待其他协程发起的加载的超时时间（毫秒），(uint64_t)-1表示永不超时
+     * @return 命中或加载成功返回true；加载函数返回false时返回false；等待超时返回false且errno为ETIMEDOUT
+     */
+    bool getOrLoad(const Key& key, const Loader& loader, Value& value, uint64_t ttl_ms = 0,
+                   uint64_t wait_ms = (uint64_t)-1)
+    {
+        if(get(key, value))
+        {
+            return true;
+        }
+
+        LoadResult result;
+        bool ok = m_flight.runFor(key, [&]()
+        {
+            // 上一次加载刚完成时，结果已在缓存中
+            LoadResult r;
+            if(get(key, r.value))
+            {
+                r.found = true;
+                return r;
+            }
+            shardOf(key).loads.fetch_add(1, std::memory_order_relaxed);
+            r.found = loader(key, r.value);
+            if(r.found)
+            {
+                put(key, r.value, ttl_ms);
+            }
+            return r;
+        }, wait_ms, result);
+        if(!ok || !result.found)
+        {
+            return false;
+        }
+        value = std::move(result.value);
+        return true;
+    }
+
+    /**
+     * @brief 删除key
+     * @param key 键
+     * @return 存在返回true
+     * @note 进行中的加载完成后仍会把结果放入缓存；需要丢弃时在加载函数中自行校验版本
+     */
+    bool erase(const Key& key)
+    {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if(it == shard.index.end())
+        {
+            return false;
+        }
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief 清空所有分片
+     */
+    void clear()
+    {
+        for(size_t i = 0; i < m_core->shardCount; ++i)
+        {
+            Shard& shard = m_core->shards[i];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.index.clear();
+            shard.lru.clear();
+        }
+    }
+
+    /**
+     * @brief 删除所有已过期的条目
+     * @return 删除的条目数
+     * @details 逐个分片加锁扫描，同一时刻只持有一个分片的锁
+     */
+    size_t sweep()
+    {
+        return m_core->sweep(steady_ms());
+    }
+
+    /**
+     * @brief 在IO管理器上启动循环定时器，定期调用sweep()
+     * @param interval_ms 清扫间隔（毫秒）
+     * @param iom 运行定时器的IO管理器
+     * @return 成功返回true；已在运行或iom为空返回false
+     * @details 没有清扫时过期条目只在被访问或被淘汰时删除，一直不再访问的条目会占用内存直到被LRU挤出
+     */
+    bool startSweeper(uint64_t interval_ms = 1000, IOManager* iom = IOManager::GetThis())
+    {
+        std::lock_guard<std::mutex> lock(m_sweeperMutex);
+        if(m_sweeper || !iom)
+        {
+            return false;
+        }
+        // 回调通过弱引用访问分片，缓存析构后已经出队的回调什么也不做
+        std::weak_ptr<Core> weak_core(m_core);
+        m_sweeper = iom->addConditionTimer(interval_ms, [weak_core]()
+        {
+            std::shared_ptr<Core> core = weak_core.lock();
+            if(core)
+            {
+                core->sweep(steady_ms());
+            }
+        }, weak_core, true);
+        return true;
+    }
+
+    /**
+     * @brief 停止清扫定时器
+     */
+    void stopSweeper()
+    {
+        std::lock_guard<std::mutex> lock(m_sweeperMutex);
+        if(m_sweeper)
+        {
+            m_sweeper->cancel();
+            m_sweeper.reset();
+        }
+    }
+
+    /**
+     * @brief 获取统计信息（各分片之和）
+     */
+    ShardedLruStats getStats()
+    {
+        ShardedLruStats stats;
+        for(size_t i = 0; i < m_core->shardCount; ++i)
+        {
+            Shard& shard = m_core->shards[i];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.size += shard.index.size();
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.loads += shard.loads.load(std::memory_order_relaxed);
+            stats.evictions += shard.evictions;
+            stats.expirations += shard.expirations;
+        }
+        return stats;
+    }
+
+    /**
+     * @brief 获取分片数
+     */
+    size_t getShardCount() const {return m_core->shardCount;}
+
+private:
+    /**
+     * @brief 缓存条目
+     */
+    struct Entry
+    {
+        Key key;            // 键（淘汰时据此从索引中删除）
+        Value value;        // 值
+        uint64_t expire;    // 过期时间（单调时钟毫秒），(uint64_t)-1表示永不过期
+    };
+
+    /**
+     * @brief 分片，按缓存行对齐，相邻分片的锁不共享缓存行
+     */
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;                                   // 保护以下除loads外的所有成员
+        std::list<Entry> lru;                               // 头部最近使用
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;  // 键索引
+        size_t capacity = 1;                                // 分片容量
+        uint64_t hits = 0;                                  // 命中次数
+        uint64_t misses = 0;                                // 未命中次数
+        uint64_t evictions = 0;                             // 淘汰次数
+        uint64_t expirations = 0;                           // 过期删除次数
+        std::atomic<uint64_t> loads{0};                     // 加载次数（在锁外累加）
+    };
+
+    /**
+     * @brief 分片集合，由缓存和清扫定时器回调共享
+     */
+    struct Core
+    {
+        std::unique_ptr<Shard[]> shards;    // 分片
+        size_t shardCount = 1;              // 分片数（2的幂）
+
+        /**
+         * @brief 删除所有在now之前过期的条目
+         */
+        size_t sweep(uint64_t now)
+        {
+            size_t removed = 0;
+            for(size_t i = 0; i < shardCount; ++i)
+            {
+                Shard& shard = shards[i];
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                for(auto it = shard.lru.begin(); it != shard.lru.end();)
+                {
+                    if(it->expire <= now)
+                    {
+                        shard.index.erase(it->key);
+                        it = shard.lru.erase(it);
+                        ++shard.expirations;
+                        ++removed;
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+            return removed;
+        }
+    };
+
+    /**
+     * @brief 一次加载的结果，经SingleFlight交给所有等待者
+     */
+    struct LoadResult
+    {
+        bool found = false;     // 加载函数是否成功
+        Value value{};          // 加载结果
+    };
+
+    /**
+     * @brief 获取key所在的分片
+     */
+    Shard& shardOf(const Key& key)
+    {
+        // 与SingleFlight相同，哈希值的高位参与分片选择，避免与unordered_map使用的低位相关
+        size_t h = m_hash(key);
+        h ^= h >> 16;
+        return m_core->shards[h & (m_core->shardCount - 1)];
+    }
+
+    /**
+     * @brief 计算过期时间
+     * @param ttl_ms TTL，0表示使用默认TTL
+     */
+    uint64_t expireAt(uint64_t ttl_ms) const
+    {
+        if(ttl_ms == 0)
+        {
+            ttl_ms = m_defaultTtl;
+        }
+        return ttl_ms == (uint64_t)-1 ? (uint64_t)-1 : steady_ms() + ttl_ms;
+    }
+
+private:
+    std::shared_ptr<Core> m_core;                       // 分片集合
+    SingleFlight<Key, LoadResult, Hash> m_flight;       // 合并同一个键上并发的加载
+    uint64_t m_defaultTtl;                              // 默认TTL（毫秒）
+    Hash m_hash;                                        // 哈希函数
+    std::mutex m_sweeperMutex;                          // 保护m_sweeper
+    std::shared_ptr<Timer> m_sweeper;                   // 清扫定时器
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_SHARDED_LRU_H_
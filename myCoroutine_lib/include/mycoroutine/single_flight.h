@@ -0,0 +1,235 @@
+#ifndef __MYCOROUTINE_SINGLE_FLIGHT_H_
+#define __MYCOROUTINE_SINGLE_FLIGHT_H_
+
+/**
+ * @file single_flight.h
+ * @brief 请求合并（singleflight）头文件
+ * @details 同一个键上并发的多个请求只有第一个协程真正执行后端调用，其余协程挂起在该调用上，
+ *          调用完成后共享同一个结果。用于热点键过期时避免成千上万个协程同时回源
+ */
+
+#include <mycoroutine/fiber_sync.h>  // 协程条件变量
+#include <mycoroutine/utils.h>       // steady_ms
+
+#include <unordered_map>  // 进行中的调用
+#include <functional>     // 后端调用
+#include <memory>         // 智能指针
+#include <mutex>          // 互斥锁
+#include <exception>      // 后端调用抛出的异常
+#include <errno.h>        // ETIMEDOUT
+
+namespace mycoroutine {
+
+/**
+ * @brief 请求合并
+ * @tparam Key 键类型
+ * @tparam Value 结果类型，每个等待者得到一份拷贝；结果较大时可以使用std::shared_ptr<const T>
+ * @tparam Hash 键的哈希函数
+ * @details 进行中的调用保存在分片哈希表中，分片锁只在查找/插入/删除时短暂持有；
+ *          每个调用有独立的锁和协程条件变量，唤醒等待者不会争用分片锁
+ * @note run()/runFor()只能在调度器调度的协程中调用，runFor()的超时依赖当前线程的IOManager定时器
+ */
+template<class Key, class Value, class Hash = std::hash<Key>>
+class SingleFlight
+{
+public:
+    typedef std::function<Value()> Func;
+
+    /**
+     * @brief 构造函数
+     * @param shards 分片数，向上取整为2的幂
+     */
+    explicit SingleFlight(size_t shards = 16)
+    {
+        m_shardCount = 1;
+        while(m_shardCount < shards)
+        {
+            m_shardCount <<= 1;
+        }
+        m_shards.reset(new Shard[m_shardCount]);
+    }
+
+    SingleFlight(const SingleFlight&) = delete;
+    SingleFlight& operator=(const SingleFlight&) = delete;
+
+    /**
+     * @brief 执行或加入key上的调用
+     * @param key 键
+     * @param fn 后端调用，只由第一个到达的协程执行
+     * @param shared 输出参数，结果是否来自其他协程发起的调用，可以为空
+     * @return 调用结果
+     */
+    Value run(const Key& key, const Func& fn, bool* shared = nullptr)
+    {
+        Value value;
+        runFor(key, fn, (uint64_t)-1, value, shared);
+        return value;
+    }
+
+    /**
+     * @brief 带截止时间执行或加入key上的调用
+     * @param key 键
+     * @param fn 后端调用，只由第一个到达的协程执行
+     * @param timeout_ms 等待其他协程发起的调用的超时时间（毫秒），(uint64_t)-1表示永不超时
+     * @param value 输出参数，调用结果
+     * @param shared 输出参数，结果是否来自其他协程发起的调用，可以为空
+     * @return 得到结果返回true；超时返回false（errno为ETIMEDOUT），进行中的调用不受影响，仍会交给其他等待者
+     * @details 超时只作用于等待者：第一个到达的协程同步执行fn，截止时间应由fn自身的后端超时保证。
+     *          fn抛出异常时调用同样结束并从表中摘除，异常在发起者和每个等待者中重新抛出
+     */
+    bool runFor(const Key& key, const Func& fn, uint64_t timeout_ms, Value& value, bool* shared = nullptr)
+    {
+        Shard& shard = shardOf(key);
+        std::shared_ptr<Call> call;
+        bool leader = false;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.calls.find(key);
+            if(it != shard.calls.end())
+            {
+                call = it->second;
+            }
+            else
+            {
+                call = std::make_shared<Call>();
+                shard.calls.emplace(key, call);
+                leader = true;
+            }
+        }
+        if(shared)
+        {
+            *shared = !leader;
+        }
+
+        if(leader)
+        {
+            // fn抛出异常时也要完成调用，否则等待者和之后加入的请求永远挂起
+            std::exception_ptr error;
+            try
+            {
+                value = fn();
+            }
+            catch(...)
+            {
+                error = std::current_exception();
+            }
+            // 先从表中摘除再发布结果：此后到达的请求发起新的调用，得到更新的数据
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto it = shard.calls.find(key);
+                if(it != shard.calls.end() && it->second == call)
+                {
+                    shard.calls.erase(it);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(call->mutex);
+                if(error)
+                {
+                    call->error = error;
+                }
+                else
+                {
+                    call->value = value;
+                }
+                call->done = true;
+                call->cond.notifyAll();
+            }
+            if(error)
+            {
+                std::rethrow_exception(error);
+            }
+            return true;
+        }
+
+        uint64_t deadline = timeout_ms == (uint64_t)-1 ? (uint64_t)-1 : steady_ms() + timeout_ms;
+        std::unique_lock<std::mutex> lock(call->mutex);
+        while(!call->done)
+        {
+            uint64_t now = steady_ms();
+            if(now >= deadline)
+            {
+                errno = ETIMEDOUT;
+                return false;
+            }
+            call->cond.waitFor(lock, deadline == (uint64_t)-1 ? (uint64_t)-1 : deadline - now);
+        }
+        if(call->error)
+        {
+            std::exception_ptr error = call->error;
+            lock.unlock();
+            std::rethrow_exception(error);
+        }
+        value = call->value;
+        return true;
+    }
+
+    /**
+     * @brief 忘记key上进行中的调用
+     * @param key 键
+     * @details 之后到达的请求发起新的调用；已经在等待的协程仍然得到原调用的结果。
+     *          用于已知后端数据已变化、进行中的调用结果已过期的场景
+     */
+    void forget(const Key& key)
+    {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.calls.erase(key);
+    }
+
+    /**
+     * @brief 获取进行中的调用数
+     */
+    size_t getInflightCount()
+    {
+        size_t count = 0;
+        for(size_t i = 0; i < m_shardCount; ++i)
+        {
+            std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+            count += m_shards[i].calls.size();
+        }
+        return count;
+    }
+
+private:
+    /**
+     * @brief 进行中的调用
+     */
+    struct Call
+    {
+        std::mutex mutex;           // 保护done、value和error
+        FiberCondition cond;        // 调用完成时唤醒等待者
+        bool done = false;          // 是否已完成
+        Value value{};              // 调用结果
+        std::exception_ptr error;   // 后端调用抛出的异常
+    };
+
+    /**
+     * @brief 分片
+     */
+    struct Shard
+    {
+        std::mutex mutex;                                              // 保护calls
+        std::unordered_map<Key, std::shared_ptr<Call>, Hash> calls;    // 进行中的调用
+    };
+
+    /**
+     * @brief 获取key所在的分片
+     */
+    Shard& shardOf(const Key& key)
+    {
+        // 哈希值的高位参与分片选择，避免与unordered_map使用的低位相关
+        size_t h = m_hash(key);
+        h ^= h >> 16;
+        return m_shards[h & (m_shardCount - 1)];
+    }
+
+private:
+    std::unique_ptr<Shard[]> m_shards;  // 分片
+    size_t m_shardCount;                // 分片数（2的幂）
+    Hash m_hash;                        // 哈希函数
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_SINGLE_FLIGHT_H_
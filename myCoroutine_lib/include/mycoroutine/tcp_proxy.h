@@ -0,0 +1,106 @@
+#ifndef __MYCOROUTINE_TCP_PROXY_H_
+#define __MYCOROUTINE_TCP_PROXY_H_
+
+/**
+ * @file tcp_proxy.h
+ * @brief 四层TCP转发头文件
+ * @details 把客户端套接字和后端套接字双向连接起来。默认每个方向一根管道，
+ *          用splice在内核中把数据从套接字搬到管道、再从管道搬到另一个套接字，数据不经过用户态；
+ *          就绪等待通过IOManager完成，只挂起当前协程
+ */
+
+#include <mycoroutine/iomanager.h>  // IO管理器
+
+#include <atomic>    // 字节计数
+#include <cstdint>   // uint64_t
+
+namespace mycoroutine {
+
+/**
+ * @brief 转发配置
+ */
+struct TcpProxyConfig
+{
+    bool use_splice = true;          // true使用splice零拷贝，false使用read/send拷贝（对比或splice不可用时）
+    size_t pipe_size = 1024 * 1024;  // 管道容量（F_SETPIPE_SZ），受/proc/sys/fs/pipe-max-size限制
+    size_t chunk_size = 64 * 1024;   // 单次搬运的最大字节数（拷贝模式下为缓冲区大小）
+};
+
+/**
+ * @brief 双向TCP转发
+ * @details 每个方向独立转发：读到EOF时对另一端shutdown(SHUT_WR)，另一个方向继续，实现半关闭；
+ *          两个方向都结束后run()返回。读写超时沿用FdCtx中通过setsockopt(SO_RCVTIMEO/SO_SNDTIMEO)设置的值，
+ *          任一方向出错或超时时两端都被shutdown，另一个方向随即结束
+ * @note 不拥有套接字，run()返回后由调用者关闭；套接字会被设为O_NONBLOCK。
+ *       run()需要在IOManager调度的协程中调用；splice向已关闭的连接写入会产生SIGPIPE，调用者应当忽略SIGPIPE
+ */
+class TcpProxy
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param client 客户端套接字
+     * @param backend 后端套接字
+     * @param config 转发配置
+     */
+    TcpProxy(int client, int backend, const TcpProxyConfig& config = TcpProxyConfig());
+
+    /**
+     * @brief 析构函数，关闭管道
+     */
+    ~TcpProxy();
+
+    TcpProxy(const TcpProxy&) = delete;
+    TcpProxy& operator=(const TcpProxy&) = delete;
+
+    /**
+     * @brief 双向转发直到两个方向都结束
+     * @return 两个方向都正常结束（读到EOF）返回0；任一方向出错或超时返回-1（errno为第一个错误）
+     * @details 后端到客户端方向在当前协程中转发，客户端到后端方向在新协程中转发
+     */
+    int run();
+
+    /**
+     * @brief 获取客户端到后端已转发的字节数
+     */
+    uint64_t getUpstreamBytes() const {return m_upBytes.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 获取后端到客户端已转发的字节数
+     */
+    uint64_t getDownstreamBytes() const {return m_downBytes.load(std::memory_order_relaxed);}
+
+private:
+    /**
+     * @brief 单方向转发直到EOF或出错
+     * @param in 读端套接字
+     * @param out 写端套接字
+     * @param pipe 该方向使用的管道
+     * @param bytes 字节计数
+     * @return 读到EOF返回0，出错或超时返回errno
+     */
+    int pump(int in, int out, int pipe[2], std::atomic<uint64_t>& bytes);
+
+    /**
+     * @brief splice实现
+     */
+    int pumpSplice(int in, int out, int pipe[2], uint64_t rto, uint64_t wto, std::atomic<uint64_t>& bytes);
+
+    /**
+     * @brief read/send拷贝实现
+     */
+    int pumpCopy(int in, int out, uint64_t rto, uint64_t wto, std::atomic<uint64_t>& bytes);
+
+private:
+    int m_client;                           // 客户端套接字
+    int m_backend;                          // 后端套接字
+    TcpProxyConfig m_config;                // 转发配置
+    int m_upPipe[2] = {-1, -1};             // 客户端到后端方向的管道
+    int m_downPipe[2] = {-1, -1};           // 后端到客户端方向的管道
+    std::atomic<uint64_t> m_upBytes{0};     // 客户端到后端已转发的字节数
+    std::atomic<uint64_t> m_downBytes{0};   // 后端到客户端已转发的字节数
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_TCP_PROXY_H_
@@ -14,6 +14,8 @@
 #include <functional>
 #include <mutex>
 
+#include <mycoroutine/histogram.h>
+
 namespace mycoroutine {
 
 // 前向声明TimerManager类，避免循环依赖
@@ -157,6 +159,14 @@ public:
     // ========================================================================
     bool hasTimer();
 
+    // ========================================================================
+    // 获取定时器延迟触发统计
+    // listExpiredCb()取出定时器时记录(实际时间 - 到期时间)，单位微秒，
+    // 数值持续偏大说明工作线程忙于执行任务、不能及时回到epoll处理定时器
+    // @return 最近一个窗口内的滚动直方图
+    // ========================================================================
+    const RollingHistogram& getTimerLateness() const {return m_lateness;}
+
 protected:
     // ========================================================================
     // 当定时器插入到堆顶时的回调
@@ -188,6 +198,8 @@ private:
     bool m_tickled = false;
     // 上次检查系统时间是否回退的时间点
     std::chrono::time_point<std::chrono::system_clock> m_previouseTime;
+    // 定时器延迟触发统计（微秒）
+    RollingHistogram m_lateness;
 };
 
 } // namespace mycoroutine
@@ -7,6 +7,8 @@
 #include <mutex>
 #include <cstdarg>
 #include <ctime>
+#include <cstdint>
+#include <chrono>
 
 namespace mycoroutine {
 
@@ -82,6 +84,26 @@ private:
     std::mutex m_mutex;     // 日志输出互斥锁
 };
 
+/**
+ * @brief 获取单调时钟的当前时间（毫秒）
+ * @details 用于超时截止时间、空闲检测和过期时间，不受系统时间调整影响
+ */
+inline uint64_t steady_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief 获取单调时钟的当前时间（微秒）
+ * @details 用于调度延迟等需要更高精度的测量
+ */
+inline uint64_t steady_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 // 日志宏定义
 #define MYCOROUTINE_LOG(level, ...) \
     do { \
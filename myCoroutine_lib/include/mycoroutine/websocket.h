@@ -0,0 +1,251 @@
+#ifndef __MYCOROUTINE_WEBSOCKET_H_
+#define __MYCOROUTINE_WEBSOCKET_H_
+
+/**
+ * @file websocket.h
+ * @brief WebSocket服务端头文件
+ * @details 在IOManager和合并写队列之上实现RFC 6455服务端：升级握手、帧解析、分片重组、
+ *          基于定时器的ping/pong保活，以及共享同一份编码帧的广播
+ */
+
+#include <mycoroutine/iomanager.h>    // IO管理器
+#include <mycoroutine/write_queue.h>  // 合并写队列
+#include <mycoroutine/http_parser.h>  // HTTP请求解析器
+
+#include <memory>     // 智能指针
+#include <string>     // 消息数据
+#include <vector>     // 连接列表
+#include <mutex>      // 互斥锁
+#include <atomic>     // 原子变量
+#include <cstdint>    // uint8_t
+
+namespace mycoroutine {
+
+/**
+ * @brief WebSocket连接配置
+ */
+struct WebSocketConfig
+{
+    uint64_t ping_interval_ms = 30000;            // 发送ping的间隔，0表示不发送
+    uint64_t idle_timeout_ms = 60000;             // 超过该时间没有收到任何帧则断开，0表示不检查
+    size_t max_message_size = 16 * 1024 * 1024;   // 单条消息（重组后）的最大长度
+    size_t high_watermark = 4 * 1024 * 1024;      // 发送队列高水位
+    uint64_t close_timeout_ms = 5000;             // close()等待发送队列清空的最长时间，超时后shutdown连接，0表示不限制
+};
+
+/**
+ * @brief WebSocket服务端连接
+ * @details recvMessage()只能由一个协程调用；send()/sendFrame()可以在任意协程中并发调用，
+ *          数据经由连接的WriteQueue合并发送。控制帧在recvMessage()内部处理：
+ *          收到ping自动回复pong，收到close回复close后返回false
+ * @note 不拥有fd，close()之后由调用者关闭fd；需要在IOManager调度的协程中使用
+ */
+class WebSocket : public std::enable_shared_from_this<WebSocket>
+{
+public:
+    /**
+     * @brief 帧类型
+     */
+    enum Opcode
+    {
+        CONTINUATION = 0x0,  // 后续分片
+        TEXT         = 0x1,  // 文本消息
+        BINARY       = 0x2,  // 二进制消息
+        CLOSE        = 0x8,  // 关闭
+        PING         = 0x9,  // ping
+        PONG         = 0xA   // pong
+    };
+
+    /**
+     * @brief 完整消息（分片已重组）
+     */
+    struct Message
+    {
+        Opcode opcode = TEXT;  // TEXT或BINARY
+        std::string data;      // 消息内容（已去掩码）
+    };
+
+    /**
+     * @brief 读取并解析升级请求，完成握手
+     * @param fd 已连接的套接字
+     * @param config 连接配置
+     * @return 握手成功返回连接对象；请求无效时回复400并返回nullptr
+     */
+    static std::shared_ptr<WebSocket> Accept(int fd, const WebSocketConfig& config = WebSocketConfig());
+
+    /**
+     * @brief 使用已解析的请求完成握手
+     * @param fd 已连接的套接字
+     * @param req 已解析的升级请求
+     * @param extra 请求头之后已经读入的数据（客户端可能紧接着发送第一帧）
+     * @param extra_len extra的长度
+     * @param config 连接配置
+     * @return 握手成功返回连接对象；请求无效时回复400并返回nullptr
+     */
+    static std::shared_ptr<WebSocket> Upgrade(int fd, const HttpRequest& req, const char* extra = nullptr,
+                                              size_t extra_len = 0, const WebSocketConfig& config = WebSocketConfig());
+
+    /**
+     * @brief 判断请求是否是合法的WebSocket升级请求
+     * @param req 已解析的请求
+     */
+    static bool IsUpgradeRequest(const HttpRequest& req);
+
+    /**
+     * @brief 编码一个服务端帧（不加掩码）
+     * @param opcode 帧类型
+     * @param data 负载
+     * @param len 负载长度
+     * @return 编码后的帧，可以同时投递给多个连接
+     */
+    static WriteQueue::Buffer EncodeFrame(Opcode opcode, const void* data, size_t len);
+
+    /**
+     * @brief 构造函数（通过Accept/Upgrade创建）
+     * @param fd 套接字文件描述符
+     * @param config 连接配置
+     */
+    WebSocket(int fd, const WebSocketConfig& config);
+
+    /**
+     * @brief 析构函数，停止保活定时器
+     */
+    ~WebSocket();
+
+    /**
+     * @brief 接收一条完整消息
+     * @param msg 输出参数，收到的消息
+     * @return 收到消息返回true；连接关闭、超时或协议错误返回false
+     */
+    bool recvMessage(Message& msg);
+
+    /**
+     * @brief 发送一条消息
+     * @param data 消息内容
+     * @param opcode TEXT或BINARY
+     * @return 成功入队返回true
+     */
+    bool send(const std::string& data, Opcode opcode = TEXT);
+
+    /**
+     * @brief 发送已编码的帧
+     * @param frame EncodeFrame()得到的帧
+     * @param wait 发送队列已满时是否挂起等待，false时直接返回失败
+     * @return 成功入队返回true
+     */
+    bool sendFrame(const WriteQueue::Buffer& frame, bool wait = true);
+
+    /**
+     * @brief 关闭连接
+     * @param code 关闭码
+     * @param reason 关闭原因
+     * @details 发送close帧（若尚未发送）、停止保活定时器并等待发送队列清空；可重复调用。
+     *          对端停止读取、队列在close_timeout_ms内没有清空时shutdown(SHUT_RDWR)连接，不会无限期挂起
+     */
+    void close(uint16_t code = 1000, const std::string& reason = "");
+
+    /**
+     * @brief 获取套接字文件描述符
+     */
+    int getFd() const {return m_fd;}
+
+    /**
+     * @brief 是否已关闭
+     */
+    bool isClosed() const {return m_closed;}
+
+private:
+    /**
+     * @brief 启动保活定时器
+     */
+    void startKeepalive();
+
+    /**
+     * @brief 保活定时器回调
+     */
+    void onKeepalive();
+
+    /**
+     * @brief 读取更多数据到接收缓冲区
+     * @param need 从m_rpos开始至少需要的字节数，不足时扩容
+     * @return 读取的字节数，0表示对端关闭，-1表示出错
+     */
+    ssize_t fill(size_t need);
+
+    /**
+     * @brief 因协议错误关闭连接
+     * @param code 关闭码
+     * @return 总是返回false，便于recvMessage()直接返回
+     */
+    bool fail(uint16_t code);
+
+private:
+    int m_fd;                                   // 套接字文件描述符
+    WebSocketConfig m_config;                   // 连接配置
+    IOManager* m_iom;                           // 所在的IO管理器
+    std::shared_ptr<WriteQueue> m_queue;        // 发送队列
+    std::vector<char> m_rbuf;                   // 接收缓冲区（只在扩容时清零）
+    size_t m_rpos = 0;                          // 接收缓冲区中已解析的位置
+    size_t m_rend = 0;                          // 接收缓冲区中有效数据的结束位置
+    std::mutex m_mutex;                         // 保护m_timer和m_closeSent
+    std::shared_ptr<Timer> m_timer;             // 保活定时器
+    bool m_closeSent = false;                   // 是否已发送close帧
+    std::atomic<bool> m_closed{false};          // 是否已关闭
+    std::atomic<uint64_t> m_lastActive{0};      // 最近一次收到帧的时间（毫秒，steady_clock）
+};
+
+/**
+ * @brief WebSocket连接组
+ * @details 广播时只编码一次，同一份帧缓冲区投递到每个连接的发送队列。
+ *          发送队列已满的慢连接本次被跳过，不阻塞广播者
+ */
+class WebSocketGroup
+{
+public:
+    /**
+     * @brief 加入连接
+     */
+    void add(const std::shared_ptr<WebSocket>& ws);
+
+    /**
+     * @brief 移除连接
+     */
+    void remove(const std::shared_ptr<WebSocket>& ws);
+
+    /**
+     * @brief 获取连接数
+     */
+    size_t size();
+
+    /**
+     * @brief 广播消息
+     * @param data 消息内容
+     * @param opcode TEXT或BINARY
+     * @return 成功投递的连接数
+     */
+    size_t broadcast(const std::string& data, WebSocket::Opcode opcode = WebSocket::TEXT);
+
+    /**
+     * @brief 广播已编码的帧
+     * @param frame EncodeFrame()得到的帧
+     * @return 成功投递的连接数
+     */
+    size_t broadcastFrame(const WriteQueue::Buffer& frame);
+
+private:
+    std::mutex m_mutex;                                 // 保护m_members
+    std::vector<std::shared_ptr<WebSocket>> m_members;  // 组内连接
+};
+
+/**
+ * @brief 对负载原地加/去掩码
+ * @param data 负载
+ * @param len 负载长度
+ * @param key 4字节掩码
+ * @details 按CPU能力选择AVX2或SSE2一次处理32/16字节，尾部逐字节处理
+ */
+void websocket_mask(char* data, size_t len, const uint8_t key[4]);
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_WEBSOCKET_H_
@@ -0,0 +1,148 @@
+#ifndef __MYCOROUTINE_WRITE_QUEUE_H_
+#define __MYCOROUTINE_WRITE_QUEUE_H_
+
+/**
+ * @file write_queue.h
+ * @brief 连接级合并写队列头文件
+ * @details 多个协程向同一个套接字写数据时，先进入队列，由单个刷新协程合并成writev批量发送
+ */
+
+#include <mycoroutine/iomanager.h>   // IO管理器
+#include <mycoroutine/fiber_sync.h>  // 协程条件变量
+
+#include <deque>      // 发送队列
+#include <string>     // 数据缓冲区
+#include <memory>     // 智能指针
+#include <mutex>      // 互斥锁
+
+namespace mycoroutine {
+
+/**
+ * @brief 合并写队列
+ * @details 任意协程都可以调用push()投递缓冲区；队列非空时调度一个刷新协程，
+ *          每批最多IOV_MAX个缓冲区合并为一次sendmsg，批次之间带MSG_MORE以便内核合并报文。
+ *          队列中待发送字节数达到高水位时，push()挂起生产者协程，形成反压。
+ *          缓冲区以共享指针保存，同一份数据可以同时投递到多个连接的队列而无需复制。
+ * @note 必须通过std::make_shared创建；队列不拥有fd，关闭fd由调用者负责
+ */
+class WriteQueue : public std::enable_shared_from_this<WriteQueue>
+{
+public:
+    /**
+     * @brief 缓冲区类型，入队后内容不可再修改
+     */
+    typedef std::shared_ptr<const std::string> Buffer;
+
+    /**
+     * @brief 构造函数
+     * @param fd 套接字文件描述符
+     * @param high_watermark 高水位（字节），待发送数据达到该值时push()挂起
+     * @param iom 刷新协程所在的IO管理器，默认为当前线程的IO管理器
+     */
+    WriteQueue(int fd, size_t high_watermark = 4 * 1024 * 1024, IOManager* iom = IOManager::GetThis());
+
+    /**
+     * @brief 析构函数
+     */
+    ~WriteQueue();
+
+    /**
+     * @brief 投递缓冲区，队列已满时挂起当前协程
+     * @param buf 要发送的缓冲区
+     * @return 成功入队返回true；队列已关闭或连接出错返回false
+     */
+    bool push(Buffer buf);
+
+    /**
+     * @brief 投递数据（拷贝一次到内部缓冲区）
+     * @param data 要发送的数据
+     * @return 成功入队返回true；队列已关闭或连接出错返回false
+     */
+    bool push(std::string data);
+
+    /**
+     * @brief 非阻塞投递
+     * @param buf 要发送的缓冲区
+     * @return 成功入队返回true；队列已满、已关闭或出错返回false
+     */
+    bool tryPush(Buffer buf);
+
+    /**
+     * @brief 挂起当前协程直到队列中的数据全部发送完毕
+     * @param timeout_ms 最长等待时间（毫秒），(uint64_t)-1表示不限制
+     * @return 全部发送成功返回true；连接出错返回false；超时返回false并设置errno为ETIMEDOUT
+     * @note 超时不会丢弃队列中的数据，刷新协程仍在等待对端读取
+     */
+    bool flush(uint64_t timeout_ms = (uint64_t)-1);
+
+    /**
+     * @brief 关闭队列
+     * @details 之后的push()返回false，已入队的数据仍会继续发送
+     */
+    void close();
+
+    /**
+     * @brief 投递最后一个缓冲区并关闭队列
+     * @param buf 最后一个缓冲区（如WebSocket的close帧）
+     * @return 成功入队返回true；队列已关闭或连接出错返回false
+     * @details 入队与关闭在同一次加锁内完成，之后的push()一定返回false，buf之后不会再有其他数据；
+     *          buf通常很小，不受高水位限制，不会挂起
+     */
+    bool closeWith(Buffer buf);
+
+    /**
+     * @brief 获取待发送字节数
+     */
+    size_t pendingBytes();
+
+    /**
+     * @brief 获取发送错误码
+     * @return 未出错返回0，否则返回sendmsg失败时的errno
+     */
+    int getError();
+
+    /**
+     * @brief 获取套接字文件描述符
+     */
+    int getFd() const {return m_fd;}
+
+private:
+    /**
+     * @brief 入队（需持有m_mutex）
+     * @param buf 要发送的缓冲区
+     * @details 队列由空变为非空且没有刷新协程时调度一个刷新协程
+     */
+    void enqueue(Buffer buf);
+
+    /**
+     * @brief 刷新协程主函数
+     * @details 批量发送队列中的数据，队列清空后退出，空闲连接不占用协程
+     */
+    void flushLoop();
+
+    /**
+     * @brief 从队头消费已发送的字节（需持有m_mutex）
+     * @param n 已发送字节数
+     */
+    void consume(size_t n);
+
+private:
+    int m_fd;                           // 套接字文件描述符
+    size_t m_highWatermark;             // 高水位
+    size_t m_lowWatermark;              // 低水位，回落到该值以下时唤醒生产者
+    IOManager* m_iom;                   // 刷新协程所在的IO管理器
+
+    std::mutex m_mutex;                 // 保护以下成员
+    std::deque<Buffer> m_queue;         // 待发送缓冲区队列
+    size_t m_frontOffset = 0;           // 队头缓冲区已发送的字节数
+    size_t m_pendingBytes = 0;          // 待发送字节总数
+    bool m_flushing = false;            // 是否有刷新协程在运行
+    bool m_closed = false;              // 是否已关闭
+    int m_error = 0;                    // 发送错误码
+    FiberCondition m_notFull;           // 生产者等待队列有空间
+    FiberCondition m_drained;           // 等待队列清空
+};
+
+} // end namespace mycoroutine
+
+#endif // __MYCOROUTINE_WRITE_QUEUE_H_
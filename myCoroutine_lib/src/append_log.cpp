@@ -0,0 +1,247 @@
+#include <mycoroutine/append_log.h>  // 组提交追加日志头文件
+#include <mycoroutine/fiber.h>       // 协程
+
+#include <fcntl.h>      // open
+#include <unistd.h>     // fdatasync/close
+#include <sys/stat.h>   // fstat
+#include <limits.h>     // IOV_MAX
+#include <errno.h>      // errno
+#include <cassert>      // assert
+#include <chrono>       // 凑组等待时间
+#include <algorithm>    // std::min
+
+namespace mycoroutine {
+
+/**
+ * @brief 打开（或创建）日志文件并启动刷盘线程
+ * @param path 文件路径
+ * @param config 组提交参数
+ * @return 成功返回日志对象，失败返回nullptr
+ */
+std::shared_ptr<AppendLog> AppendLog::Open(const std::string& path, const AppendLogConfig& config)
+{
+    // 不使用O_APPEND：Linux上O_APPEND会忽略pwritev的偏移，记录偏移由日志自己分配
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if(fd < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) < 0)
+    {
+        int err = errno;
+        ::close(fd);
+        errno = err;
+        return nullptr;
+    }
+    return std::make_shared<AppendLog>(fd, st.st_size, config);
+}
+
+/**
+ * @brief 构造函数
+ * @param fd 已打开的文件描述符
+ * @param offset 追加起始位置
+ * @param config 组提交参数
+ */
+AppendLog::AppendLog(int fd, uint64_t offset, const AppendLogConfig& config):
+    m_fd(fd), m_config(config), m_tail(offset), m_durableOffset(offset)
+{
+    if(m_config.max_group_records == 0)
+    {
+        m_config.max_group_records = 1;
+    }
+    m_thread.reset(new Thread(std::bind(&AppendLog::run, this), "append_log"));
+}
+
+/**
+ * @brief 析构函数
+ */
+AppendLog::~AppendLog()
+{
+    close();
+}
+
+/**
+ * @brief 追加一条记录，挂起当前协程直到它所在的组持久化
+ * @param data 记录数据
+ * @param len 记录长度
+ * @return 成功返回记录在文件中的偏移，失败返回-1
+ */
+int64_t AppendLog::append(const void* data, size_t len)
+{
+    assert(Scheduler::GetThis() != nullptr);
+
+    int64_t result;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_stopping || m_error)
+        {
+            return -1;
+        }
+        result = m_tail;
+        m_tail += len;
+        m_pending.push_back({{const_cast<void*>(data), len}, &result, Scheduler::GetThis(), Fiber::GetThis()});
+        m_pendingBytes += len;
+
+        // 只在刷盘线程可能正在等待的两个时刻唤醒它：队列由空变非空，或凑组期间达到组上限
+        if(m_pending.size() == 1 || (m_config.max_group_delay_us && groupFull()))
+        {
+            m_pendingCond.notify_one();
+        }
+    }
+
+    // 让出执行权，等待所在的组持久化后由刷盘线程重新调度。
+    // 如果在yield之前就被调度，调度器会在Fiber::m_mutex上等待本次yield完成
+    Fiber::GetThis()->yield();
+    return result;
+}
+
+/**
+ * @brief 提交剩余记录，停止刷盘线程并关闭文件
+ */
+void AppendLog::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_stopping)
+        {
+            return;
+        }
+        m_stopping = true;
+        m_pendingCond.notify_one();
+    }
+
+    m_thread->join();
+    ::close(m_fd);
+}
+
+/**
+ * @brief 当前待提交记录是否已达到组上限
+ * @note 调用者需持有m_mutex
+ */
+bool AppendLog::groupFull() const
+{
+    return m_pending.size() >= m_config.max_group_records || m_pendingBytes >= m_config.max_group_bytes;
+}
+
+/**
+ * @brief 刷盘线程主循环
+ * @details 每轮从队列头部取出一组记录，在锁外写入并刷盘，然后恢复组内所有协程。
+ *          停止时先提交完队列中的剩余记录再退出
+ */
+void AppendLog::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true)
+    {
+        m_pendingCond.wait(lock, [this]() {return m_stopping || !m_pending.empty();});
+        if(m_pending.empty())
+        {
+            break;
+        }
+
+        // 负载较低时等待更多记录凑成一组
+        if(m_config.max_group_delay_us && !m_stopping && !groupFull())
+        {
+            m_pendingCond.wait_for(lock, std::chrono::microseconds(m_config.max_group_delay_us),
+                                   [this]() {return m_stopping || groupFull();});
+        }
+
+        // 取出一组：至少一条记录，不超过记录数和字节数上限
+        size_t bytes = 0;
+        m_group.clear();
+        while(!m_pending.empty() && m_group.size() < m_config.max_group_records &&
+              (m_group.empty() || bytes + m_pending.front().iov.iov_len <= m_config.max_group_bytes))
+        {
+            bytes += m_pending.front().iov.iov_len;
+            m_group.push_back(std::move(m_pending.front()));
+            m_pending.pop_front();
+        }
+        m_pendingBytes -= bytes;
+        lock.unlock();
+
+        // 出错之后不再写入，后续记录全部失败
+        uint64_t offset = m_durableOffset;
+        int err = m_error;
+        if(!err)
+        {
+            err = writeGroup(offset);
+            if(err)
+            {
+                m_error = err;
+            }
+            else
+            {
+                m_durableOffset = offset + bytes;
+                ++m_groups;
+                m_records += m_group.size();
+            }
+        }
+
+        for(Record& record : m_group)
+        {
+            if(err)
+            {
+                *record.result = -1;
+            }
+            record.scheduler->scheduleLock(record.fiber);
+        }
+        m_group.clear();
+        lock.lock();
+    }
+}
+
+/**
+ * @brief 写入一组记录并刷盘
+ * @param offset 写入位置
+ * @return 成功返回0，失败返回errno
+ * @details 组内记录超过IOV_MAX或发生短写时分多次pwritev，每组只fdatasync一次
+ */
+int AppendLog::writeGroup(uint64_t offset)
+{
+    m_iov.clear();
+    for(Record& record : m_group)
+    {
+        if(record.iov.iov_len)
+        {
+            m_iov.push_back(record.iov);
+        }
+    }
+
+    size_t idx = 0;
+    while(idx < m_iov.size())
+    {
+        int cnt = (int)std::min(m_iov.size() - idx, (size_t)IOV_MAX);
+        ssize_t n = pwritev(m_fd, &m_iov[idx], cnt, offset);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return errno;
+        }
+        offset += n;
+
+        // 跳过已写完的iovec，短写时调整第一个未写完的iovec
+        while(idx < m_iov.size() && (size_t)n >= m_iov[idx].iov_len)
+        {
+            n -= m_iov[idx].iov_len;
+            ++idx;
+        }
+        if(n > 0)
+        {
+            m_iov[idx].iov_base = (char*)m_iov[idx].iov_base + n;
+            m_iov[idx].iov_len -= n;
+        }
+    }
+
+    if(m_config.sync && fdatasync(m_fd) < 0)
+    {
+        return errno;
+    }
+    return 0;
+}
+
+} // end namespace mycoroutine
@@ -0,0 +1,306 @@
+#include <mycoroutine/buffer_pool.h>  // 缓冲区池头文件
+#include <mycoroutine/iomanager.h>    // IO管理器（等待读事件）
+#include <mycoroutine/fd_manager.h>   // 文件描述符管理器（读取接收超时）
+#include <mycoroutine/hook.h>         // 原始系统调用
+
+#include <vector>       // 空闲缓冲区列表
+#include <atomic>       // 全局配置
+#include <cstdlib>      // malloc/free
+#include <cstring>      // memset
+#include <algorithm>    // std::min
+#include <errno.h>      // errno
+
+namespace mycoroutine {
+
+// 缓冲区大小（字节）
+static std::atomic<size_t> s_buffer_size{16 * 1024};
+
+// 每个线程最多缓存的空闲缓冲区数量
+static std::atomic<size_t> s_max_cached{64};
+
+// 当前线程的缓冲区缓存是否已析构。放在可平凡析构的变量中：缓存析构之后，
+// 更晚析构的线程局部对象仍可能归还缓冲区，此时不能再访问缓存对象
+static thread_local bool t_cache_closed = false;
+
+/**
+ * @brief 线程级空闲缓冲区列表
+ * @details 所有缓存的缓冲区大小相同，记录在buffer_size中；线程退出时释放所有缓存的缓冲区
+ */
+struct ThreadBufferCache
+{
+    std::vector<char*> free_list;  // 空闲缓冲区
+    size_t buffer_size = 0;        // 缓存中缓冲区的大小
+
+    ~ThreadBufferCache()
+    {
+        for(char* p : free_list)
+        {
+            free(p);
+        }
+        free_list.clear();
+        t_cache_closed = true;
+    }
+};
+
+// 当前线程的缓冲区缓存
+static thread_local ThreadBufferCache t_cache;
+
+/**
+ * @brief 获取当前线程中大小为size的空闲缓冲区列表
+ * @param size 缓冲区大小
+ * @return 空闲缓冲区列表，缓存已随线程退出析构时返回nullptr
+ * @details 缓冲区大小被SetBufferSize()修改后，先释放缓存中旧大小的缓冲区
+ */
+static std::vector<char*>* free_list_for(size_t size)
+{
+    if(t_cache_closed)
+    {
+        return nullptr;
+    }
+    if(t_cache.buffer_size != size)
+    {
+        for(char* p : t_cache.free_list)
+        {
+            free(p);
+        }
+        t_cache.free_list.clear();
+        t_cache.buffer_size = size;
+    }
+    return &t_cache.free_list;
+}
+
+/**
+ * @brief 析构函数，归还缓冲区
+ */
+PooledBuffer::~PooledBuffer()
+{
+    reset();
+}
+
+/**
+ * @brief 移动构造函数
+ */
+PooledBuffer::PooledBuffer(PooledBuffer&& other) noexcept:
+    m_data(other.m_data), m_capacity(other.m_capacity), m_size(other.m_size)
+{
+    other.m_data = nullptr;
+    other.m_capacity = 0;
+    other.m_size = 0;
+}
+
+/**
+ * @brief 移动赋值
+ */
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept
+{
+    if(this != &other)
+    {
+        reset();
+        m_data = other.m_data;
+        m_capacity = other.m_capacity;
+        m_size = other.m_size;
+        other.m_data = nullptr;
+        other.m_capacity = 0;
+        other.m_size = 0;
+    }
+    return *this;
+}
+
+/**
+ * @brief 立即归还缓冲区
+ */
+void PooledBuffer::reset()
+{
+    if(m_data)
+    {
+        BufferPool::Release(m_data, m_capacity);
+        m_data = nullptr;
+        m_capacity = 0;
+        m_size = 0;
+    }
+}
+
+/**
+ * @brief 从当前线程的缓冲区池借用一个缓冲区
+ * @return 池化缓冲区，分配失败时data()为nullptr、容量为0，并设置errno为ENOMEM
+ */
+PooledBuffer BufferPool::Acquire()
+{
+    size_t size = s_buffer_size;
+    std::vector<char*>* free_list = free_list_for(size);
+    if(free_list && !free_list->empty())
+    {
+        char* p = free_list->back();
+        free_list->pop_back();
+        return PooledBuffer(p, size);
+    }
+    char* p = (char*)malloc(size);
+    if(!p)
+    {
+        errno = ENOMEM;
+        return PooledBuffer(nullptr, 0);
+    }
+    return PooledBuffer(p, size);
+}
+
+/**
+ * @brief 归还缓冲区
+ * @param data 缓冲区首地址
+ * @param capacity 缓冲区容量
+ */
+void BufferPool::Release(char* data, size_t capacity)
+{
+    std::vector<char*>* free_list = free_list_for(s_buffer_size);
+    if(!free_list || capacity != t_cache.buffer_size || free_list->size() >= s_max_cached)
+    {
+        free(data);
+        return;
+    }
+    free_list->push_back(data);
+}
+
+/**
+ * @brief 设置缓冲区大小
+ * @param size 缓冲区大小（字节）
+ * @details 各线程缓存中旧大小的缓冲区在该线程下次借用、归还或预分配时释放
+ */
+void BufferPool::SetBufferSize(size_t size)
+{
+    s_buffer_size = size;
+}
+
+/**
+ * @brief 获取缓冲区大小
+ */
+size_t BufferPool::GetBufferSize()
+{
+    return s_buffer_size;
+}
+
+/**
+ * @brief 设置每个线程最多缓存的空闲缓冲区数量
+ * @param count 缓存数量
+ */
+void BufferPool::SetMaxCached(size_t count)
+{
+    s_max_cached = count;
+}
+
+/**
+ * @brief 获取每个线程最多缓存的空闲缓冲区数量
+ */
+size_t BufferPool::GetMaxCached()
+{
+    return s_max_cached.load();
+}
+
+/**
+ * @brief 获取当前线程缓存的空闲缓冲区数量
+ */
+size_t BufferPool::GetCachedCount()
+{
+    return t_cache_closed ? 0 : t_cache.free_list.size();
+}
+
+/**
+ * @brief 在当前线程预先分配并触页若干缓冲区
+ * @param count 缓冲区数量
+ * @return 当前线程缓存的空闲缓冲区数量
+ */
+size_t BufferPool::Reserve(size_t count)
+{
+    size_t size = s_buffer_size;
+    std::vector<char*>* free_list = free_list_for(size);
+    if(!free_list)
+    {
+        return 0;
+    }
+    size_t limit = std::min(count, s_max_cached.load());
+    while(free_list->size() < limit)
+    {
+        char* p = (char*)malloc(size);
+        if(!p)
+        {
+            break;
+        }
+        memset(p, 0, size);
+        free_list->push_back(p);
+    }
+    return free_list->size();
+}
+
+/**
+ * @brief 释放当前线程缓存的所有空闲缓冲区
+ */
+void BufferPool::Trim()
+{
+    if(t_cache_closed)
+    {
+        return;
+    }
+    std::vector<char*>& free_list = t_cache.free_list;
+    for(char* p : free_list)
+    {
+        free(p);
+    }
+    free_list.clear();
+    free_list.shrink_to_fit();
+}
+
+/**
+ * @brief 就绪驱动的接收
+ * @param fd 套接字文件描述符
+ * @param out 输出参数，成功时持有包含数据的缓冲区
+ * @param flags recv标志
+ * @return 成功返回接收的字节数，失败返回-1并设置errno
+ */
+ssize_t recv_pooled(int fd, PooledBuffer& out, int flags)
+{
+    // 接收超时沿用FdCtx中通过setsockopt(SO_RCVTIMEO)设置的值
+    uint64_t timeout = (uint64_t)-1;
+    std::shared_ptr<FdCtx> ctx = FdMgr::GetInstance()->get(fd);
+    if(ctx)
+    {
+        timeout = ctx->getTimeout(SO_RCVTIMEO);
+    }
+
+    while(true)
+    {
+        {
+            PooledBuffer buf = BufferPool::Acquire();
+            if(!buf.data())
+            {
+                return -1;
+            }
+            ssize_t n = recv_f(fd, buf.data(), buf.capacity(), flags | MSG_DONTWAIT);
+            if(n >= 0)
+            {
+                buf.setSize(n);
+                out = std::move(buf);
+                return n;
+            }
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            if(errno != EAGAIN)
+            {
+                return -1;
+            }
+            // 离开作用域时缓冲区归还，等待期间不持有缓冲区
+        }
+
+        IOManager* iom = IOManager::GetThis();
+        if(!iom)
+        {
+            errno = EAGAIN;
+            return -1;
+        }
+        if(iom->waitEvent(fd, IOManager::READ, timeout))
+        {
+            return -1;
+        }
+    }
+}
+
+} // end namespace mycoroutine
@@ -0,0 +1,254 @@
+#include <mycoroutine/epoch.h>  // 纪元回收头文件
+
+#include <atomic>      // 纪元与线程状态
+#include <mutex>       // 线程登记表
+#include <vector>      // 线程登记表
+#include <deque>       // 待回收列表
+#include <algorithm>   // std::find
+
+namespace mycoroutine {
+
+// 单个线程待回收列表超过该长度时，在Retire()中立即尝试回收
+static const size_t kCollectThreshold = 64;
+
+/**
+ * @brief 待回收对象
+ */
+struct RetiredObject
+{
+    void* ptr;                 // 对象
+    void (*deleter)(void*);    // 释放函数
+    uint64_t epoch;            // 摘除时的全局纪元
+};
+
+/**
+ * @brief 线程状态
+ * @details state为0表示不在临界区（离线），否则为本线程最近观察到的全局纪元
+ */
+struct EpochThread
+{
+    std::atomic<uint64_t> state{0};     // 观察到的纪元，0表示离线
+    bool online = false;                // 是否登记为在线读者
+    int depth = 0;                      // EpochGuard嵌套深度
+    std::deque<RetiredObject> limbo;    // 本线程的待回收列表（按纪元递增）
+
+    EpochThread();
+    ~EpochThread();
+};
+
+/**
+ * @brief 全局回收域
+ * @details 有意不析构：线程局部状态在进程退出阶段仍可能访问它
+ */
+struct EpochDomain
+{
+    std::atomic<uint64_t> epoch{1};          // 全局纪元，从1开始（0表示离线）
+    std::atomic<uint64_t> freed{0};          // 累计已释放的对象数
+    std::mutex mutex;                        // 保护threads和orphans
+    std::vector<EpochThread*> threads;       // 所有登记过的线程
+    std::deque<RetiredObject> orphans;       // 已退出线程遗留的待回收对象
+};
+
+static EpochDomain& domain()
+{
+    static EpochDomain* s_domain = new EpochDomain();
+    return *s_domain;
+}
+
+static thread_local EpochThread t_epoch;
+
+/**
+ * @brief 释放列表头部所有已过期（摘除后全局纪元至少推进了两次）的对象
+ */
+static void free_expired(std::deque<RetiredObject>& list, uint64_t epoch)
+{
+    EpochDomain& d = domain();
+    while(!list.empty() && list.front().epoch + 2 <= epoch)
+    {
+        RetiredObject obj = list.front();
+        list.pop_front();
+        obj.deleter(obj.ptr);
+        d.freed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief 尝试推进全局纪元
+ * @details 所有不在离线状态的线程都已观察到当前纪元时加一，并顺带回收遗留对象。
+ *          登记表被其他线程占用时直接放弃，由下一个静止点重试
+ */
+static void try_advance()
+{
+    EpochDomain& d = domain();
+    std::unique_lock<std::mutex> lock(d.mutex, std::try_to_lock);
+    if(!lock.owns_lock())
+    {
+        return;
+    }
+
+    uint64_t epoch = d.epoch.load();
+    for(EpochThread* thread : d.threads)
+    {
+        uint64_t state = thread->state.load();
+        if(state != 0 && state != epoch)
+        {
+            return;
+        }
+    }
+    d.epoch.compare_exchange_strong(epoch, epoch + 1);
+    free_expired(d.orphans, d.epoch.load());
+}
+
+/**
+ * @brief 尝试推进纪元并回收当前线程的过期对象
+ */
+static void collect(EpochThread& thread)
+{
+    try_advance();
+    free_expired(thread.limbo, domain().epoch.load());
+}
+
+/**
+ * @brief 登记当前线程
+ */
+EpochThread::EpochThread()
+{
+    EpochDomain& d = domain();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.threads.push_back(this);
+}
+
+/**
+ * @brief 线程退出：注销，并把未回收的对象交给全局遗留列表
+ */
+EpochThread::~EpochThread()
+{
+    state.store(0);
+    EpochDomain& d = domain();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.threads.erase(std::find(d.threads.begin(), d.threads.end(), this));
+    d.orphans.insert(d.orphans.end(), limbo.begin(), limbo.end());
+}
+
+/**
+ * @brief 延迟释放对象
+ * @param ptr 已从数据结构中摘除的对象
+ * @param deleter 释放函数
+ */
+void Epoch::Retire(void* ptr, void (*deleter)(void*))
+{
+    // 摘除操作对之后观察到新纪元的读者可见
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    EpochThread& thread = t_epoch;
+    thread.limbo.push_back({ptr, deleter, domain().epoch.load()});
+    if(thread.limbo.size() >= kCollectThreshold)
+    {
+        collect(thread);
+    }
+}
+
+/**
+ * @brief 当前线程登记为在线读者
+ */
+void Epoch::Online()
+{
+    EpochThread& thread = t_epoch;
+    thread.online = true;
+    thread.state.store(domain().epoch.load(), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+/**
+ * @brief 当前线程转为离线
+ */
+void Epoch::Offline()
+{
+    EpochThread& thread = t_epoch;
+    thread.online = false;
+    // release保证此前的读取不会被重排到离线之后
+    thread.state.store(0, std::memory_order_release);
+}
+
+/**
+ * @brief 静止点
+ */
+void Epoch::Quiescent()
+{
+    EpochThread& thread = t_epoch;
+    if(!thread.online)
+    {
+        return;
+    }
+    uint64_t epoch = domain().epoch.load();
+    if(thread.state.load(std::memory_order_relaxed) != epoch)
+    {
+        thread.state.store(epoch, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    if(!thread.limbo.empty())
+    {
+        collect(thread);
+    }
+}
+
+/**
+ * @brief 获取全局纪元
+ */
+uint64_t Epoch::GetEpoch()
+{
+    return domain().epoch.load();
+}
+
+/**
+ * @brief 获取当前线程待回收的对象数
+ */
+size_t Epoch::GetPendingCount()
+{
+    return t_epoch.limbo.size();
+}
+
+/**
+ * @brief 获取累计已释放的对象数
+ */
+uint64_t Epoch::GetFreedCount()
+{
+    return domain().freed.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief 进入临界区
+ * @details 在线线程在两个静止点之间已受保护，不需要任何操作
+ */
+EpochGuard::EpochGuard()
+{
+    EpochThread& thread = t_epoch;
+    m_pinned = !thread.online;
+    if(m_pinned && thread.depth++ == 0)
+    {
+        // 全屏障保证后续读取共享指针不会被重排到声明纪元之前
+        thread.state.store(domain().epoch.load(), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+/**
+ * @brief 离开临界区，最外层离开时顺带回收本线程的过期对象
+ */
+EpochGuard::~EpochGuard()
+{
+    if(!m_pinned)
+    {
+        return;
+    }
+    EpochThread& thread = t_epoch;
+    if(--thread.depth == 0)
+    {
+        thread.state.store(0, std::memory_order_release);
+        if(!thread.limbo.empty())
+        {
+            collect(thread);
+        }
+    }
+}
+
+} // end namespace mycoroutine
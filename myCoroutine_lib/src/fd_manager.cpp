@@ -1,9 +1,11 @@
 #include "mycoroutine/fd_manager.h" // 引入文件描述符管理器头文件
 #include "mycoroutine/hook.h"       // 引入系统调用钩子
+#include "mycoroutine/epoch.h"      // 纪元回收（旧查找表和被删除的上下文）
 
 #include <sys/types.h>   // 引入系统类型定义
 #include <sys/stat.h>    // 引入文件状态相关函数
 #include <unistd.h>      // 引入系统调用函数
+#include <algorithm>     // std::max
 
 namespace mycoroutine{  // mycoroutine命名空间
 
@@ -12,7 +14,7 @@ template class Singleton<FdManager>;
 
 // 静态成员变量需要在类外定义
 template<typename T>
-T* Singleton<T>::instance = nullptr;
+std::atomic<T*> Singleton<T>::instance{nullptr};
 
 template<typename T>
 std::mutex Singleton<T>::mutex;    
@@ -123,6 +125,35 @@ FdManager::FdManager()
 {
 	// 初始时预分配64个文件描述符上下文空间
 	m_datas.resize(64);
+	publishTable();
+}
+
+/**
+ * @brief 文件描述符管理器析构函数
+ * @details 已退役的旧表由纪元回收释放，这里只释放当前表
+ */
+FdManager::~FdManager()
+{
+	delete m_table.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief 按m_datas的大小重建并发布查找表
+ * @details 新表从m_datas复制指针后原子发布；读者可能仍持有旧表，交给纪元回收
+ */
+void FdManager::publishTable()
+{
+	std::vector<std::atomic<FdCtx*>>* table = new std::vector<std::atomic<FdCtx*>>(m_datas.size());
+	for(size_t i = 0; i < m_datas.size(); ++i)
+	{
+		(*table)[i].store(m_datas[i].get(), std::memory_order_relaxed);
+	}
+
+	std::vector<std::atomic<FdCtx*>>* old_table = m_table.exchange(table, std::memory_order_acq_rel);
+	if(old_table)
+	{
+		Epoch::Retire(old_table);
+	}
 }
 
 /**
@@ -134,62 +165,106 @@ FdManager::FdManager()
 std::shared_ptr<FdCtx> FdManager::get(int fd, bool auto_create)
 {
 	// 无效文件描述符直接返回nullptr
-	if(fd == -1)
+	if(fd < 0)
 	{
 		return nullptr;
 	}
 
-	// 读锁保护
-	std::shared_lock<std::shared_mutex> read_lock(m_mutex);
-	// 检查容器大小是否足够
-	if(m_datas.size() <= (size_t)fd)
+	// 无锁查找：上下文被删除后由纪元回收延迟释放，临界区内借用的指针始终有效，
+	// 而它的shared_ptr在回收前一直存在，shared_from_this()可以安全地增加引用计数
 	{
-		// 如果不自动创建，返回nullptr
-		if(auto_create == false)
+		EpochGuard guard;
+		FdCtx* ctx = lookup(fd);
+		if(ctx)
 		{
-			return nullptr;
+			return ctx->shared_from_this();
 		}
 	}
-	else
+	if(!auto_create)
 	{
-		// 如果上下文对象已存在或者不自动创建，直接返回现有对象
-		if(m_datas[fd] || !auto_create)
-		{
-			return m_datas[fd];
-		}
+		return nullptr;
 	}
 
-	// 升级锁：释放读锁，获取写锁
-	read_lock.unlock();
-	std::unique_lock<std::shared_mutex> write_lock(m_mutex);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	// 二次检查，防止在加锁前被其他线程创建
+	if(m_datas.size() > (size_t)fd && m_datas[fd])
+	{
+		return m_datas[fd];
+	}
 
-	// 二次检查，防止在锁切换期间被其他线程修改
+	std::shared_ptr<FdCtx> ctx = std::make_shared<FdCtx>(fd);
+	m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 	if(m_datas.size() <= (size_t)fd)
 	{
 		// 扩容，扩展为当前需要的1.5倍
-		m_datas.resize(fd * 1.5);
+		m_datas.resize(fd * 1.5 + 1);
+		m_datas[fd] = ctx;
+		publishTable();
 	}
-
-	// 创建新的文件描述符上下文对象
-	m_datas[fd] = std::make_shared<FdCtx>(fd);
-	return m_datas[fd];
+	else
+	{
+		m_datas[fd] = ctx;
+		(*m_table.load(std::memory_order_relaxed))[fd].store(ctx.get(), std::memory_order_release);
+	}
+	return ctx;
 }
 
 /**
  * @brief 删除文件描述符对应的上下文对象
  * @param fd 文件描述符
+ * @details 先从查找表摘除，再把持有上下文的shared_ptr交给纪元回收，
+ *          正在借用该上下文的读者离开临界区后才真正释放
  */
 void FdManager::del(int fd)
 {
-	// 写锁保护
-	std::unique_lock<std::shared_mutex> write_lock(m_mutex);
+	std::lock_guard<std::mutex> lock(m_mutex);
 	// 检查文件描述符是否在有效范围内
-	if(m_datas.size() <= (size_t)fd)
+	if(fd < 0 || m_datas.size() <= (size_t)fd || !m_datas[fd])
 	{
 		return;
 	}
-	// 重置智能指针，释放资源
+	(*m_table.load(std::memory_order_relaxed))[fd].store(nullptr, std::memory_order_release);
+	Epoch::Retire(new std::shared_ptr<FdCtx>(std::move(m_datas[fd])));
 	m_datas[fd].reset();
+	m_count.store(m_count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 预分配上下文数组
+ * @param size 数组大小
+ */
+void FdManager::reserve(size_t size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_datas.size() < size)
+	{
+		m_datas.resize(size);
+		publishTable();
+	}
+}
+
+/**
+ * @brief 收缩上下文数组
+ * @return 释放的槽位数量
+ */
+size_t FdManager::trim()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	size_t used = m_datas.size();
+	while(used > 0 && !m_datas[used - 1])
+	{
+		--used;
+	}
+	size_t size = std::max<size_t>(used, 64);
+	if(size >= m_datas.size())
+	{
+		return 0;
+	}
+	size_t released = m_datas.size() - size;
+	m_datas.resize(size);
+	m_datas.shrink_to_fit();
+	publishTable();
+	return released;
 }
 
 } // end namespace mycoroutine
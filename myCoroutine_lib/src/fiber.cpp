@@ -1,5 +1,14 @@
 #include <mycoroutine/fiber.h>
 
+#include <sys/mman.h>  // 协程栈映射
+#include <vector>      // 协程栈缓存
+#include <algorithm>   // std::min
+#include <new>         // std::bad_alloc
+
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/asan_interface.h>   // 复用栈前清除旧栈帧的投毒标记
+#endif
+
 // 调试模式开关，设置为true时会输出协程的创建、销毁和切换信息
 static bool debug = false;
 
@@ -25,6 +34,179 @@ static std::atomic<uint64_t> s_fiber_id{0};
 // 当前系统中协程总数计数器
 static std::atomic<uint64_t> s_fiber_count{0};
 
+// 默认协程栈大小
+static const size_t s_default_stack_size = 128000;
+
+// 映射顶端为shared_ptr控制块和协程对象预留的空间（控制块头部不超过64字节），按缓存行对齐
+static const size_t s_control_reserve = (sizeof(Fiber) + 64 + 63) & ~(size_t)63;
+
+// 每个线程最多缓存的空闲协程栈映射数量
+static std::atomic<size_t> s_stack_cache_size{16};
+
+/**
+ * @brief 计算栈映射长度：栈加上顶端预留的控制块空间，按页对齐
+ * @param stacksize 请求的栈大小
+ */
+static size_t mapping_size(size_t stacksize)
+{
+    static const size_t page = sysconf(_SC_PAGESIZE);
+    return (stacksize + s_control_reserve + page - 1) / page * page;
+}
+
+// 默认大小的栈映射长度，只有这个长度的映射进入缓存
+static const size_t s_default_mapping_size = mapping_size(s_default_stack_size);
+
+// 当前线程的协程栈缓存是否已析构。放在可平凡析构的变量中：缓存析构之后，
+// 更晚析构的线程局部对象（回调协程池、线程主协程）仍可能释放协程，此时不能再访问缓存对象
+static thread_local bool t_stack_cache_closed = false;
+
+/**
+ * @brief 线程级空闲协程栈映射缓存
+ * @details 线程退出时解除所有缓存的映射；之后释放的映射直接解除
+ */
+struct ThreadStackCache
+{
+    std::vector<void*> stacks;  // 空闲映射
+
+    ~ThreadStackCache()
+    {
+        for(void* p : stacks)
+        {
+            munmap(p, s_default_mapping_size);
+        }
+        stacks.clear();
+        t_stack_cache_closed = true;
+    }
+};
+
+// 当前线程的协程栈缓存
+static thread_local ThreadStackCache t_stack_cache;
+
+/**
+ * @brief 新建栈映射
+ * @param size 映射长度
+ * @return 失败返回nullptr
+ */
+static void* map_stack(size_t size)
+{
+    // MAP_NORESERVE：未触及的栈页不计入提交内存
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+/**
+ * @brief 获取栈映射，优先使用当前线程缓存的映射
+ * @param size 映射长度（mapping_size()的结果）
+ * @return 失败返回nullptr
+ */
+static void* acquire_mapping(size_t size)
+{
+    if(size == s_default_mapping_size && !t_stack_cache_closed && !t_stack_cache.stacks.empty())
+    {
+        void* p = t_stack_cache.stacks.back();
+        t_stack_cache.stacks.pop_back();
+        return p;
+    }
+    return map_stack(size);
+}
+
+/**
+ * @brief 释放栈映射，缓存未满时放回当前线程的缓存
+ * @param p 映射首地址
+ * @param size 映射长度
+ */
+static void release_mapping(void* p, size_t size)
+{
+    if(size == s_default_mapping_size && !t_stack_cache_closed &&
+       t_stack_cache.stacks.size() < s_stack_cache_size.load(std::memory_order_relaxed))
+    {
+        t_stack_cache.stacks.push_back(p);
+        return;
+    }
+    munmap(p, size);
+}
+
+/**
+ * @brief Create()使用的分配器：把shared_ptr控制块（内含协程对象）放在栈映射顶端
+ * @details 分配器保存映射地址和长度，随控制块一起存放；控制块释放时整个映射随之释放
+ */
+template <class T>
+struct FiberMappingAllocator
+{
+    typedef T value_type;
+
+    void* mapping;   // 映射首地址
+    size_t size;     // 映射长度
+
+    FiberMappingAllocator(void* m, size_t s): mapping(m), size(s) {}
+
+    template <class U>
+    FiberMappingAllocator(const FiberMappingAllocator<U>& other): mapping(other.mapping), size(other.size) {}
+
+    T* allocate(size_t n)
+    {
+        static_assert(sizeof(T) <= s_control_reserve, "fiber control block does not fit the reserved space");
+        assert(n == 1);
+        (void)n;
+        return reinterpret_cast<T*>((char*)mapping + size - s_control_reserve);
+    }
+
+    void deallocate(T*, size_t)
+    {
+        release_mapping(mapping, size);
+    }
+
+    template <class U>
+    bool operator==(const FiberMappingAllocator<U>& other) const {return mapping == other.mapping;}
+
+    template <class U>
+    bool operator!=(const FiberMappingAllocator<U>& other) const {return mapping != other.mapping;}
+};
+
+#ifndef MYCOROUTINE_FIBER_UCONTEXT
+/**
+ * @brief 切换上下文
+ * @param from_sp 输出当前上下文的栈指针
+ * @param to_sp 目标上下文的栈指针
+ * @details 按System V调用约定只需保存被调用者保存的寄存器：rbx、rbp、r12-r15，
+ *          以及MXCSR和x87控制字；它们压在当前栈上，栈指针写入*from_sp。
+ *          不保存信号掩码，因此没有swapcontext的sigprocmask系统调用
+ */
+extern "C" void mycoroutine_switch_context(void** from_sp, void* to_sp);
+
+__asm__(
+    ".pushsection .text\n"
+    ".globl mycoroutine_switch_context\n"
+    ".hidden mycoroutine_switch_context\n"
+    ".type mycoroutine_switch_context,@function\n"
+    ".p2align 4\n"
+    "mycoroutine_switch_context:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r15\n"
+    "    pushq %r14\n"
+    "    pushq %r13\n"
+    "    pushq %r12\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r12\n"
+    "    popq %r13\n"
+    "    popq %r14\n"
+    "    popq %r15\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size mycoroutine_switch_context,.-mycoroutine_switch_context\n"
+    ".popsection\n"
+);
+#endif
+
 /**
  * @brief 设置当前正在运行的协程
  * @param f 要设置为当前运行的协程指针
@@ -80,6 +262,72 @@ uint64_t Fiber::GetFiberId()
     return (uint64_t)-1;
 }
 
+/**
+ * @brief 设置每个线程最多缓存的空闲协程栈数量
+ * @param count 缓存数量
+ */
+void Fiber::SetStackCacheSize(size_t count)
+{
+    s_stack_cache_size = count;
+}
+
+/**
+ * @brief 获取每个线程最多缓存的空闲协程栈数量
+ */
+size_t Fiber::GetStackCacheSize()
+{
+    return s_stack_cache_size.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief 在当前线程预先分配并触页若干协程栈
+ * @param count 栈数量
+ * @return 当前线程缓存的栈数量
+ */
+size_t Fiber::PrefaultStacks(size_t count)
+{
+    size_t limit = std::min(count, s_stack_cache_size.load(std::memory_order_relaxed));
+    long page = sysconf(_SC_PAGESIZE);
+    while(t_stack_cache.stacks.size() < limit)
+    {
+        char* p = (char*)map_stack(s_default_mapping_size);
+        if(!p)
+        {
+            break;
+        }
+        for(size_t off = 0; off < s_default_mapping_size; off += page)
+        {
+            p[off] = 0;
+        }
+        t_stack_cache.stacks.push_back(p);
+    }
+    return t_stack_cache.stacks.size();
+}
+
+/**
+ * @brief 获取当前线程缓存的空闲协程栈数量
+ */
+size_t Fiber::GetCachedStackCount()
+{
+    return t_stack_cache.stacks.size();
+}
+
+/**
+ * @brief 释放当前线程缓存的所有空闲协程栈
+ * @return 释放的栈数量
+ */
+size_t Fiber::TrimStackCache()
+{
+    size_t count = t_stack_cache.stacks.size();
+    for(void* p : t_stack_cache.stacks)
+    {
+        munmap(p, s_default_mapping_size);
+    }
+    t_stack_cache.stacks.clear();
+    t_stack_cache.stacks.shrink_to_fit();
+    return count;
+}
+
 /**
  * @brief 主协程构造函数（私有）
  * @details 仅由GetThis()调用，创建线程的第一个协程
@@ -93,12 +341,15 @@ Fiber::Fiber()
     // 主协程创建时处于运行状态
     m_state = RUNNING;
     
+#ifdef MYCOROUTINE_FIBER_UCONTEXT
     // 获取当前上下文
     if(getcontext(&m_ctx))
     {
         std::cerr << "Fiber() failed\n";
         pthread_exit(NULL);
     }
+#endif
+    // 主协程的栈指针在第一次切换出去时保存
     
     // 分配唯一ID并增加协程计数
     m_id = s_fiber_id++;
@@ -116,29 +367,21 @@ Fiber::Fiber()
  * @details 创建一个新的协程，分配栈空间并设置上下文
  */
 Fiber::Fiber(std::function<void()> cb, size_t stacksize, bool run_in_scheduler):
-    m_cb(cb), m_runInScheduler(run_in_scheduler)
+    m_runInScheduler(run_in_scheduler), m_ownsStack(true), m_cb(cb)
 {
     // 初始状态为就绪态
     m_state = READY;
 
-    // 分配协程栈空间，默认128KB
-    m_stacksize = stacksize ? stacksize : 128000;
-    m_stack = malloc(m_stacksize);
-
-    // 获取当前上下文作为基础
-    if(getcontext(&m_ctx))
+    // 分配协程栈映射，默认128KB；整个映射都用作栈
+    m_stacksize = mapping_size(stacksize ? stacksize : s_default_stack_size);
+    m_stack = acquire_mapping(m_stacksize);
+    if(!m_stack)
     {
-        std::cerr << "Fiber(std::function<void()> cb, size_t stacksize, bool run_in_scheduler) failed\n";
-        pthread_exit(NULL);
+        throw std::bad_alloc();
     }
-    
-    // 设置上下文属性
-    m_ctx.uc_link = nullptr;       // 协程结束时不自动切换到其他协程
-    m_ctx.uc_stack.ss_sp = m_stack; // 设置栈指针
-    m_ctx.uc_stack.ss_size = m_stacksize; // 设置栈大小
-    
-    // 创建协程上下文，设置入口函数为MainFunc
-    makecontext(&m_ctx, &Fiber::MainFunc, 0);
+
+    // 设置上下文，入口函数为MainFunc
+    initContext();
     
     // 分配唯一ID并增加协程计数
     m_id = s_fiber_id++;
@@ -148,6 +391,105 @@ Fiber::Fiber(std::function<void()> cb, size_t stacksize, bool run_in_scheduler):
         std::cout << "Fiber(): child id = " << m_id << std::endl;
 }
 
+/**
+ * @brief 子协程构造函数（通过Create创建）
+ * @param stack 栈底地址
+ * @param stacksize 栈大小
+ * @param cb 协程要执行的回调函数
+ * @param run_in_scheduler 是否在调度器中运行
+ * @details 栈属于控制块所在的映射，由控制块的分配器释放
+ */
+Fiber::Fiber(const MappingTag&, void* stack, size_t stacksize, std::function<void()> cb, bool run_in_scheduler):
+    m_runInScheduler(run_in_scheduler), m_stacksize(stacksize), m_stack(stack), m_cb(std::move(cb))
+{
+    m_state = READY;
+    initContext();
+
+    m_id = s_fiber_id++;
+    s_fiber_count++;
+    
+    if(debug) 
+        std::cout << "Fiber(): child id = " << m_id << std::endl;
+}
+
+/**
+ * @brief 创建子协程，栈、协程对象和控制块共用一个映射
+ * @param cb 协程要执行的回调函数
+ * @param stacksize 协程栈大小
+ * @param run_in_scheduler 是否在调度器中运行
+ * @return 协程智能指针
+ */
+std::shared_ptr<Fiber> Fiber::Create(std::function<void()> cb, size_t stacksize, bool run_in_scheduler)
+{
+    size_t size = mapping_size(stacksize ? stacksize : s_default_stack_size);
+    void* mapping = acquire_mapping(size);
+    if(!mapping)
+    {
+        throw std::bad_alloc();
+    }
+    // 控制块占据映射顶端的预留空间，其下方整段都是栈；构造失败时分配器归还映射
+    return std::allocate_shared<Fiber>(FiberMappingAllocator<Fiber>(mapping, size), MappingTag(),
+                                       mapping, size - s_control_reserve, std::move(cb), run_in_scheduler);
+}
+
+/**
+ * @brief 在栈上构造初始上下文
+ * @details x86-64上按mycoroutine_switch_context的出栈顺序布置初始帧：
+ *          MXCSR/x87控制字、6个寄存器、返回地址MainFunc，再留一个空的返回地址，
+ *          使进入MainFunc时的栈指针与正常调用一样满足 rsp % 16 == 8
+ */
+void Fiber::initContext()
+{
+#if defined(__SANITIZE_ADDRESS__)
+    // 结束的协程停在yield()中，栈帧的红区标记不会被清除；复用栈（reset或栈缓存）前整体清除
+    ASAN_UNPOISON_MEMORY_REGION(m_stack, m_stacksize);
+#endif
+#ifdef MYCOROUTINE_FIBER_UCONTEXT
+    // 获取当前上下文作为基础
+    if(getcontext(&m_ctx))
+    {
+        std::cerr << "Fiber::initContext() failed\n";
+        pthread_exit(NULL);
+    }
+    m_ctx.uc_link = nullptr;              // 协程结束时不自动切换到其他协程
+    m_ctx.uc_stack.ss_sp = m_stack;       // 设置栈指针
+    m_ctx.uc_stack.ss_size = m_stacksize; // 设置栈大小
+    makecontext(&m_ctx, &Fiber::MainFunc, 0);
+#else
+    uintptr_t top = ((uintptr_t)m_stack + m_stacksize) & ~(uintptr_t)15;
+    void** sp = (void**)top;
+    *--sp = nullptr;                          // MainFunc的返回地址（MainFunc不会返回）
+    *--sp = (void*)&Fiber::MainFunc;          // 首次切换时ret到MainFunc
+    for(int i = 0; i < 6; ++i)
+    {
+        *--sp = nullptr;                      // rbp、rbx、r15、r14、r13、r12
+    }
+    // 继承当前线程的浮点控制状态：低4字节MXCSR，其后2字节x87控制字
+    uint32_t mxcsr = 0;
+    uint16_t fpucw = 0;
+    __asm__ volatile("stmxcsr %0" : "=m"(mxcsr));
+    __asm__ volatile("fnstcw %0" : "=m"(fpucw));
+    *--sp = (void*)(uintptr_t)(mxcsr | ((uint64_t)fpucw << 32));
+    m_sp = sp;
+#endif
+}
+
+/**
+ * @brief 保存当前上下文到from并切换到to
+ */
+void Fiber::SwitchContext(Fiber* from, Fiber* to)
+{
+#ifdef MYCOROUTINE_FIBER_UCONTEXT
+    if(swapcontext(&from->m_ctx, &to->m_ctx))
+    {
+        std::cerr << "Fiber::SwitchContext() failed\n";
+        pthread_exit(NULL);
+    }
+#else
+    mycoroutine_switch_context(&from->m_sp, to->m_sp);
+#endif
+}
+
 /**
  * @brief 协程析构函数
  * @details 减少协程计数并释放栈空间
@@ -155,10 +497,10 @@ Fiber::Fiber(std::function<void()> cb, size_t stacksize, bool run_in_scheduler):
 Fiber::~Fiber()
 {
     s_fiber_count--;
-    // 如果有分配栈空间则释放
-    if(m_stack)
+    // 自己分配的栈映射在此释放（或放回栈缓存），Create()创建的由控制块释放
+    if(m_stack && m_ownsStack)
     {
-        free(m_stack);
+        release_mapping(m_stack, m_stacksize);
     }
     
     if(debug) 
@@ -180,18 +522,8 @@ void Fiber::reset(std::function<void()> cb)
     m_state = READY;
     m_cb = cb;
 
-    // 重新获取上下文
-    if(getcontext(&m_ctx))
-    {
-        std::cerr << "reset() failed\n";
-        pthread_exit(NULL);
-    }
-
-    // 重新设置上下文属性
-    m_ctx.uc_link = nullptr;
-    m_ctx.uc_stack.ss_sp = m_stack;
-    m_ctx.uc_stack.ss_size = m_stacksize;
-    makecontext(&m_ctx, &Fiber::MainFunc, 0);
+    // 重新设置上下文
+    initContext();
 }
 
 /**
@@ -211,21 +543,13 @@ void Fiber::resume()
     {
         // 如果协程在调度器中运行，则切换到调度协程
         SetThis(this);
-        if(swapcontext(&(t_scheduler_fiber->m_ctx), &m_ctx))
-        {
-            std::cerr << "resume() to t_scheduler_fiber failed\n";
-            pthread_exit(NULL);
-        }
+        SwitchContext(t_scheduler_fiber, this);
     }
     else
     {
         // 如果协程不在调度器中运行，则切换到主协程
         SetThis(this);
-        if(swapcontext(&(t_thread_fiber->m_ctx), &m_ctx))
-        {
-            std::cerr << "resume() to t_thread_fiber failed\n";
-            pthread_exit(NULL);
-        }
+        SwitchContext(t_thread_fiber.get(), this);
     }
 }
 
@@ -249,21 +573,13 @@ void Fiber::yield()
     {
         // 如果协程在调度器中运行，则切换回调度协程
         SetThis(t_scheduler_fiber);
-        if(swapcontext(&m_ctx, &(t_scheduler_fiber->m_ctx)))
-        {
-            std::cerr << "yield() to to t_scheduler_fiber failed\n";
-            pthread_exit(NULL);
-        }
+        SwitchContext(this, t_scheduler_fiber);
     }
     else
     {
         // 如果协程不在调度器中运行，则切换回主协程
         SetThis(t_thread_fiber.get());
-        if(swapcontext(&m_ctx, &(t_thread_fiber->m_ctx)))
-        {
-            std::cerr << "yield() to t_thread_fiber failed\n";
-            pthread_exit(NULL);
-        }
+        SwitchContext(this, t_thread_fiber.get());
     }
 }
 
@@ -0,0 +1,149 @@
+#include <mycoroutine/fiber_sync.h>  // 协程同步原语头文件
+#include <mycoroutine/iomanager.h>   // IO管理器（提供超时定时器）
+
+#include <algorithm>   // std::find
+
+namespace mycoroutine {
+
+/**
+ * @brief 唤醒一个等待者
+ * @param waiter 等待者
+ * @param timedout 是否由超时定时器唤醒
+ * @return 若该等待者此前尚未被唤醒则返回true
+ * @details 通过woken标志保证notify与超时定时器之间只有一方能调度该协程
+ */
+bool FiberCondition::wake(const std::shared_ptr<Waiter>& waiter, bool timedout)
+{
+    if(waiter->woken.exchange(true))
+    {
+        return false;
+    }
+    waiter->timedout = timedout;
+    waiter->scheduler->scheduleLock(waiter->fiber);
+    return true;
+}
+
+/**
+ * @brief 为当前协程创建等待者信息
+ * @return 等待者信息
+ */
+std::shared_ptr<FiberCondition::Waiter> FiberCondition::newWaiter()
+{
+    std::shared_ptr<Waiter> waiter = std::make_shared<Waiter>();
+    waiter->scheduler = Scheduler::GetThis();
+    waiter->fiber = Fiber::GetThis();
+    assert(waiter->scheduler != nullptr);
+    return waiter;
+}
+
+/**
+ * @brief 将当前协程加入等待队列并让出执行权
+ * @param lock 调用者持有的锁
+ * @param waiter 当前协程的等待者信息
+ * @details 入队后才释放调用者的锁，因此不会丢失唤醒。
+ *          如果在yield之前就被其他线程调度，调度器会在Fiber::m_mutex上等待本次yield完成
+ */
+void FiberCondition::suspend(std::unique_lock<std::mutex>& lock, const std::shared_ptr<Waiter>& waiter)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_waiters.push_back(waiter);
+    }
+
+    lock.unlock();
+    // 让出执行权，等待notify或超时重新调度
+    Fiber::GetThis()->yield();
+    lock.lock();
+}
+
+/**
+ * @brief 挂起当前协程直到被唤醒
+ * @param lock 调用者持有的锁
+ */
+void FiberCondition::wait(std::unique_lock<std::mutex>& lock)
+{
+    std::shared_ptr<Waiter> waiter = newWaiter();
+    suspend(lock, waiter);
+}
+
+/**
+ * @brief 带超时的等待
+ * @param lock 调用者持有的锁
+ * @param timeout_ms 超时时间（毫秒）
+ * @return 被唤醒返回true，超时返回false
+ */
+bool FiberCondition::waitFor(std::unique_lock<std::mutex>& lock, uint64_t timeout_ms)
+{
+    if(timeout_ms == (uint64_t)-1)
+    {
+        wait(lock);
+        return true;
+    }
+
+    IOManager* iom = IOManager::GetThis();
+    assert(iom != nullptr);
+
+    std::shared_ptr<Waiter> waiter = newWaiter();
+    std::weak_ptr<Waiter> wwaiter(waiter);
+    // 超时回调只访问等待者本身，不访问条件变量对象
+    std::shared_ptr<Timer> timer = iom->addTimer(timeout_ms, [wwaiter]()
+    {
+        std::shared_ptr<Waiter> w = wwaiter.lock();
+        if(w)
+        {
+            wake(w, true);
+        }
+    });
+
+    suspend(lock, waiter);
+    timer->cancel();
+
+    if(waiter->timedout)
+    {
+        // 超时唤醒：自己从等待队列中移除，notify路径不会再看到它
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto it = std::find(m_waiters.begin(), m_waiters.end(), waiter);
+        if(it != m_waiters.end())
+        {
+            m_waiters.erase(it);
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 唤醒一个等待的协程
+ * @details 跳过已经因超时被唤醒的等待者
+ */
+void FiberCondition::notifyOne()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    while(!m_waiters.empty())
+    {
+        std::shared_ptr<Waiter> waiter = m_waiters.front();
+        m_waiters.pop_front();
+        if(wake(waiter))
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief 唤醒所有等待的协程
+ */
+void FiberCondition::notifyAll()
+{
+    std::list<std::shared_ptr<Waiter>> waiters;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        waiters.swap(m_waiters);
+    }
+    for(auto& waiter : waiters)
+    {
+        wake(waiter);
+    }
+}
+
+} // end namespace mycoroutine
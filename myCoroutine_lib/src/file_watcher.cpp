@@ -0,0 +1,325 @@
+#include <mycoroutine/file_watcher.h>  // 文件变更监视头文件
+#include <mycoroutine/hook.h>          // 原始系统调用
+#include <mycoroutine/utils.h>         // steady_ms
+
+#include <unistd.h>        // close
+#include <errno.h>         // errno
+#include <algorithm>       // std::find
+
+namespace mycoroutine {
+
+// 单次read()的缓冲区大小，足以容纳数百个事件
+static const size_t kEventBufferSize = 64 * 1024;
+
+/**
+ * @brief 构造函数
+ */
+FileWatcher::Watch::Watch(const std::string& path, uint32_t mask, Callback cb):
+    m_path(path), m_mask(mask), m_cb(std::move(cb))
+{
+}
+
+/**
+ * @brief 代数加一并唤醒等待者
+ * @param active 之后订阅是否仍然有效
+ */
+void FileWatcher::Watch::bump(bool active)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_generation.fetch_add(1, std::memory_order_release);
+    if(!active)
+    {
+        m_active = false;
+    }
+    m_cond.notifyAll();
+}
+
+/**
+ * @brief 挂起当前协程直到代数不等于seen
+ * @param seen 调用者已经处理过的代数
+ * @param timeout_ms 超时时间（毫秒）
+ * @return 代数已变化返回true，超时或订阅已失效返回false
+ */
+bool FileWatcher::Watch::waitChange(uint64_t seen, uint64_t timeout_ms)
+{
+    uint64_t deadline = timeout_ms == (uint64_t)-1 ? (uint64_t)-1 : steady_ms() + timeout_ms;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_generation.load(std::memory_order_relaxed) == seen && m_active)
+    {
+        uint64_t now = steady_ms();
+        if(now >= deadline)
+        {
+            return false;
+        }
+        m_cond.waitFor(lock, deadline == (uint64_t)-1 ? (uint64_t)-1 : deadline - now);
+    }
+    return m_generation.load(std::memory_order_relaxed) != seen;
+}
+
+/**
+ * @brief 创建监视器并在IOManager中注册inotify fd
+ * @param iom IO管理器
+ * @return 成功返回监视器，失败返回nullptr
+ */
+std::shared_ptr<FileWatcher> FileWatcher::Create(IOManager* iom)
+{
+    if(!iom)
+    {
+        errno = EINVAL;
+        return nullptr;
+    }
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<FileWatcher> watcher = std::make_shared<FileWatcher>(fd, iom);
+    // 回调持有监视器的引用，stop()取消事件后引用随之释放
+    if(iom->addEvent(fd, IOManager::READ, std::bind(&FileWatcher::onReadable, watcher)))
+    {
+        return nullptr;
+    }
+    return watcher;
+}
+
+/**
+ * @brief 构造函数
+ */
+FileWatcher::FileWatcher(int fd, IOManager* iom):
+    m_fd(fd), m_iom(iom)
+{
+}
+
+/**
+ * @brief 析构函数，关闭inotify fd
+ */
+FileWatcher::~FileWatcher()
+{
+    close(m_fd);
+}
+
+/**
+ * @brief 订阅文件或目录
+ * @param path 路径
+ * @param mask 关注的事件
+ * @param cb 批量事件回调
+ * @return 成功返回订阅，失败返回nullptr
+ */
+std::shared_ptr<FileWatcher::Watch> FileWatcher::watch(const std::string& path, uint32_t mask, Callback cb)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_stopping)
+    {
+        errno = ECANCELED;
+        return nullptr;
+    }
+
+    // 同一inode可能被多次订阅（例如不同路径指向同一文件），IN_MASK_ADD合并内核侧掩码，各订阅再按自己的掩码过滤
+    int wd = inotify_add_watch(m_fd, path.c_str(), mask | IN_MASK_ADD);
+    if(wd < 0)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<Watch> w = std::make_shared<Watch>(path, mask, std::move(cb));
+    w->m_wd = wd;
+    m_watches[wd].push_back(w);
+    return w;
+}
+
+/**
+ * @brief 取消订阅
+ * @param watch 订阅
+ */
+void FileWatcher::unwatch(const std::shared_ptr<Watch>& watch)
+{
+    if(!watch)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_watches.find(watch->m_wd);
+        if(it != m_watches.end())
+        {
+            std::vector<std::shared_ptr<Watch>>& list = it->second;
+            auto pos = std::find(list.begin(), list.end(), watch);
+            if(pos != list.end())
+            {
+                list.erase(pos);
+                if(list.empty())
+                {
+                    // 之后到达的IN_IGNORED找不到订阅，直接丢弃
+                    inotify_rm_watch(m_fd, it->first);
+                    m_watches.erase(it);
+                }
+            }
+        }
+    }
+    watch->bump(false);
+}
+
+/**
+ * @brief 取消inotify fd上的READ事件，所有订阅失效
+ */
+void FileWatcher::stop()
+{
+    std::map<int, std::vector<std::shared_ptr<Watch>>> watches;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_stopping)
+        {
+            return;
+        }
+        m_stopping = true;
+        watches.swap(m_watches);
+    }
+
+    // onReadable()只在m_stopping为false时重新注册，所以这里取消后不会再有新的注册
+    m_iom->cancelEvent(m_fd, IOManager::READ);
+    for(auto& entry : watches)
+    {
+        for(auto& w : entry.second)
+        {
+            w->bump(false);
+        }
+    }
+}
+
+/**
+ * @brief inotify fd可读时的回调：读空事件队列，投递后重新注册READ事件
+ */
+void FileWatcher::onReadable()
+{
+    // inotify_event包含int和uint32_t成员，缓冲区需要按其对齐
+    alignas(struct inotify_event) static thread_local char buf[kEventBufferSize];
+    while(true)
+    {
+        ssize_t n = read_f(m_fd, buf, sizeof(buf));
+        if(n > 0)
+        {
+            dispatch(buf, n);
+            continue;
+        }
+        if(n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        break;
+    }
+
+    // 边缘触发：队列已读空，重新注册等待下一批事件
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_stopping)
+    {
+        m_iom->addEvent(m_fd, IOManager::READ, std::bind(&FileWatcher::onReadable, shared_from_this()));
+    }
+}
+
+/**
+ * @brief 解析一次read()读到的事件并投递
+ * @param buf 事件数据
+ * @param len 数据长度
+ */
+void FileWatcher::dispatch(const char* buf, size_t len)
+{
+    // 一批事件涉及的订阅通常很少，线性查找即可
+    struct Batch
+    {
+        std::shared_ptr<Watch> watch;
+        std::vector<FileEvent> events;
+        bool active;
+    };
+    std::vector<Batch> batches;
+
+    auto batch_of = [&batches](const std::shared_ptr<Watch>& w) -> Batch&
+    {
+        for(Batch& b : batches)
+        {
+            if(b.watch == w)
+            {
+                return b;
+            }
+        }
+        batches.push_back({w, {}, true});
+        return batches.back();
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(size_t off = 0; off < len; )
+        {
+            const struct inotify_event* ev = (const struct inotify_event*)(buf + off);
+            off += sizeof(struct inotify_event) + ev->len;
+
+            // 1 队列溢出：丢失的事件无法恢复，所有订阅都视为已变化
+            if(ev->mask & IN_Q_OVERFLOW)
+            {
+                for(auto& entry : m_watches)
+                {
+                    for(auto& w : entry.second)
+                    {
+                        batch_of(w).events.push_back({w->m_path, "", IN_Q_OVERFLOW});
+                    }
+                }
+                continue;
+            }
+
+            auto it = m_watches.find(ev->wd);
+            if(it == m_watches.end())
+            {
+                continue;
+            }
+
+            // 2 按订阅过滤并去重：同一批内相同文件的相同事件（例如连续的IN_MODIFY）只投递一次
+            std::string name = ev->len ? std::string(ev->name) : std::string();
+            for(auto& w : it->second)
+            {
+                uint32_t mask = ev->mask & (w->m_mask | IN_IGNORED);
+                if(!mask)
+                {
+                    continue;
+                }
+                Batch& b = batch_of(w);
+                if(ev->mask & IN_IGNORED)
+                {
+                    b.active = false;
+                }
+                bool dup = false;
+                for(const FileEvent& e : b.events)
+                {
+                    if(e.mask == mask && e.name == name)
+                    {
+                        dup = true;
+                        break;
+                    }
+                }
+                if(!dup)
+                {
+                    b.events.push_back({w->m_path, name, mask});
+                }
+            }
+
+            // 3 内核已移除监视（对象被删除、所在文件系统卸载等），订阅随之失效
+            if(ev->mask & IN_IGNORED)
+            {
+                m_watches.erase(it);
+            }
+        }
+    }
+
+    // 4 在锁外递增代数并调度回调
+    for(Batch& b : batches)
+    {
+        b.watch->bump(b.active);
+        if(b.watch->m_cb)
+        {
+            m_iom->scheduleLock(std::bind(b.watch->m_cb, std::move(b.events)));
+        }
+    }
+}
+
+} // end namespace mycoroutine
@@ -0,0 +1,217 @@
+#include <mycoroutine/histogram.h>  // 延迟直方图头文件
+#include <mycoroutine/utils.h>      // steady_ms
+
+namespace mycoroutine {
+
+/**
+ * @brief 构造函数，所有计数清零
+ */
+Histogram::Histogram()
+{
+    reset();
+}
+
+/**
+ * @brief 计算样本所在桶的下标
+ * @param value 样本值
+ * @return 桶下标
+ */
+size_t Histogram::bucketIndex(uint64_t value)
+{
+    if(value < kLinearBuckets)
+    {
+        return value;
+    }
+    // 最高位所在的位置（>=4），以及其后3位作为子桶号
+    size_t msb = 63 - __builtin_clzll(value);
+    size_t sub = (value >> (msb - 3)) & (kSubBuckets - 1);
+    return kLinearBuckets + (msb - 4) * kSubBuckets + sub;
+}
+
+/**
+ * @brief 计算桶的上界
+ * @param index 桶下标
+ * @return 该桶能容纳的最大值
+ */
+uint64_t Histogram::bucketUpper(size_t index)
+{
+    if(index < kLinearBuckets)
+    {
+        return index;
+    }
+    size_t msb = (index - kLinearBuckets) / kSubBuckets + 4;
+    size_t sub = (index - kLinearBuckets) % kSubBuckets;
+    uint64_t lower = (uint64_t)(kSubBuckets + sub) << (msb - 3);
+    return lower + ((uint64_t)1 << (msb - 3)) - 1;
+}
+
+/**
+ * @brief 记录一个样本
+ * @param value 样本值
+ */
+void Histogram::record(uint64_t value)
+{
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t cur = m_max.load(std::memory_order_relaxed);
+    while(value > cur && !m_max.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * @brief 合并另一个直方图的样本
+ * @param other 另一个直方图
+ */
+void Histogram::merge(const Histogram& other)
+{
+    for(size_t i = 0; i < kBuckets; ++i)
+    {
+        uint64_t n = other.m_buckets[i].load(std::memory_order_relaxed);
+        if(n)
+        {
+            m_buckets[i].fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+    m_count.fetch_add(other.m_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    uint64_t value = other.max();
+    uint64_t cur = m_max.load(std::memory_order_relaxed);
+    while(value > cur && !m_max.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * @brief 清空所有样本
+ */
+void Histogram::reset()
+{
+    for(size_t i = 0; i < kBuckets; ++i)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 获取样本平均值
+ */
+double Histogram::mean() const
+{
+    uint64_t n = count();
+    return n ? (double)m_sum.load(std::memory_order_relaxed) / n : 0.0;
+}
+
+/**
+ * @brief 获取分位数
+ * @param p 分位（0~100）
+ * @return 分位数所在桶的上界（不超过最大值），没有样本时返回0
+ */
+uint64_t Histogram::percentile(double p) const
+{
+    uint64_t total = count();
+    if(total == 0)
+    {
+        return 0;
+    }
+
+    uint64_t target = (uint64_t)(total * p / 100.0 + 0.5);
+    if(target == 0)
+    {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for(size_t i = 0; i < kBuckets; ++i)
+    {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if(seen >= target)
+        {
+            uint64_t upper = bucketUpper(i);
+            uint64_t maxv = max();
+            return upper < maxv ? upper : maxv;
+        }
+    }
+    return max();
+}
+
+/**
+ * @brief 构造函数
+ * @param slots 时间片数量
+ * @param slot_ms 每个时间片的长度（毫秒）
+ */
+RollingHistogram::RollingHistogram(size_t slots, uint64_t slot_ms):
+    m_slots(new Slot[slots ? slots : 1]), m_slotCount(slots ? slots : 1), m_slotMs(slot_ms ? slot_ms : 1)
+{
+}
+
+/**
+ * @brief 获取当前时间片编号
+ * @details 编号从1开始，0表示时间片从未使用
+ */
+uint64_t RollingHistogram::currentEpoch() const
+{
+    return steady_ms() / m_slotMs + 1;
+}
+
+/**
+ * @brief 记录一个样本到当前时间片
+ * @param value 样本值
+ */
+void RollingHistogram::record(uint64_t value)
+{
+    uint64_t epoch = currentEpoch();
+    Slot& slot = m_slots[epoch % m_slotCount];
+
+    uint64_t old = slot.epoch.load(std::memory_order_acquire);
+    if(old != epoch)
+    {
+        // 时间片已过期：抢到切换权的线程负责清空旧数据
+        if(old < epoch && slot.epoch.compare_exchange_strong(old, epoch, std::memory_order_acq_rel))
+        {
+            slot.hist.reset();
+        }
+        else if(old > epoch)
+        {
+            return;
+        }
+    }
+    slot.hist.record(value);
+}
+
+/**
+ * @brief 把窗口内的样本合并到out中
+ * @param out 输出直方图
+ */
+void RollingHistogram::snapshot(Histogram& out) const
+{
+    uint64_t epoch = currentEpoch();
+    for(size_t i = 0; i < m_slotCount; ++i)
+    {
+        uint64_t e = m_slots[i].epoch.load(std::memory_order_acquire);
+        if(e != 0 && e <= epoch && epoch - e < m_slotCount)
+        {
+            out.merge(m_slots[i].hist);
+        }
+    }
+}
+
+/**
+ * @brief 清空所有样本
+ */
+void RollingHistogram::reset()
+{
+    for(size_t i = 0; i < m_slotCount; ++i)
+    {
+        m_slots[i].epoch.store(0, std::memory_order_relaxed);
+        m_slots[i].hist.reset();
+    }
+}
+
+} // end namespace mycoroutine
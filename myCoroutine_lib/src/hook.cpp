@@ -4,7 +4,16 @@
 #include <iostream>        // 标准输入输出
 #include <cstdarg>         // 可变参数支持
 #include <mycoroutine/fd_manager.h>    // 引入文件描述符管理器
+#include <mycoroutine/utils.h>         // steady_ms
+#include <mycoroutine/epoch.h>         // 借用FdCtx的纪元临界区
 #include <string.h>        // 字符串处理函数
+#include <netinet/in.h>    // IPPROTO_TCP
+#include <netinet/tcp.h>   // TCP_NODELAY、TCP_FASTOPEN等选项
+#include <linux/net_tstamp.h> // SOF_TIMESTAMPING_*标志
+#include <time.h>          // clock_gettime
+#include <vector>          // connect_any的候选地址
+#include <mutex>           // connect_any的共享状态
+#include <algorithm>       // std::min
 
 // 宏定义：对所有需要hook的函数应用同一个操作
 #define HOOK_FUN(XX) \
@@ -14,6 +23,7 @@
     XX(socket) \
     XX(connect) \
     XX(accept) \
+    XX(accept4) \
     XX(read) \
     XX(readv) \
     XX(recv) \
@@ -93,17 +103,50 @@ static HookIniter s_hook_initer;
 } // end namespace mycoroutine
 
 /**
- * @brief 定时器信息结构体
- * @details 用于跟踪定时器状态，主要用于IO操作超时控制
+ * @brief 文件描述符上下文的快照
+ * @details do_io在纪元临界区内从借用的FdCtx复制出需要的字段，之后的系统调用和协程挂起都不再访问FdCtx
  */
-struct timer_info 
+struct io_fd_state
 {
-    int cancelled = 0;  // 取消状态，0表示未取消，其他值表示取消原因（如ETIMEDOUT）
+    bool managed = false;   // 是否需要由协程调度处理EAGAIN
+    bool closed = false;    // 是否已关闭
+    uint64_t timeout = (uint64_t)-1; // 超时时间（毫秒）
 };
 
+/**
+ * @brief 查询文件描述符的IO处理方式
+ * @param fd 文件描述符
+ * @param timeout_so 超时选项类型
+ * @return 上下文快照；没有上下文、非套接字或用户设置为非阻塞时managed为false
+ * @details 借用FdManager中的上下文指针，不加锁也不增加引用计数；调度线程上EpochGuard不做任何事
+ */
+static io_fd_state load_fd_state(int fd, int timeout_so)
+{
+    io_fd_state state;
+    mycoroutine::EpochGuard guard;
+    mycoroutine::FdCtx* ctx = mycoroutine::FdMgr::GetInstance()->lookup(fd);
+    if(!ctx)
+    {
+        return state;
+    }
+    if(ctx->isClosed())
+    {
+        state.closed = true;
+        return state;
+    }
+    if(ctx->isSocket() && !ctx->getUserNonblock())
+    {
+        state.managed = true;
+        state.timeout = ctx->getTimeout(timeout_so);
+    }
+    return state;
+}
+
 /**
  * @brief 通用IO操作模板函数
- * @details 处理所有IO相关系统调用的协程调度逻辑
+ * @details 处理所有IO相关系统调用的协程调度逻辑。数据已就绪时的开销只有一次线程局部变量检查、
+ *          一次无锁的上下文查找和原始系统调用本身；只有返回EAGAIN时才获取IO管理器、
+ *          注册事件并分配超时状态（由IOManager::waitEvent完成）
  * @tparam OriginFun 原始系统调用函数类型
  * @tparam Args 可变参数类型
  * @param fd 文件描述符
@@ -123,107 +166,145 @@ static ssize_t do_io(int fd, OriginFun fun, const char* hook_fun_name, uint32_t
         return fun(fd, std::forward<Args>(args)...);
     }
 
-    // 获取文件描述符上下文
-    std::shared_ptr<mycoroutine::FdCtx> ctx = mycoroutine::FdMgr::GetInstance()->get(fd);
-    if(!ctx) 
-    {
-        // 如果没有上下文，直接调用原始函数
-        return fun(fd, std::forward<Args>(args)...);
-    }
-
-    // 检查文件描述符是否已关闭
-    if(ctx->isClosed()) 
+    // 获取文件描述符上下文的快照
+    io_fd_state state = load_fd_state(fd, timeout_so);
+    if(state.closed) 
     {
         errno = EBADF;
         return -1;
     }
 
-    // 非套接字或用户设置为非阻塞，直接调用原始函数
-    if(!ctx->isSocket() || ctx->getUserNonblock()) 
+    // 没有上下文、非套接字或用户设置为非阻塞，直接调用原始函数
+    if(!state.managed) 
     {
         return fun(fd, std::forward<Args>(args)...);
     }
 
-    // 获取超时时间
-    uint64_t timeout = ctx->getTimeout(timeout_so);
-    // 创建定时器信息
-    std::shared_ptr<timer_info> tinfo(new timer_info);
-
-retry:
-	// 尝试执行IO操作
-    ssize_t n = fun(fd, std::forward<Args>(args)...);
-    
-    // 如果被信号中断，重新尝试
-    while(n == -1 && errno == EINTR) 
-    {
-        n = fun(fd, std::forward<Args>(args)...);
-    }
-    
-    // 如果资源暂时不可用（阻塞），则进行协程调度
-    if(n == -1 && errno == EAGAIN) 
+    while(true)
     {
-        // 获取当前IO管理器
-        mycoroutine::IOManager* iom = mycoroutine::IOManager::GetThis();
-        // 定时器指针
-        std::shared_ptr<mycoroutine::Timer> timer;
-        // 弱引用，用于定时器回调中检查资源是否还存在
-        std::weak_ptr<timer_info> winfo(tinfo);
+        // 尝试执行IO操作，被信号中断时重试
+        ssize_t n;
+        do
+        {
+            n = fun(fd, std::forward<Args>(args)...);
+        } while(n == -1 && errno == EINTR);
 
-        // 如果设置了超时时间，添加条件定时器
-        if(timeout != (uint64_t)-1) 
+        // 除资源暂时不可用（阻塞）外都直接返回
+        if(n != -1 || errno != EAGAIN) 
         {
-            timer = iom->addConditionTimer(timeout, [winfo, fd, iom, event]() 
-            {
-                auto t = winfo.lock();
-                if(!t || t->cancelled) 
-                {
-                    return;
-                }
-                t->cancelled = ETIMEDOUT;  // 设置超时标志
-                // 取消事件并触发一次，使协程恢复执行
-                iom->cancelEvent(fd, (mycoroutine::IOManager::Event)(event));
-            }, winfo);
+            return n;
         }
 
-        // 添加IO事件，回调为当前协程
-        int rt = iom->addEvent(fd, (mycoroutine::IOManager::Event)(event));
-        if(rt) 
-        {   // 添加事件失败
-            std::cout << hook_fun_name << " addEvent("<< fd << ", " << event << ")";
-            if(timer) 
-            {   // 取消定时器
-                timer->cancel();
+        // 获取当前IO管理器（线程局部缓存），不在IO管理器中运行时无法挂起，按非阻塞语义返回
+        mycoroutine::IOManager* iom = mycoroutine::IOManager::GetThis();
+        if(!iom)
+        {
+            return n;
+        }
+
+        // 挂起协程等待事件就绪或超时，恢复后重新尝试IO操作
+        if(iom->waitEvent(fd, (mycoroutine::IOManager::Event)(event), state.timeout)) 
+        {
+            if(errno != ETIMEDOUT)
+            {   // 添加事件失败
+                std::cout << hook_fun_name << " addEvent("<< fd << ", " << event << ")";
             }
             return -1;
-        } 
-        else 
-        {   // 添加事件成功，让出协程执行权
-            mycoroutine::Fiber::GetThis()->yield();
-     
-            // 协程恢复，取消定时器
-            if(timer) 
-            {
-                timer->cancel();
-            }
-            
-            // 检查是否超时
-            if(tinfo->cancelled == ETIMEDOUT) 
-            {
-                errno = tinfo->cancelled;
-                return -1;
-            }
-            
-            // 重新尝试IO操作
-            goto retry;
         }
     }
-    
-    return n;  // 返回IO操作结果
 }
 
 
 
 
+/**
+ * @brief 获取当前时间（微秒，CLOCK_REALTIME，与内核软件时间戳同一时钟）
+ */
+static uint64_t realtime_us()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 计算两个时间点的差值，时钟回退时返回0
+ */
+static uint64_t elapsed_us(uint64_t from, uint64_t to)
+{
+	return to > from ? to - from : 0;
+}
+
+/**
+ * @brief 带接收延迟统计的recvmsg
+ * @details 数据未就绪时挂起协程等待READ事件，并记下协程恢复执行的时间；
+ *          接收成功后从SCM_TIMESTAMPING控制消息中取出内核软件时间戳，
+ *          结合IOManager记录的epoll就绪时间，把延迟拆分为epoll唤醒和调度排队两部分
+ * @param sockfd 套接字文件描述符
+ * @param msg 消息头结构
+ * @param flags 控制标志
+ * @param timeout 接收超时时间（毫秒）
+ * @return 成功返回接收的字节数，失败返回-1并设置errno
+ */
+static ssize_t recvmsg_timestamped(int sockfd, struct msghdr *msg, int flags, uint64_t timeout)
+{
+	mycoroutine::IOManager* iom = mycoroutine::IOManager::GetThis();
+	uint64_t ready_us = 0;    // epoll报告就绪的时间
+	uint64_t resumed_us = 0;  // 协程恢复执行的时间
+
+	ssize_t n;
+	while(true)
+	{
+		n = recvmsg_f(sockfd, msg, flags);
+		if(n >= 0 || errno != EAGAIN || !iom)
+		{
+			if(n == -1 && errno == EINTR)
+			{
+				continue;
+			}
+			break;
+		}
+		if(iom->waitEvent(sockfd, mycoroutine::IOManager::READ, timeout))
+		{
+			return -1;
+		}
+		resumed_us = realtime_us();
+		ready_us = iom->getReadReadyTime(sockfd);
+	}
+
+	if(n < 0 || !msg->msg_control || (msg->msg_flags & MSG_CTRUNC))
+	{
+		return n;
+	}
+
+	// 解析SCM_TIMESTAMPING：ts[0]为软件时间戳，ts[2]为硬件时间戳
+	for(struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg))
+	{
+		if(cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_TIMESTAMPING)
+		{
+			continue;
+		}
+		struct timespec ts[3];
+		memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));
+		uint64_t kernel_us = (uint64_t)ts[0].tv_sec * 1000000 + ts[0].tv_nsec / 1000;
+		if(kernel_us == 0)
+		{
+			break;
+		}
+
+		mycoroutine::RxLatencyStats& stats = mycoroutine::rx_latency_stats();
+		stats.total.record(elapsed_us(kernel_us, realtime_us()));
+		// 协程曾挂起且就绪时间晚于报文到达，说明正是这批数据唤醒了协程
+		if(resumed_us && ready_us >= kernel_us)
+		{
+			stats.wakeup.record(ready_us - kernel_us);
+			stats.queueing.record(elapsed_us(ready_us, resumed_us));
+		}
+		break;
+	}
+	return n;
+}
+
 extern "C"{
 
 // declaration -> sleep_fun sleep_f = nullptr;
@@ -335,7 +416,12 @@ int socket(int domain, int type, int protocol)
 		return fd;
 	}
 	// 获取并初始化文件描述符上下文
-	mycoroutine::FdMgr::GetInstance()->get(fd, true);
+	std::shared_ptr<mycoroutine::FdCtx> ctx = mycoroutine::FdMgr::GetInstance()->get(fd, true);
+	// 调用者要求非阻塞：IO返回EAGAIN而不是挂起协程
+	if(ctx && (type & SOCK_NONBLOCK))
+	{
+		ctx->setUserNonblock(true);
+	}
 	return fd;
 }
 
@@ -387,52 +473,19 @@ int connect_with_timeout(int fd, const struct sockaddr* addr, socklen_t addrlen,
         return n;
     }
 
-    // 连接进行中，等待可写事件（表示连接成功或失败）
+    // 连接进行中，挂起协程等待可写事件（表示连接成功或失败）或超时
     mycoroutine::IOManager* iom = mycoroutine::IOManager::GetThis();
-    std::shared_ptr<mycoroutine::Timer> timer;
-    std::shared_ptr<timer_info> tinfo(new timer_info);
-    std::weak_ptr<timer_info> winfo(tinfo);
-
-    // 设置超时定时器
-    if(timeout_ms != (uint64_t)-1) 
-    {
-        timer = iom->addConditionTimer(timeout_ms, [winfo, fd, iom]() 
-        {
-            auto t = winfo.lock();
-            if(!t || t->cancelled) 
-            {
-                return;
-            }
-            t->cancelled = ETIMEDOUT;
-            iom->cancelEvent(fd, mycoroutine::IOManager::WRITE);
-        }, winfo);
+    if(!iom) 
+    {   // 不在IOManager中无法挂起等待，与非阻塞套接字一样返回EINPROGRESS
+        return -1;
     }
-
-    // 添加可写事件
-    int rt = iom->addEvent(fd, mycoroutine::IOManager::WRITE);
-    if(rt == 0) 
-    {   // 事件添加成功，让出协程执行权
-        mycoroutine::Fiber::GetThis()->yield();
-
-        // 协程恢复，取消定时器
-        if(timer) 
-        {
-            timer->cancel();
-        }
-
-        // 检查是否超时
-        if(tinfo->cancelled) 
-        {
-            errno = tinfo->cancelled;
+    if(iom->waitEvent(fd, mycoroutine::IOManager::WRITE, timeout_ms)) 
+    {
+        if(errno == ETIMEDOUT) 
+        {   // 超时
             return -1;
         }
-    } 
-    else 
-    {   // 事件添加失败
-        if(timer) 
-        {
-            timer->cancel();
-        }
+        // 事件添加失败
         std::cerr << "connect addEvent(" << fd << ", WRITE) error";
     }
 
@@ -494,6 +547,30 @@ int accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen)
 	return fd;
 }
 
+/**
+ * @brief accept4函数钩子实现
+ * @details 与accept相同，等待连接时挂起协程；新连接注册到FdManager，
+ *          flags中的SOCK_NONBLOCK记为用户设置的非阻塞，之后的IO返回EAGAIN而不是挂起
+ * @param sockfd 监听socket文件描述符
+ * @param addr 客户端地址结构（输出参数）
+ * @param addrlen 地址结构长度（输入/输出参数）
+ * @param flags SOCK_NONBLOCK、SOCK_CLOEXEC
+ * @return 成功返回新的连接socket文件描述符，失败返回-1并设置errno
+ */
+int accept4(int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags)
+{
+	int fd = do_io(sockfd, accept4_f, "accept4", mycoroutine::IOManager::READ, SO_RCVTIMEO, addr, addrlen, flags);
+	if(fd>=0 && mycoroutine::t_hook_enable)
+	{
+		std::shared_ptr<mycoroutine::FdCtx> ctx = mycoroutine::FdMgr::GetInstance()->get(fd, true);
+		if(ctx && (flags & SOCK_NONBLOCK))
+		{
+			ctx->setUserNonblock(true);
+		}
+	}
+	return fd;
+}
+
 /**
  * @brief read函数钩子实现
  * @details 将阻塞式的read转换为非阻塞的协程挂起操作
@@ -560,6 +637,15 @@ ssize_t recvfrom(int sockfd, void *buf, size_t len, int flags, struct sockaddr *
  */
 ssize_t recvmsg(int sockfd, struct msghdr *msg, int flags)
 {
+	if(mycoroutine::t_hook_enable)
+	{
+		// 开启了内核接收时间戳的套接字走带延迟统计的路径
+		std::shared_ptr<mycoroutine::FdCtx> ctx = mycoroutine::FdMgr::GetInstance()->get(sockfd);
+		if(ctx && ctx->isRxTimestamping() && !ctx->isClosed() && !ctx->getUserNonblock())
+		{
+			return recvmsg_timestamped(sockfd, msg, flags, ctx->getTimeout(SO_RCVTIMEO));
+		}
+	}
 	return do_io(sockfd, recvmsg_f, "recvmsg", mycoroutine::IOManager::READ, SO_RCVTIMEO, msg, flags);	
 }
 
@@ -867,9 +953,482 @@ int setsockopt(int sockfd, int level, int optname, const void *optval, socklen_t
                 ctx->setTimeout(optname, v->tv_sec * 1000 + v->tv_usec / 1000);
             }
         }
+        // 记录是否开启了内核接收软件时间戳
+        else if(optname == SO_TIMESTAMPING && optlen >= (socklen_t)sizeof(int))
+        {
+            int rt = setsockopt_f(sockfd, level, optname, optval, optlen);
+            std::shared_ptr<mycoroutine::FdCtx> ctx = mycoroutine::FdMgr::GetInstance()->get(sockfd);
+            if(rt == 0 && ctx)
+            {
+                int v = *(const int*)optval;
+                ctx->setRxTimestamping((v & SOF_TIMESTAMPING_RX_SOFTWARE) && (v & SOF_TIMESTAMPING_SOFTWARE));
+            }
+            return rt;
+        }
     }
     // 调用原始函数应用设置
     return setsockopt_f(sockfd, level, optname, optval, optlen);
 }
 
-}
\ No newline at end of file
+}
+
+namespace mycoroutine{
+
+/**
+ * @brief 为监听套接字设置服务端默认选项
+ * @param fd 监听套接字文件描述符
+ * @param fastopen_qlen TCP Fast Open等待队列长度，0表示不开启
+ * @param defer_accept_secs TCP_DEFER_ACCEPT等待数据的秒数，0表示不开启
+ * @return 全部成功返回0，任一选项失败返回-1
+ */
+int tune_listen_socket(int fd, int fastopen_qlen, int defer_accept_secs)
+{
+	int rt = 0;
+	int saved_errno = 0;
+	auto apply = [&](int optname, int value)
+	{
+		if(setsockopt_f(fd, IPPROTO_TCP, optname, &value, sizeof(value)) && rt == 0)
+		{
+			rt = -1;
+			saved_errno = errno;
+		}
+	};
+
+	// 关闭Nagle算法，accept得到的连接继承该选项
+	apply(TCP_NODELAY, 1);
+	// 三次握手完成后不立即唤醒accept，等到第一段数据到达
+	if(defer_accept_secs > 0)
+	{
+		apply(TCP_DEFER_ACCEPT, defer_accept_secs);
+	}
+	// 服务端开启TCP Fast Open
+	if(fastopen_qlen > 0)
+	{
+		apply(TCP_FASTOPEN, fastopen_qlen);
+	}
+
+	if(rt)
+	{
+		errno = saved_errno;
+	}
+	return rt;
+}
+
+/**
+ * @brief 非阻塞发送全部数据，发送缓冲区满或连接尚未建立时挂起当前协程
+ * @param fd 套接字文件描述符
+ * @param buf 要发送的数据
+ * @param len 数据长度
+ * @param timeout_ms 发送超时时间（毫秒）
+ * @return 成功返回len，失败返回-1并设置errno
+ */
+static ssize_t send_all(int fd, const char* buf, size_t len, uint64_t timeout_ms)
+{
+	size_t sent = 0;
+	while(sent < len)
+	{
+		ssize_t n = send_f(fd, buf + sent, len - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if(n >= 0)
+		{
+			sent += n;
+			continue;
+		}
+		if(errno == EINTR)
+		{
+			continue;
+		}
+		// EINPROGRESS：TCP_FASTOPEN_CONNECT没有cookie时，首次写触发普通握手
+		IOManager* iom = IOManager::GetThis();
+		if((errno != EAGAIN && errno != EINPROGRESS) || !iom)
+		{
+			return -1;
+		}
+		if(iom->waitEvent(fd, IOManager::WRITE, timeout_ms))
+		{
+			return -1;
+		}
+	}
+	return len;
+}
+
+/**
+ * @brief 建立连接并发送第一段数据（TCP Fast Open）
+ * @param fd 套接字文件描述符
+ * @param addr 目标地址
+ * @param addrlen 地址长度
+ * @param buf 要发送的数据
+ * @param len 数据长度
+ * @param timeout_ms 连接超时时间（毫秒）
+ * @return 成功返回len，失败返回-1并设置errno
+ */
+ssize_t connect_and_send(int fd, const struct sockaddr* addr, socklen_t addrlen,
+                         const void* buf, size_t len, uint64_t timeout_ms)
+{
+	const char* data = (const char*)buf;
+
+	// 钩子未启用或不是受管理的套接字：普通的阻塞connect+send
+	std::shared_ptr<FdCtx> ctx = FdMgr::GetInstance()->get(fd);
+	if(!t_hook_enable || !ctx || !ctx->isSocket() || ctx->getUserNonblock())
+	{
+		if(connect(fd, addr, addrlen))
+		{
+			return -1;
+		}
+		size_t sent = 0;
+		while(sent < len)
+		{
+			ssize_t n = send(fd, data + sent, len - sent, MSG_NOSIGNAL);
+			if(n < 0)
+			{
+				return -1;
+			}
+			sent += n;
+		}
+		return len;
+	}
+	if(ctx->isClosed())
+	{
+		errno = EBADF;
+		return -1;
+	}
+
+	uint64_t send_timeout = ctx->getTimeout(SO_SNDTIMEO);
+
+#ifdef TCP_FASTOPEN_CONNECT
+	// 首选TCP_FASTOPEN_CONNECT：connect()立即返回，SYN推迟到第一次写时携带数据发出
+	int one = 1;
+	if(setsockopt_f(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &one, sizeof(one)) == 0)
+	{
+		if(connect_with_timeout(fd, addr, addrlen, timeout_ms))
+		{
+			return -1;
+		}
+		return send_all(fd, data, len, send_timeout);
+	}
+#endif
+
+#ifdef MSG_FASTOPEN
+	// 次选sendto(MSG_FASTOPEN)：一次调用完成连接并把数据放进SYN；
+	// 没有cookie时需要挂起等待握手，不在IOManager中则跳过，走普通的connect+send
+	IOManager* iom = IOManager::GetThis();
+	if(iom)
+	{
+		ssize_t n = sendto_f(fd, data, len, MSG_FASTOPEN | MSG_NOSIGNAL | MSG_DONTWAIT, addr, addrlen);
+		if(n >= 0)
+		{
+			ssize_t rest = send_all(fd, data + n, len - n, send_timeout);
+			return rest < 0 ? -1 : (ssize_t)len;
+		}
+		if(errno == EINPROGRESS)
+		{
+			// 没有cookie：SYN已发出但不带数据，等待握手完成后再发送
+			if(iom->waitEvent(fd, IOManager::WRITE, timeout_ms))
+			{
+				return -1;
+			}
+			int error = 0;
+			socklen_t errlen = sizeof(error);
+			if(getsockopt_f(fd, SOL_SOCKET, SO_ERROR, &error, &errlen) == -1)
+			{
+				return -1;
+			}
+			if(error)
+			{
+				errno = error;
+				return -1;
+			}
+			return send_all(fd, data, len, send_timeout);
+		}
+		if(errno != EOPNOTSUPP && errno != ENOPROTOOPT && errno != EINVAL)
+		{
+			return -1;
+		}
+	}
+#endif
+
+	// 内核不支持Fast Open或不在IOManager中：退化为普通的connect+send
+	if(connect_with_timeout(fd, addr, addrlen, timeout_ms))
+	{
+		return -1;
+	}
+	return send_all(fd, data, len, send_timeout);
+}
+
+/**
+ * @brief 关闭未胜出的连接尝试：取消其上的事件后关闭
+ * @param iom IO管理器
+ * @param fd 套接字
+ */
+static void discard_attempt(IOManager* iom, int fd)
+{
+	iom->cancelAll(fd);
+	close_f(fd);
+}
+
+/**
+ * @brief 并行连接的共享状态
+ * @details 各连接的WRITE事件回调和唯一的定时器通过它唤醒发起连接的协程
+ */
+struct ConnectRace
+{
+	std::mutex mutex;                 // 保护ready和waiting
+	std::vector<size_t> ready;        // 已就绪（可写或被取消）的尝试序号
+	bool waiting = false;             // 协程是否已挂起
+	std::shared_ptr<Fiber> fiber;     // 发起连接的协程
+	IOManager* iom = nullptr;         // IO管理器
+
+	/**
+	 * @brief 唤醒挂起的协程（调用者持有mutex）
+	 */
+	void wake()
+	{
+		if(waiting)
+		{
+			waiting = false;
+			iom->scheduleLock(fiber);
+		}
+	}
+};
+
+/**
+ * @brief 并行连接多个候选地址（Happy Eyeballs）
+ * @param addrs 候选地址链表
+ * @param timeout_ms 总超时时间（毫秒）
+ * @param attempt_delay_ms 相邻两次尝试的发起间隔（毫秒）
+ * @return 成功返回已连接的套接字，失败返回-1并设置errno
+ */
+int connect_any(const struct addrinfo* addrs, uint64_t timeout_ms, uint64_t attempt_delay_ms)
+{
+	// 1 按地址族交替排列：首个地址族的第1个、另一地址族的第1个、首个地址族的第2个……
+	std::vector<const struct addrinfo*> primary, secondary, order;
+	int first_family = AF_UNSPEC;
+	for(const struct addrinfo* ai = addrs; ai; ai = ai->ai_next)
+	{
+		if(ai->ai_socktype != 0 && ai->ai_socktype != SOCK_STREAM)
+		{
+			continue;
+		}
+		if(first_family == AF_UNSPEC)
+		{
+			first_family = ai->ai_family;
+		}
+		(ai->ai_family == first_family ? primary : secondary).push_back(ai);
+	}
+	for(size_t i = 0; i < primary.size() || i < secondary.size(); ++i)
+	{
+		if(i < primary.size())
+		{
+			order.push_back(primary[i]);
+		}
+		if(i < secondary.size())
+		{
+			order.push_back(secondary[i]);
+		}
+	}
+	if(order.empty())
+	{
+		errno = EADDRNOTAVAIL;
+		return -1;
+	}
+
+	// 不在IOManager中：依次阻塞连接
+	IOManager* iom = IOManager::GetThis();
+	int last_error = ECONNREFUSED;
+	if(!iom)
+	{
+		for(const struct addrinfo* ai : order)
+		{
+			int fd = socket_f(ai->ai_family, SOCK_STREAM | SOCK_CLOEXEC, ai->ai_protocol);
+			if(fd < 0)
+			{
+				last_error = errno;
+				continue;
+			}
+			if(connect_f(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+			{
+				return fd;
+			}
+			last_error = errno;
+			close_f(fd);
+		}
+		errno = last_error;
+		return -1;
+	}
+
+	std::shared_ptr<ConnectRace> race = std::make_shared<ConnectRace>();
+	race->fiber = Fiber::GetThis();
+	race->iom = iom;
+	std::weak_ptr<ConnectRace> wrace(race);
+
+	// 发起间隔与总超时共用一个周期定时器，每次挂起前按下一个唤醒时刻重置；没有唤醒时刻时设为一天
+	const uint64_t idle_ms = 24ULL * 3600 * 1000;
+	std::shared_ptr<Timer> timer = iom->addTimer(idle_ms, [wrace]()
+	{
+		std::shared_ptr<ConnectRace> r = wrace.lock();
+		if(r)
+		{
+			std::lock_guard<std::mutex> lock(r->mutex);
+			r->wake();
+		}
+	}, true);
+
+	std::vector<int> fds;                 // 尝试序号 -> 套接字，-1表示已结束
+	size_t next = 0;                      // 下一个候选地址
+	size_t inflight = 0;                  // 进行中的尝试数
+	int winner = -1;
+	uint64_t now = steady_ms();
+	uint64_t deadline = timeout_ms == (uint64_t)-1 ? (uint64_t)-1 : now + timeout_ms;
+	uint64_t next_start = now;            // 下一次尝试的发起时刻
+
+	while(true)
+	{
+		// 2 发起新的尝试：到达发起时刻，或者已经没有进行中的尝试（上一个失败了）
+		now = steady_ms();
+		while(winner < 0 && next < order.size() && (inflight == 0 || now >= next_start))
+		{
+			const struct addrinfo* ai = order[next++];
+			int fd = socket_f(ai->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+			if(fd < 0)
+			{
+				last_error = errno;
+				continue;
+			}
+			if(connect_f(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+			{
+				// 回环等地址可能立即连接成功
+				winner = fd;
+				break;
+			}
+			size_t index = fds.size();
+			if(errno != EINPROGRESS || iom->addEvent(fd, IOManager::WRITE, [race, index]()
+			   {
+			       std::lock_guard<std::mutex> lock(race->mutex);
+			       race->ready.push_back(index);
+			       race->wake();
+			   }))
+			{
+				last_error = errno;
+				close_f(fd);
+				continue;
+			}
+			fds.push_back(fd);
+			++inflight;
+			next_start = now + attempt_delay_ms;
+		}
+
+		if(winner >= 0)
+		{
+			break;
+		}
+		if(inflight == 0)
+		{
+			last_error = last_error ? last_error : ECONNREFUSED;
+			break;
+		}
+		if(now >= deadline)
+		{
+			last_error = ETIMEDOUT;
+			break;
+		}
+
+		// 3 挂起直到某个连接就绪、到达下一次发起时刻或截止时间
+		uint64_t wake_at = next < order.size() ? std::min(next_start, deadline) : deadline;
+		std::vector<size_t> ready;
+		{
+			std::unique_lock<std::mutex> lock(race->mutex);
+			if(race->ready.empty())
+			{
+				timer->reset(wake_at == (uint64_t)-1 ? idle_ms : (wake_at > now ? wake_at - now : 0), true);
+				race->waiting = true;
+				lock.unlock();
+				Fiber::GetThis()->yield();
+				lock.lock();
+			}
+			ready.swap(race->ready);
+		}
+
+		// 4 检查就绪的尝试：第一个成功的胜出，失败的关闭并立即发起下一个
+		for(size_t index : ready)
+		{
+			int fd = fds[index];
+			if(fd < 0)
+			{
+				continue;
+			}
+			int error = 0;
+			socklen_t len = sizeof(error);
+			if(getsockopt_f(fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0)
+			{
+				error = errno;
+			}
+			if(error == 0 && winner >= 0)
+			{
+				continue;
+			}
+			fds[index] = -1;
+			--inflight;
+			if(error == 0)
+			{
+				winner = fd;
+				continue;
+			}
+			last_error = error;
+			discard_attempt(iom, fd);
+			next_start = 0;
+		}
+		if(winner >= 0)
+		{
+			break;
+		}
+	}
+
+	// 5 取消定时器，关闭其余尝试
+	timer->cancel();
+	for(int fd : fds)
+	{
+		if(fd >= 0)
+		{
+			discard_attempt(iom, fd);
+		}
+	}
+	if(winner < 0)
+	{
+		errno = last_error;
+		return -1;
+	}
+	// 与hook的socket()创建的套接字一样登记到FdManager
+	FdMgr::GetInstance()->get(winner, true);
+	return winner;
+}
+
+/**
+ * @brief 获取全局接收延迟统计
+ * @return 接收延迟统计
+ */
+RxLatencyStats& rx_latency_stats()
+{
+	static RxLatencyStats s_stats;
+	return s_stats;
+}
+
+/**
+ * @brief 为套接字开启内核接收软件时间戳
+ * @param fd 套接字文件描述符
+ * @return 成功返回0，失败返回-1并设置errno
+ */
+int enable_rx_timestamping(int fd)
+{
+	int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+	if(setsockopt_f(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)))
+	{
+		return -1;
+	}
+	std::shared_ptr<FdCtx> ctx = FdMgr::GetInstance()->get(fd, true);
+	if(ctx)
+	{
+		ctx->setRxTimestamping(true);
+	}
+	return 0;
+}
+
+} // end namespace mycoroutine
@@ -0,0 +1,507 @@
+#include <mycoroutine/http_parser.h>  // HTTP请求解析器头文件
+
+#include <cstdint>    // uint8_t
+#include <cstring>    // memcmp
+#include <strings.h>  // strncasecmp
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>  // SSE4.2/AVX2 intrinsics
+#define MYCOROUTINE_HTTP_X86 1
+#endif
+
+namespace mycoroutine {
+
+/**
+ * @brief 扫描函数表
+ * @details 每个函数返回[p, end)中第一个不属于对应字符集的位置，全部属于时返回end
+ */
+struct HttpScanOps
+{
+    HttpScanImpl impl;
+    const char* (*token)(const char* p, const char* end);  // 方法、头部名称：RFC 7230 tchar
+    const char* (*uri)(const char* p, const char* end);    // 请求目标：除空格、控制字符和DEL外的字符
+    const char* (*value)(const char* p, const char* end);  // 头部值：除HT外的控制字符和DEL之外的字符
+};
+
+/**
+ * @brief 字符分类表
+ */
+struct HttpCharTables
+{
+    bool token[256];        // tchar
+    bool uri[256];          // 请求目标允许的字符
+    bool value[256];        // 头部值允许的字符
+    uint8_t tokenLo[16];    // tchar的低4位查找表（PSHUFB）
+    uint8_t tokenHi[16];    // tchar的高4位查找表（PSHUFB）
+
+    HttpCharTables()
+    {
+        static const char kTchar[] = "!#$%&'*+-.^_`|~";
+        for(int c = 0; c < 256; ++c)
+        {
+            token[c] = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                       (c != 0 && strchr(kTchar, c) != nullptr);
+            uri[c]   = c > 0x20 && c != 0x7f;
+            value[c] = (c >= 0x20 && c != 0x7f) || c == '\t';
+        }
+
+        // 把tchar集合拆成“高4位 x 低4位”的矩形之并：相同低4位集合的高4位共用一个比特，
+        // 字节c属于集合当且仅当tokenHi[c>>4] & tokenLo[c&0xf]不为0。ASCII只有8个高4位取值，最多8个比特
+        memset(tokenLo, 0, sizeof(tokenLo));
+        memset(tokenHi, 0, sizeof(tokenHi));
+        uint16_t sets[8];
+        int nsets = 0;
+        for(int hi = 0; hi < 8; ++hi)
+        {
+            uint16_t set = 0;
+            for(int lo = 0; lo < 16; ++lo)
+            {
+                if(token[(hi << 4) | lo])
+                {
+                    set |= (uint16_t)(1 << lo);
+                }
+            }
+            if(set == 0)
+            {
+                continue;
+            }
+            int bit = 0;
+            while(bit < nsets && sets[bit] != set)
+            {
+                ++bit;
+            }
+            if(bit == nsets)
+            {
+                sets[nsets++] = set;
+            }
+            tokenHi[hi] |= (uint8_t)(1 << bit);
+        }
+        for(int bit = 0; bit < nsets; ++bit)
+        {
+            for(int lo = 0; lo < 16; ++lo)
+            {
+                if(sets[bit] & (1 << lo))
+                {
+                    tokenLo[lo] |= (uint8_t)(1 << bit);
+                }
+            }
+        }
+    }
+};
+
+static const HttpCharTables s_tables;
+
+// ============================================================================
+// 标量实现
+// ============================================================================
+
+static const char* scan_token_scalar(const char* p, const char* end)
+{
+    while(p != end && s_tables.token[(uint8_t)*p])
+    {
+        ++p;
+    }
+    return p;
+}
+
+static const char* scan_uri_scalar(const char* p, const char* end)
+{
+    while(p != end && s_tables.uri[(uint8_t)*p])
+    {
+        ++p;
+    }
+    return p;
+}
+
+static const char* scan_value_scalar(const char* p, const char* end)
+{
+    while(p != end && s_tables.value[(uint8_t)*p])
+    {
+        ++p;
+    }
+    return p;
+}
+
+static const HttpScanOps s_scalar_ops = {HttpScanImpl::SCALAR, scan_token_scalar, scan_uri_scalar, scan_value_scalar};
+
+#ifdef MYCOROUTINE_HTTP_X86
+
+// ============================================================================
+// SSE4.2实现：PCMPESTRI按字节区间查找第一个终止字符
+// ============================================================================
+
+// 区间以字节对给出，未用到的部分补0；加载时需要完整的16字节
+alignas(16) static const char s_token_ranges[16] = {
+    '\0', ' ', '"', '"', '(', ')', ',', ',', '/', '/', ':', '@', '[', ']', '{', '\xff'};
+alignas(16) static const char s_uri_ranges[16] = {'\0', ' ', '\x7f', '\x7f'};
+alignas(16) static const char s_value_ranges[16] = {'\0', '\x08', '\x0a', '\x1f', '\x7f', '\x7f'};
+
+/**
+ * @brief 查找第一个落在区间内的字节
+ * @param ranges 区间表
+ * @param nranges 区间表的有效字节数
+ * @return 找到返回其位置；剩余不足16字节时返回尚未扫描的位置
+ */
+__attribute__((target("sse4.2")))
+static const char* find_ranges_sse42(const char* p, const char* end, const char* ranges, int nranges)
+{
+    __m128i r = _mm_load_si128((const __m128i*)ranges);
+    while(end - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        int idx = _mm_cmpestri(r, nranges, v, 16, _SIDD_LEAST_SIGNIFICANT | _SIDD_CMP_RANGES | _SIDD_UBYTE_OPS);
+        if(idx != 16)
+        {
+            return p + idx;
+        }
+        p += 16;
+    }
+    return p;
+}
+
+__attribute__((target("sse4.2")))
+static const char* scan_token_sse42(const char* p, const char* end)
+{
+    while(true)
+    {
+        p = find_ranges_sse42(p, end, s_token_ranges, 16);
+        if(end - p < 16)
+        {
+            return scan_token_scalar(p, end);
+        }
+        // 区间表是tchar补集的超集（'|'、'~'也会命中），命中后按查表结果确认
+        if(!s_tables.token[(uint8_t)*p])
+        {
+            return p;
+        }
+        ++p;
+    }
+}
+
+__attribute__((target("sse4.2")))
+static const char* scan_uri_sse42(const char* p, const char* end)
+{
+    p = find_ranges_sse42(p, end, s_uri_ranges, 4);
+    return end - p < 16 ? scan_uri_scalar(p, end) : p;
+}
+
+__attribute__((target("sse4.2")))
+static const char* scan_value_sse42(const char* p, const char* end)
+{
+    p = find_ranges_sse42(p, end, s_value_ranges, 6);
+    return end - p < 16 ? scan_value_scalar(p, end) : p;
+}
+
+static const HttpScanOps s_sse42_ops = {HttpScanImpl::SSE42, scan_token_sse42, scan_uri_sse42, scan_value_sse42};
+
+// ============================================================================
+// AVX2实现：每次比较32字节，movemask后取第一个终止字符
+// ============================================================================
+
+__attribute__((target("avx2")))
+static const char* scan_token_avx2(const char* p, const char* end)
+{
+    const __m256i lo_lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)s_tables.tokenLo));
+    const __m256i hi_lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)s_tables.tokenHi));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i zero   = _mm256_setzero_si256();
+    while(end - p >= 32)
+    {
+        __m256i v  = _mm256_loadu_si256((const __m256i*)p);
+        __m256i lo = _mm256_shuffle_epi8(lo_lut, _mm256_and_si256(v, nibble));
+        __m256i hi = _mm256_shuffle_epi8(hi_lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        uint32_t stop = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), zero));
+        if(stop)
+        {
+            return p + __builtin_ctz(stop);
+        }
+        p += 32;
+    }
+    return scan_token_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* scan_uri_avx2(const char* p, const char* end)
+{
+    const __m256i space = _mm256_set1_epi8(0x20);
+    const __m256i del   = _mm256_set1_epi8(0x7f);
+    while(end - p >= 32)
+    {
+        __m256i v    = _mm256_loadu_si256((const __m256i*)p);
+        __m256i ctl  = _mm256_cmpeq_epi8(_mm256_min_epu8(v, space), v);  // v <= 0x20
+        __m256i bad  = _mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, del));
+        uint32_t stop = (uint32_t)_mm256_movemask_epi8(bad);
+        if(stop)
+        {
+            return p + __builtin_ctz(stop);
+        }
+        p += 32;
+    }
+    return scan_uri_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* scan_value_avx2(const char* p, const char* end)
+{
+    const __m256i us  = _mm256_set1_epi8(0x1f);
+    const __m256i ht  = _mm256_set1_epi8('\t');
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    while(end - p >= 32)
+    {
+        __m256i v   = _mm256_loadu_si256((const __m256i*)p);
+        __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, us), v);       // v <= 0x1f
+        ctl = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, ht), ctl);          // HT允许出现在值中
+        __m256i bad = _mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, del));
+        uint32_t stop = (uint32_t)_mm256_movemask_epi8(bad);
+        if(stop)
+        {
+            return p + __builtin_ctz(stop);
+        }
+        p += 32;
+    }
+    return scan_value_scalar(p, end);
+}
+
+static const HttpScanOps s_avx2_ops = {HttpScanImpl::AVX2, scan_token_avx2, scan_uri_avx2, scan_value_avx2};
+
+#endif // MYCOROUTINE_HTTP_X86
+
+/**
+ * @brief 按CPU能力选择扫描实现
+ * @param impl 期望的实现，CPU不支持时退回自动选择
+ */
+static const HttpScanOps* select_ops(HttpScanImpl impl)
+{
+#ifdef MYCOROUTINE_HTTP_X86
+    __builtin_cpu_init();
+    bool avx2  = __builtin_cpu_supports("avx2");
+    bool sse42 = __builtin_cpu_supports("sse4.2");
+    if(impl == HttpScanImpl::SCALAR)
+    {
+        return &s_scalar_ops;
+    }
+    if(impl == HttpScanImpl::SSE42 && sse42)
+    {
+        return &s_sse42_ops;
+    }
+    if(impl == HttpScanImpl::AVX2 && avx2)
+    {
+        return &s_avx2_ops;
+    }
+    return avx2 ? &s_avx2_ops : (sse42 ? &s_sse42_ops : &s_scalar_ops);
+#else
+    (void)impl;
+    return &s_scalar_ops;
+#endif
+}
+
+// 当前生效的扫描实现
+static const HttpScanOps* s_ops = select_ops(HttpScanImpl::AUTO);
+
+/**
+ * @brief 指定扫描实现
+ * @param impl 扫描实现
+ * @return 实际生效的实现
+ */
+HttpScanImpl set_http_scan_impl(HttpScanImpl impl)
+{
+    s_ops = select_ops(impl);
+    return s_ops->impl;
+}
+
+/**
+ * @brief 获取当前生效的扫描实现
+ */
+HttpScanImpl get_http_scan_impl()
+{
+    return s_ops->impl;
+}
+
+/**
+ * @brief 获取扫描实现的名称
+ * @param impl 扫描实现
+ */
+const char* http_scan_impl_name(HttpScanImpl impl)
+{
+    switch(impl)
+    {
+    case HttpScanImpl::SCALAR: return "scalar";
+    case HttpScanImpl::SSE42:  return "sse4.2";
+    case HttpScanImpl::AVX2:   return "avx2";
+    default:                   return "auto";
+    }
+}
+
+/**
+ * @brief 解析行结束符（CRLF或单独的LF）
+ * @param p 当前位置，成功时移动到下一行开头
+ * @return 成功返回0；数据不完整返回-2；格式错误返回-1
+ */
+static int parse_eol(const char*& p, const char* end)
+{
+    if(p == end)
+    {
+        return -2;
+    }
+    if(*p == '\r')
+    {
+        if(++p == end)
+        {
+            return -2;
+        }
+        if(*p != '\n')
+        {
+            return -1;
+        }
+    }
+    else if(*p != '\n')
+    {
+        return -1;
+    }
+    ++p;
+    return 0;
+}
+
+/**
+ * @brief 解析HTTP/1.x请求行和请求头
+ * @param buf 数据缓冲区
+ * @param len 数据长度
+ * @param req 输出参数，解析结果
+ * @return 成功返回请求头部分的字节数；数据不完整返回-2；格式错误返回-1
+ */
+int parse_http_request(const char* buf, size_t len, HttpRequest& req)
+{
+    const HttpScanOps* ops = s_ops;
+    const char* p = buf;
+    const char* end = buf + len;
+    req.headerCount = 0;
+
+    // 忽略请求行之前的空行（RFC 7230 3.5）
+    while(p != end && (*p == '\r' || *p == '\n'))
+    {
+        ++p;
+    }
+
+    // 1 请求方法
+    const char* q = ops->token(p, end);
+    if(q == end)
+    {
+        return -2;
+    }
+    if(q == p || *q != ' ')
+    {
+        return -1;
+    }
+    req.method = std::string_view(p, q - p);
+    p = q + 1;
+
+    // 2 请求目标
+    q = ops->uri(p, end);
+    if(q == end)
+    {
+        return -2;
+    }
+    if(q == p || *q != ' ')
+    {
+        return -1;
+    }
+    req.path = std::string_view(p, q - p);
+    p = q + 1;
+
+    // 3 协议版本 HTTP/1.x
+    static const char kVersion[] = "HTTP/1.";
+    size_t avail = end - p;
+    if(avail < 8)
+    {
+        return memcmp(p, kVersion, avail < 7 ? avail : 7) == 0 ? -2 : -1;
+    }
+    if(memcmp(p, kVersion, 7) != 0 || p[7] < '0' || p[7] > '9')
+    {
+        return -1;
+    }
+    req.minorVersion = p[7] - '0';
+    p += 8;
+    int rt = parse_eol(p, end);
+    if(rt)
+    {
+        return rt;
+    }
+
+    // 4 请求头，直到空行
+    while(true)
+    {
+        if(p == end)
+        {
+            return -2;
+        }
+        if(*p == '\r' || *p == '\n')
+        {
+            rt = parse_eol(p, end);
+            return rt ? rt : (int)(p - buf);
+        }
+        if(req.headerCount == HttpRequest::kMaxHeaders)
+        {
+            return -1;
+        }
+
+        // 头部名称（以空白开头的续行不支持，名称为空同样是格式错误）
+        q = ops->token(p, end);
+        if(q == end)
+        {
+            return -2;
+        }
+        if(q == p || *q != ':')
+        {
+            return -1;
+        }
+        HttpHeader& header = req.headers[req.headerCount];
+        header.name = std::string_view(p, q - p);
+        p = q + 1;
+
+        // 跳过前导空白
+        while(p != end && (*p == ' ' || *p == '\t'))
+        {
+            ++p;
+        }
+
+        // 头部值，去掉尾部空白
+        q = ops->value(p, end);
+        if(q == end)
+        {
+            return -2;
+        }
+        const char* value_end = q;
+        while(value_end != p && (value_end[-1] == ' ' || value_end[-1] == '\t'))
+        {
+            --value_end;
+        }
+        header.value = std::string_view(p, value_end - p);
+        p = q;
+        rt = parse_eol(p, end);
+        if(rt)
+        {
+            return rt;
+        }
+        ++req.headerCount;
+    }
+}
+
+/**
+ * @brief 查找请求头（名称不区分大小写）
+ * @param name 头部名称
+ * @return 找到返回指向该请求头的指针，否则返回nullptr
+ */
+const HttpHeader* HttpRequest::findHeader(std::string_view name) const
+{
+    for(size_t i = 0; i < headerCount; ++i)
+    {
+        if(headers[i].name.size() == name.size() &&
+           strncasecmp(headers[i].name.data(), name.data(), name.size()) == 0)
+        {
+            return &headers[i];
+        }
+    }
+    return nullptr;
+}
+
+} // end namespace mycoroutine
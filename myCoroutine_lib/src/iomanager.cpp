@@ -5,11 +5,17 @@
 #include <fcntl.h>      // 文件控制函数
 #include <cstring>      // C风格字符串处理
 #include <cstdlib>      // 包含exit等函数
+#include <time.h>       // clock_gettime
+#include <sys/resource.h> // getrlimit
+#include <algorithm>    // std::min
 
 #include <mycoroutine/iomanager.h>  // IO管理器头文件
+#include <mycoroutine/fd_manager.h> // 文件描述符管理器（预分配fd表）
+#include <mycoroutine/epoch.h>      // 纪元回收（延迟释放旧fd表）
+#include <mycoroutine/metrics.h>    // 共享内存指标
 
 // 调试标志，用于控制调试信息输出
-static bool debug = true;
+static bool debug = false;
 
 namespace mycoroutine {
 
@@ -19,8 +25,8 @@ namespace mycoroutine {
  */
 IOManager* IOManager::GetThis() 
 {
-    // 从线程局部存储获取调度器实例并转换为IO管理器类型
-    return dynamic_cast<IOManager*>(Scheduler::GetThis());
+    // 调度器设置线程局部存储时一并缓存了IO管理器指针，不需要dynamic_cast
+    return Scheduler::GetThisIOManager();
 }
 
 /**
@@ -92,10 +98,14 @@ void IOManager::FdContext::triggerEvent(IOManager::Event event) {
  * @param threads 工作线程数量
  * @param use_caller 是否使用调用者线程作为工作线程
  * @param name IO管理器名称
+ * @param warmup 启动预热配置
  */
-IOManager::IOManager(size_t threads, bool use_caller, const std::string &name): 
+IOManager::IOManager(size_t threads, bool use_caller, const std::string &name, const WarmupConfig &warmup): 
 Scheduler(threads, use_caller, name), TimerManager()
 {
+    // 使用调用者线程时构造Scheduler已把当前线程设置为本调度器，此时还不是IOManager，登记后刷新缓存
+    setIOManager(this);
+
     // 创建epoll实例，参数5000是历史遗留，现代Linux已忽略此值
     m_epfd = epoll_create(5000);
     assert(m_epfd > 0); // 确保epoll创建成功
@@ -115,10 +125,22 @@ Scheduler(threads, use_caller, name), TimerManager()
     int rt = epoll_ctl(m_epfd, EPOLL_CTL_ADD, m_tickleFds, &event);
     assert(!rt);
 
-    // 初始化文件描述符上下文数组，初始大小为32
-    contextResize(32);
+    // 初始化文件描述符上下文数组，初始大小为32；
+    // 按RLIMIT_NOFILE一次性预分配两张fd表，避免运行期扩容
+    size_t table_size = 32;
+    if(warmup.fd_table_from_rlimit)
+    {
+        struct rlimit rl;
+        if(getrlimit(RLIMIT_NOFILE, &rl) == 0)
+        {
+            table_size = std::max<size_t>(table_size, std::min<size_t>(rl.rlim_cur, warmup.max_fd_table_size));
+            FdMgr::GetInstance()->reserve(table_size);
+        }
+    }
+    contextResize(table_size);
 
-    // 启动调度器
+    // 启动调度器（等待所有工作线程预热完成）
+    setWarmup(warmup);
     start();
 }
 
@@ -131,36 +153,147 @@ IOManager::~IOManager() {
     close(m_epfd);          // 关闭epoll文件描述符
     close(m_tickleFds);     // 关闭eventfd
 
-    // 清理文件描述符上下文数组
-    for (size_t i = 0; i < m_fdContexts.size(); ++i) 
+    // 清理文件描述符上下文数组（已退役的旧表只持有指针，由纪元回收释放）
+    std::vector<FdContext *>* table = m_fdContexts.load();
+    for (size_t i = 0; i < table->size(); ++i) 
     {
-        if (m_fdContexts[i]) 
+        if ((*table)[i]) 
         {
-            delete m_fdContexts[i];
+            delete (*table)[i];
         }
     }
+    delete table;
 }
 
 /**
  * @brief 调整文件描述符上下文数组大小
- * 注意：此函数需要在调用前持有m_mutex锁
+ * @details 复制出一张更大的表并原子地发布，旧表交给纪元回收延迟释放。
+ *          FdContext对象在新旧表之间共享，直到被trimFdContexts()摘除或IOManager析构才释放；
+ *          摘除的上下文同样经纪元回收，读者在临界区内拿到的指针始终有效
  * @param size 新的数组大小
  */
-// no lock
 void IOManager::contextResize(size_t size) 
 {
-    // 调整数组大小
-    m_fdContexts.resize(size);
+    std::lock_guard<std::mutex> lock(m_resizeMutex);
+
+    // 只允许增长，已有上下文可能正被其他线程引用
+    std::vector<FdContext *>* old_table = m_fdContexts.load(std::memory_order_relaxed);
+    size_t old_size = old_table ? old_table->size() : 0;
+    if(size <= old_size)
+    {
+        return;
+    }
+
+    std::vector<FdContext *>* table = new std::vector<FdContext *>(size);
+    if(old_table)
+    {
+        std::copy(old_table->begin(), old_table->end(), table->begin());
+    }
+
+    // 只初始化新增的文件描述符上下文
+    for (size_t i = old_size; i < table->size(); ++i) 
+    {
+        (*table)[i] = new FdContext();
+        (*table)[i]->fd = i; // 设置文件描述符编号
+    }
 
-    // 初始化新增的文件描述符上下文
-    for (size_t i = 0; i < m_fdContexts.size(); ++i) 
+    m_fdContexts.store(table, std::memory_order_release);
+    if(old_table)
     {
-        if (m_fdContexts[i]==nullptr) 
+        Epoch::Retire(old_table);
+    }
+}
+
+/**
+ * @brief 收缩文件描述符上下文数组，释放末尾没有注册事件的上下文
+ * @param min_size 至少保留的数组大小
+ * @return 释放的上下文数量
+ */
+size_t IOManager::trimFdContexts(size_t min_size)
+{
+    std::lock_guard<std::mutex> lock(m_resizeMutex);
+
+    std::vector<FdContext *>* old_table = m_fdContexts.load(std::memory_order_relaxed);
+    size_t size = old_table->size();
+    min_size = std::max<size_t>(min_size, 1);
+    // 从末尾向前摘除，遇到仍有注册事件的上下文即停止；
+    // 标记retired后addEvent不会再在其上注册，转而等待新表发布后重新查找
+    while(size > min_size)
+    {
+        FdContext *fd_ctx = (*old_table)[size - 1];
+        std::lock_guard<std::mutex> ctx_lock(fd_ctx->mutex);
+        if(fd_ctx->events != NONE)
         {
-            m_fdContexts[i] = new FdContext();
-            m_fdContexts[i]->fd = i; // 设置文件描述符编号
+            break;
         }
+        fd_ctx->retired = true;
+        --size;
     }
+    if(size == old_table->size())
+    {
+        return 0;
+    }
+
+    std::vector<FdContext *>* table = new std::vector<FdContext *>(old_table->begin(), old_table->begin() + size);
+    m_fdContexts.store(table, std::memory_order_release);
+
+    // 其他线程可能仍持有旧表或被摘除的上下文，全部交给纪元回收
+    size_t released = old_table->size() - size;
+    for(size_t i = size; i < old_table->size(); ++i)
+    {
+        Epoch::Retire((*old_table)[i]);
+    }
+    Epoch::Retire(old_table);
+    return released;
+}
+
+/**
+ * @brief 释放缓存以降低内存占用
+ * @details 在调度线程上收缩fd上下文表和FdManager的表（纪元回收在调度线程上推进最快），
+ *          再由基类清理各线程的协程池、栈缓存和缓冲池
+ */
+void IOManager::trimCaches()
+{
+    scheduleLock([this]()
+    {
+        trimFdContexts();
+        FdMgr::GetInstance()->trim();
+    });
+    Scheduler::trimCaches();
+}
+
+/**
+ * @brief 获取文件描述符上下文
+ * @param fd 文件描述符
+ * @param auto_create 表不够大时是否扩容
+ * @return 文件描述符上下文，不存在返回nullptr
+ * @details 读路径无锁：在线工作线程直接读取，其他线程在EpochGuard内读取
+ */
+IOManager::FdContext* IOManager::getFdContext(int fd, bool auto_create)
+{
+    if(fd < 0)
+    {
+        return nullptr;
+    }
+
+    {
+        EpochGuard guard;
+        std::vector<FdContext *>* table = m_fdContexts.load(std::memory_order_acquire);
+        if((size_t)fd < table->size())
+        {
+            return (*table)[fd];
+        }
+    }
+
+    if(!auto_create)
+    {
+        return nullptr;
+    }
+    // 扩容到fd*1.5的大小，确保有足够空间
+    contextResize(fd * 1.5 + 1);
+
+    EpochGuard guard;
+    return (*m_fdContexts.load(std::memory_order_acquire))[fd];
 }
 
 /**
@@ -172,28 +305,31 @@ void IOManager::contextResize(size_t size)
  */
 int IOManager::addEvent(int fd, Event event, std::function<void()> cb) 
 {
+    // 在纪元临界区内使用上下文，期间不会被收缩释放
+    EpochGuard guard;
+
     // 尝试获取文件描述符对应的上下文
     FdContext *fd_ctx = nullptr;
-    
-    // 先尝试读锁查找
-    std::shared_lock<std::shared_mutex> read_lock(m_mutex);
-    if ((int)m_fdContexts.size() > fd) 
+    std::unique_lock<std::mutex> lock;
+    while(true)
     {
-        fd_ctx = m_fdContexts[fd];
-        read_lock.unlock();
-    }
-    else 
-    {
-        // 上下文数组不够大，需要扩容
-        read_lock.unlock();
-        std::unique_lock<std::shared_mutex> write_lock(m_mutex);
-        // 扩容到fd*1.5的大小，确保有足够空间
-        contextResize(fd * 1.5);
-        fd_ctx = m_fdContexts[fd];
-    }
+        // 上下文数组不够大时扩容
+        fd_ctx = getFdContext(fd, true);
+        if(!fd_ctx)
+        {
+            return -1;
+        }
 
-    // 对文件描述符上下文加锁
-    std::lock_guard<std::mutex> lock(fd_ctx->mutex);
+        // 对文件描述符上下文加锁
+        lock = std::unique_lock<std::mutex>(fd_ctx->mutex);
+        if(!fd_ctx->retired)
+        {
+            break;
+        }
+        // 上下文正被收缩摘除，等待新表发布后重新查找
+        lock.unlock();
+        std::lock_guard<std::mutex> resize_lock(m_resizeMutex);
+    }
     
     // 检查事件是否已经注册
     if(fd_ctx->events & event) 
@@ -205,7 +341,7 @@ int IOManager::addEvent(int fd, Event event, std::function<void()> cb)
     int op = fd_ctx->events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
     epoll_event epevent;
     epevent.events   = EPOLLET | fd_ctx->events | event; // 边缘触发模式
-    epevent.data.ptr = fd_ctx;                           // 存储上下文指针
+    epevent.data.fd  = fd;                               // 存储文件描述符，就绪时重新查表
 
     // 更新epoll事件
     int rt = epoll_ctl(m_epfd, op, fd, &epevent);
@@ -246,18 +382,14 @@ int IOManager::addEvent(int fd, Event event, std::function<void()> cb)
  * @return 成功返回true，失败返回false
  */
 bool IOManager::delEvent(int fd, Event event) {
+    EpochGuard guard;
+
     // 尝试获取文件描述符对应的上下文
     FdContext *fd_ctx = nullptr;
     
-    std::shared_lock<std::shared_mutex> read_lock(m_mutex);
-    if ((int)m_fdContexts.size() > fd) 
+    fd_ctx = getFdContext(fd);
+    if(!fd_ctx)
     {
-        fd_ctx = m_fdContexts[fd];
-        read_lock.unlock();
-    }
-    else 
-    {
-        read_lock.unlock();
         return false; // 文件描述符不存在
     }
 
@@ -274,7 +406,7 @@ bool IOManager::delEvent(int fd, Event event) {
     int op           = new_events ? EPOLL_CTL_MOD : EPOLL_CTL_DEL; // 修改或删除
     epoll_event epevent;
     epevent.events   = EPOLLET | new_events;
-    epevent.data.ptr = fd_ctx;
+    epevent.data.fd  = fd;
 
     // 更新epoll事件
     int rt = epoll_ctl(m_epfd, op, fd, &epevent);
@@ -303,18 +435,14 @@ bool IOManager::delEvent(int fd, Event event) {
  * @return 成功返回true，失败返回false
  */
 bool IOManager::cancelEvent(int fd, Event event) {
+    EpochGuard guard;
+
     // 尝试获取文件描述符对应的上下文
     FdContext *fd_ctx = nullptr;
     
-    std::shared_lock<std::shared_mutex> read_lock(m_mutex);
-    if ((int)m_fdContexts.size() > fd) 
+    fd_ctx = getFdContext(fd);
+    if(!fd_ctx)
     {
-        fd_ctx = m_fdContexts[fd];
-        read_lock.unlock();
-    }
-    else 
-    {
-        read_lock.unlock();
         return false; // 文件描述符不存在
     }
 
@@ -331,7 +459,7 @@ bool IOManager::cancelEvent(int fd, Event event) {
     int op           = new_events ? EPOLL_CTL_MOD : EPOLL_CTL_DEL;
     epoll_event epevent;
     epevent.events   = EPOLLET | new_events;
-    epevent.data.ptr = fd_ctx;
+    epevent.data.fd  = fd;
 
     // 更新epoll事件
     int rt = epoll_ctl(m_epfd, op, fd, &epevent);
@@ -355,18 +483,14 @@ bool IOManager::cancelEvent(int fd, Event event) {
  * @return 成功返回true，失败返回false
  */
 bool IOManager::cancelAll(int fd) {
+    EpochGuard guard;
+
     // 尝试获取文件描述符对应的上下文
     FdContext *fd_ctx = nullptr;
     
-    std::shared_lock<std::shared_mutex> read_lock(m_mutex);
-    if ((int)m_fdContexts.size() > fd) 
+    fd_ctx = getFdContext(fd);
+    if(!fd_ctx)
     {
-        fd_ctx = m_fdContexts[fd];
-        read_lock.unlock();
-    }
-    else 
-    {
-        read_lock.unlock();
         return false; // 文件描述符不存在
     }
 
@@ -382,7 +506,7 @@ bool IOManager::cancelAll(int fd) {
     int op = EPOLL_CTL_DEL;
     epoll_event epevent;
     epevent.events   = 0;
-    epevent.data.ptr = fd_ctx;
+    epevent.data.fd  = fd;
 
     int rt = epoll_ctl(m_epfd, op, fd, &epevent);
     if (rt) 
@@ -410,6 +534,80 @@ bool IOManager::cancelAll(int fd) {
     return true;
 }
 
+/**
+ * @brief 挂起当前协程直到文件描述符上的事件就绪或超时
+ * @param fd 文件描述符
+ * @param event 事件类型（READ或WRITE）
+ * @param timeout_ms 超时时间（毫秒）
+ * @return 事件就绪返回0；超时返回-1且errno为ETIMEDOUT；注册事件失败返回-1
+ */
+int IOManager::waitEvent(int fd, Event event, uint64_t timeout_ms)
+{
+    // 超时标志，定时器回调通过弱引用访问，协程返回后回调不会再修改它；不设超时时不分配
+    std::shared_ptr<int> cancelled;
+    std::shared_ptr<Timer> timer;
+
+    if(timeout_ms != (uint64_t)-1)
+    {
+        cancelled = std::make_shared<int>(0);
+        std::weak_ptr<int> wcancelled(cancelled);
+        timer = addConditionTimer(timeout_ms, [wcancelled, fd, event, this]()
+        {
+            auto t = wcancelled.lock();
+            if(!t || *t)
+            {
+                return;
+            }
+            *t = ETIMEDOUT;
+            // 取消事件并触发一次，使协程恢复执行
+            cancelEvent(fd, event);
+        }, wcancelled);
+    }
+
+    if(addEvent(fd, event))
+    {
+        if(timer)
+        {
+            timer->cancel();
+        }
+        return -1;
+    }
+
+    // 让出执行权，等待事件就绪或超时
+    Fiber::GetThis()->yield();
+
+    if(timer)
+    {
+        timer->cancel();
+    }
+    if(cancelled && *cancelled)
+    {
+        errno = *cancelled;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 获取最近一次epoll报告文件描述符读就绪的时间
+ * @param fd 文件描述符
+ * @return 微秒时间戳（CLOCK_REALTIME），未就绪过返回0
+ */
+uint64_t IOManager::getReadReadyTime(int fd)
+{
+    EpochGuard guard;
+    FdContext *fd_ctx = nullptr;
+
+    fd_ctx = getFdContext(fd);
+    if(!fd_ctx)
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(fd_ctx->mutex);
+    return fd_ctx->readReadyTime;
+}
+
 /**
  * @brief 唤醒一个空闲线程
  * 用于当有新任务时通知工作线程
@@ -483,9 +681,29 @@ void IOManager::idle()
             }
         };
 
+        // 记录本批事件的就绪时间，用于接收延迟统计（每次唤醒只取一次时间）
+        uint64_t ready_time = 0;
+        if(rt > 0)
+        {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ready_time = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+        }
+
         // 处理所有超时的定时器回调
         std::vector<std::function<void()>> cbs;
         listExpiredCb(cbs);
+
+        // 导出指标：每次唤醒记录一次（唤醒事件也计入事件数）
+        if(MetricsThreadSlot* slot = MetricsRegion::GetThreadSlot())
+        {
+            slot->onPoll(rt > 0 ? rt : 0, cbs.size());
+            MetricsHeader* header = getMetricsRegion()->getHeader();
+            header->pending_events.store(m_pendingEventCount, std::memory_order_relaxed);
+            header->fd_contexts.store(FdMgr::GetInstance()->getContextCount(), std::memory_order_relaxed);
+            EpochGuard guard;
+            header->fd_table_size.store(m_fdContexts.load(std::memory_order_acquire)->size(), std::memory_order_relaxed);
+        }
         if(!cbs.empty()) 
         {
             for(const auto& cb : cbs)
@@ -509,8 +727,13 @@ void IOManager::idle()
                 continue;
             }
 
-            // 处理其他IO事件
-            FdContext *fd_ctx = (FdContext *)event.data.ptr;
+            // 处理其他IO事件（空闲协程运行时线程不在线，在纪元临界区内使用上下文）
+            EpochGuard guard;
+            FdContext *fd_ctx = getFdContext(event.data.fd);
+            if(!fd_ctx)
+            {
+                continue;
+            }
             std::lock_guard<std::mutex> lock(fd_ctx->mutex);
 
             // 将错误或挂起事件转换为对应的读或写事件
@@ -552,6 +775,7 @@ void IOManager::idle()
             // 触发读事件回调
             if (real_events & READ) 
             {
+                fd_ctx->readReadyTime = ready_time;
                 fd_ctx->triggerEvent(READ);
                 --m_pendingEventCount;
             }
@@ -0,0 +1,234 @@
+#include <mycoroutine/memory_pressure.h>  // 内存压力感知头文件
+#include <mycoroutine/hook.h>             // 原始系统调用
+#include <mycoroutine/buffer_pool.h>      // 缓冲池上限
+
+#include <sys/epoll.h>     // 内部epoll实例
+#include <fcntl.h>         // open
+#include <unistd.h>        // close/access
+#include <errno.h>         // errno
+#include <fstream>         // 读取/proc/self/cgroup
+
+namespace mycoroutine {
+
+/**
+ * @brief 选择PSI文件
+ * @details 进程位于cgroup v2中且该cgroup有可写的memory.pressure时使用它（容器内反映容器自己的内存上限），
+ *          否则使用系统级的/proc/pressure/memory
+ */
+static std::string default_pressure_path()
+{
+    std::ifstream cgroup("/proc/self/cgroup");
+    std::string line;
+    while(std::getline(cgroup, line))
+    {
+        // cgroup v2的条目形如"0::/system.slice/foo.service"
+        if(line.compare(0, 3, "0::") == 0)
+        {
+            std::string path = "/sys/fs/cgroup" + line.substr(3) + "/memory.pressure";
+            if(access(path.c_str(), R_OK | W_OK) == 0)
+            {
+                return path;
+            }
+        }
+    }
+    return "/proc/pressure/memory";
+}
+
+/**
+ * @brief 创建监视器并注册PSI触发器
+ * @param iom IO管理器
+ * @param config 配置
+ * @return 成功返回监视器，失败返回nullptr
+ */
+std::shared_ptr<MemoryPressureMonitor> MemoryPressureMonitor::Create(IOManager* iom, const MemoryPressureConfig& config)
+{
+    if(!iom || config.stall_us == 0 || config.stall_us > config.window_us)
+    {
+        errno = EINVAL;
+        return nullptr;
+    }
+
+    std::string path = config.path.empty() ? default_pressure_path() : config.path;
+    int psi_fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if(psi_fd < 0)
+    {
+        return nullptr;
+    }
+
+    // 写入触发器："some|full <停顿微秒> <窗口微秒>"，触发器的生命周期与该fd相同
+    std::string trigger = std::string(config.full ? "full " : "some ") + std::to_string(config.stall_us) + " " +
+                          std::to_string(config.window_us);
+    if(write_f(psi_fd, trigger.c_str(), trigger.size() + 1) < 0)
+    {
+        int err = errno;
+        close(psi_fd);
+        errno = err;
+        return nullptr;
+    }
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if(epfd < 0)
+    {
+        int err = errno;
+        close(psi_fd);
+        errno = err;
+        return nullptr;
+    }
+    epoll_event event;
+    event.events = EPOLLPRI | EPOLLET;
+    event.data.fd = psi_fd;
+    if(epoll_ctl(epfd, EPOLL_CTL_ADD, psi_fd, &event) < 0)
+    {
+        int err = errno;
+        close(epfd);
+        close(psi_fd);
+        errno = err;
+        return nullptr;
+    }
+
+    std::shared_ptr<MemoryPressureMonitor> monitor =
+        std::make_shared<MemoryPressureMonitor>(psi_fd, epfd, path, iom, config);
+    // 回调持有监视器的引用，stop()取消事件后引用随之释放
+    if(iom->addEvent(epfd, IOManager::READ, std::bind(&MemoryPressureMonitor::onReadable, monitor)))
+    {
+        return nullptr;
+    }
+    return monitor;
+}
+
+/**
+ * @brief 构造函数
+ */
+MemoryPressureMonitor::MemoryPressureMonitor(int psi_fd, int epfd, const std::string& path, IOManager* iom,
+                                             const MemoryPressureConfig& config):
+    m_psiFd(psi_fd), m_epfd(epfd), m_path(path), m_iom(iom), m_config(config)
+{
+}
+
+/**
+ * @brief 析构函数，关闭文件描述符（关闭PSI fd即注销触发器）
+ */
+MemoryPressureMonitor::~MemoryPressureMonitor()
+{
+    close(m_epfd);
+    close(m_psiFd);
+}
+
+/**
+ * @brief 取消READ事件和恢复定时器
+ */
+void MemoryPressureMonitor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_stopping)
+        {
+            return;
+        }
+        m_stopping = true;
+        if(m_recoverTimer)
+        {
+            m_recoverTimer->cancel();
+            m_recoverTimer.reset();
+        }
+        restoreLimits();
+    }
+
+    // onReadable()只在m_stopping为false时重新注册，所以这里取消后不会再有新的注册
+    m_iom->cancelEvent(m_epfd, IOManager::READ);
+}
+
+/**
+ * @brief 手动触发一次内存压力处理
+ */
+void MemoryPressureMonitor::trigger()
+{
+    m_triggers.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_stopping)
+        {
+            return;
+        }
+        // 压力期间把缓存上限降为0，释放后的内存不会马上又被缓存占回
+        if(!m_underPressure.load(std::memory_order_relaxed))
+        {
+            m_savedStackCache = Fiber::GetStackCacheSize();
+            m_savedBufferCache = BufferPool::GetMaxCached();
+            Fiber::SetStackCacheSize(0);
+            BufferPool::SetMaxCached(0);
+            m_iom->setCachePaused(true);
+            m_underPressure.store(true, std::memory_order_relaxed);
+            m_pressures.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // 每次触发都推迟压力解除的时间
+        if(m_recoverTimer)
+        {
+            m_recoverTimer->cancel();
+        }
+        m_recoverTimer = m_iom->addTimer(m_config.recover_ms, std::bind(&MemoryPressureMonitor::onRecover,
+                                         shared_from_this(), ++m_recoverGeneration));
+    }
+
+    // 压力持续时内核每个窗口最多触发一次，每次都重新释放期间积累的缓存
+    m_iom->trimCaches();
+}
+
+/**
+ * @brief 内部epoll fd可读时的回调
+ */
+void MemoryPressureMonitor::onReadable()
+{
+    // 取走内部epoll中的触发事件；边缘触发下一次触发只报告一次
+    epoll_event events[1];
+    int n;
+    do
+    {
+        n = epoll_wait(m_epfd, events, 1, 0);
+    } while(n < 0 && errno == EINTR);
+
+    if(n > 0)
+    {
+        trigger();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_stopping)
+    {
+        m_iom->addEvent(m_epfd, IOManager::READ, std::bind(&MemoryPressureMonitor::onReadable, shared_from_this()));
+    }
+}
+
+/**
+ * @brief 恢复定时器回调：压力解除
+ * @param generation 定时器的代数
+ */
+void MemoryPressureMonitor::onRecover(uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // 定时器已触发但回调尚未执行时又有新的触发，旧回调作废
+    if(generation != m_recoverGeneration || m_stopping)
+    {
+        return;
+    }
+    m_recoverTimer.reset();
+    restoreLimits();
+}
+
+/**
+ * @brief 恢复进入压力状态前的缓存上限
+ */
+void MemoryPressureMonitor::restoreLimits()
+{
+    if(!m_underPressure.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    Fiber::SetStackCacheSize(m_savedStackCache);
+    BufferPool::SetMaxCached(m_savedBufferCache);
+    m_iom->setCachePaused(false);
+    m_underPressure.store(false, std::memory_order_relaxed);
+}
+
+} // end namespace mycoroutine
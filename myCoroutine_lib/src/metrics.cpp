@@ -0,0 +1,332 @@
+#include <mycoroutine/metrics.h>
+
+#include <sys/mman.h>   // mmap
+#include <sys/stat.h>   // fstat
+#include <fcntl.h>      // open
+#include <unistd.h>     // ftruncate/getpid
+#include <dirent.h>     // opendir
+#include <signal.h>     // kill(pid, 0)
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>    // std::sort
+
+namespace mycoroutine {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "metrics counters must be lock free to live in shared memory");
+
+// 当前线程的槽位
+static thread_local MetricsThreadSlot* t_metrics_slot = nullptr;
+
+static const char* METRICS_PREFIX = "mycoroutine.";
+
+/**
+ * @brief 获取单调时钟的当前时间（纳秒）
+ */
+uint64_t metrics_now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief 计算映射长度
+ */
+static size_t region_size(size_t slots)
+{
+    return sizeof(MetricsHeader) + slots * sizeof(MetricsThreadSlot);
+}
+
+// ============================================================================
+// 写入端
+// ============================================================================
+
+/**
+ * @brief 创建共享内存指标文件
+ * @details 在临时文件中写好文件头后改名，读者只会看到完整的文件；失败时返回nullptr并设置errno
+ */
+std::unique_ptr<MetricsRegion> MetricsRegion::Create(const std::string& name, size_t slots, const std::string& dir)
+{
+    if(slots == 0)
+    {
+        errno = EINVAL;
+        return nullptr;
+    }
+
+    // 文件名中不能有'/'
+    std::string file_name = name;
+    std::replace(file_name.begin(), file_name.end(), '/', '_');
+    std::string path = dir + "/" + METRICS_PREFIX + file_name + "." + std::to_string(getpid());
+    std::string tmp = path + ".tmp";
+
+    // 先在临时文件中写好文件头再改名，读者不会看到不完整的文件
+    int fd = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0)
+    {
+        return nullptr;
+    }
+    size_t size = region_size(slots);
+    if(ftruncate(fd, size) < 0)
+    {
+        int err = errno;
+        close(fd);
+        unlink(tmp.c_str());
+        errno = err;
+        return nullptr;
+    }
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if(addr == MAP_FAILED)
+    {
+        unlink(tmp.c_str());
+        errno = err;
+        return nullptr;
+    }
+
+    // ftruncate后的内容全为0，即所有计数器的初始值
+    MetricsHeader* header = (MetricsHeader*)addr;
+    header->magic = METRICS_MAGIC;
+    header->version = METRICS_VERSION;
+    header->header_size = sizeof(MetricsHeader);
+    header->slot_size = sizeof(MetricsThreadSlot);
+    header->slot_count = slots;
+    header->pid = getpid();
+    header->start_ns = metrics_now_ns();
+    strncpy(header->name, name.c_str(), sizeof(header->name) - 1);
+
+    if(rename(tmp.c_str(), path.c_str()) < 0)
+    {
+        err = errno;
+        munmap(addr, size);
+        unlink(tmp.c_str());
+        errno = err;
+        return nullptr;
+    }
+
+    std::unique_ptr<MetricsRegion> region(new MetricsRegion());
+    region->m_path = path;
+    region->m_addr = addr;
+    region->m_size = size;
+    region->m_header = header;
+    region->m_slots = (MetricsThreadSlot*)((char*)addr + sizeof(MetricsHeader));
+    return region;
+}
+
+/**
+ * @brief 析构函数，删除指标文件并解除映射
+ */
+MetricsRegion::~MetricsRegion()
+{
+    unlink(m_path.c_str());
+    munmap(m_addr, m_size);
+}
+
+/**
+ * @brief 为线程分配一个槽位
+ * @return 槽位，槽位已用完时返回nullptr
+ */
+MetricsThreadSlot* MetricsRegion::acquireSlot(int thread_id)
+{
+    uint32_t index = m_header->next_slot.fetch_add(1, std::memory_order_relaxed);
+    if(index >= m_header->slot_count)
+    {
+        return nullptr;
+    }
+    MetricsThreadSlot* slot = &m_slots[index];
+    slot->beginWrite();
+    slot->start_ns.store(metrics_now_ns(), std::memory_order_relaxed);
+    slot->thread_id.store(thread_id, std::memory_order_relaxed);
+    slot->endWrite();
+    return slot;
+}
+
+/**
+ * @brief 获取当前线程的槽位
+ */
+MetricsThreadSlot* MetricsRegion::GetThreadSlot()
+{
+    return t_metrics_slot;
+}
+
+/**
+ * @brief 设置当前线程的槽位
+ */
+void MetricsRegion::SetThreadSlot(MetricsThreadSlot* slot)
+{
+    t_metrics_slot = slot;
+}
+
+// ============================================================================
+// 读取端
+// ============================================================================
+
+/**
+ * @brief 只读映射指标文件
+ * @details 检查魔数、版本和布局，不匹配时返回nullptr并在error中给出原因
+ */
+std::unique_ptr<MetricsReader> MetricsReader::Open(const std::string& path, std::string* error)
+{
+    auto fail = [&](const std::string& msg) -> std::unique_ptr<MetricsReader>
+    {
+        if(error)
+        {
+            *error = path + ": " + msg;
+        }
+        return nullptr;
+    };
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+    {
+        return fail(strerror(errno));
+    }
+    struct stat st;
+    if(fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(MetricsHeader))
+    {
+        close(fd);
+        return fail("not a metrics file");
+    }
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED)
+    {
+        return fail(strerror(errno));
+    }
+
+    std::unique_ptr<MetricsReader> reader(new MetricsReader());
+    reader->m_addr = addr;
+    reader->m_size = st.st_size;
+    reader->m_header = (const MetricsHeader*)addr;
+
+    const MetricsHeader* header = reader->m_header;
+    if(header->magic != METRICS_MAGIC)
+    {
+        return fail("not a metrics file");
+    }
+    if(header->version != METRICS_VERSION || header->header_size != sizeof(MetricsHeader) ||
+       header->slot_size != sizeof(MetricsThreadSlot))
+    {
+        return fail("unsupported version " + std::to_string(header->version));
+    }
+    if(region_size(header->slot_count) > reader->m_size)
+    {
+        return fail("truncated file");
+    }
+    reader->m_slots = (const MetricsThreadSlot*)((const char*)addr + sizeof(MetricsHeader));
+    return reader;
+}
+
+/**
+ * @brief 列出目录中的指标文件（跳过尚未改名的临时文件）
+ */
+std::vector<std::string> MetricsReader::List(const std::string& dir)
+{
+    std::vector<std::string> paths;
+    DIR* d = opendir(dir.c_str());
+    if(!d)
+    {
+        return paths;
+    }
+    size_t prefix_len = strlen(METRICS_PREFIX);
+    while(struct dirent* entry = readdir(d))
+    {
+        std::string file_name = entry->d_name;
+        if(file_name.compare(0, prefix_len, METRICS_PREFIX) == 0 &&
+           file_name.compare(file_name.size() - std::min<size_t>(file_name.size(), 4), 4, ".tmp") != 0)
+        {
+            paths.push_back(dir + "/" + file_name);
+        }
+    }
+    closedir(d);
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+/**
+ * @brief 析构函数，解除映射
+ */
+MetricsReader::~MetricsReader()
+{
+    munmap(m_addr, m_size);
+}
+
+/**
+ * @brief 读取一份快照
+ * @details 按序号锁读取每个槽位，忙碌时间由运行时间减去空闲时间得出
+ */
+void MetricsReader::read(MetricsSnapshot& snapshot) const
+{
+    snapshot.threads.clear();
+    snapshot.queued_tasks = m_header->queued_tasks.load(std::memory_order_relaxed);
+    snapshot.active_threads = m_header->active_threads.load(std::memory_order_relaxed);
+    snapshot.idle_threads = m_header->idle_threads.load(std::memory_order_relaxed);
+    snapshot.pending_events = m_header->pending_events.load(std::memory_order_relaxed);
+    snapshot.fd_contexts = m_header->fd_contexts.load(std::memory_order_relaxed);
+    snapshot.fd_table_size = m_header->fd_table_size.load(std::memory_order_relaxed);
+
+    uint32_t used = std::min(m_header->next_slot.load(std::memory_order_relaxed), m_header->slot_count);
+    for(uint32_t i = 0; i < used; ++i)
+    {
+        const MetricsThreadSlot& slot = m_slots[i];
+        MetricsThreadSnapshot t;
+        uint64_t start, idle_total, idle_since;
+        // 写入进程在写入中途退出时序号停在奇数，重试一定次数后接受当前值
+        for(int attempt = 0; ; ++attempt)
+        {
+            uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            bool stuck = attempt >= 100000;
+            if((seq & 1) && !stuck)
+            {
+                continue;
+            }
+            t.thread_id = (int)slot.thread_id.load(std::memory_order_relaxed);
+            t.tasks = slot.tasks.load(std::memory_order_relaxed);
+            t.switches = slot.switches.load(std::memory_order_relaxed);
+            t.epoll_waits = slot.epoll_waits.load(std::memory_order_relaxed);
+            t.epoll_events = slot.epoll_events.load(std::memory_order_relaxed);
+            t.timers_fired = slot.timers_fired.load(std::memory_order_relaxed);
+            start = slot.start_ns.load(std::memory_order_relaxed);
+            idle_total = slot.idle_ns.load(std::memory_order_relaxed);
+            idle_since = slot.idle_since_ns.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(slot.seq.load(std::memory_order_relaxed) == seq || stuck)
+            {
+                break;
+            }
+        }
+        if(t.thread_id == 0)
+        {
+            // 已分配但尚未初始化
+            continue;
+        }
+
+        // 在读完槽位之后取时间，保证 now >= idle_since
+        uint64_t now = metrics_now_ns();
+        t.idle = idle_since != 0;
+        t.idle_ns = idle_total + (t.idle && now > idle_since ? now - idle_since : 0);
+        uint64_t elapsed = now > start ? now - start : 0;
+        t.busy_ns = elapsed > t.idle_ns ? elapsed - t.idle_ns : 0;
+        snapshot.threads.push_back(t);
+    }
+    snapshot.time_ns = metrics_now_ns();
+}
+
+/**
+ * @brief 写入进程是否仍在运行
+ */
+bool MetricsReader::isAlive() const
+{
+    return kill((pid_t)m_header->pid, 0) == 0 || errno == EPERM;
+}
+
+/**
+ * @brief 获取调度器名称
+ */
+std::string MetricsReader::getName() const
+{
+    return std::string(m_header->name, strnlen(m_header->name, sizeof(m_header->name)));
+}
+
+} // end namespace mycoroutine
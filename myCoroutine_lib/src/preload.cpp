@@ -0,0 +1,377 @@
+/**
+ * @file preload.cpp
+ * @brief LD_PRELOAD入口
+ * @details 与运行时的全部源文件一起编译为libmycoroutine_preload.so。预加载到未修改的程序后：
+ *          - hook.cpp中的系统调用钩子覆盖libc的同名函数
+ *          - 启动一个隐藏的IOManager
+ *          - 按配置把main()和pthread_create()创建的线程改为在IOManager中运行的协程；
+ *            工作线程启用了钩子，这些协程中阻塞的套接字IO和sleep由此变为协程切换
+ *
+ *          环境变量：
+ *          MYCOROUTINE_THREADS       工作线程数，默认为CPU核数
+ *          MYCOROUTINE_FIBER_MAIN    为0时main()仍在主线程中运行，默认1
+ *          MYCOROUTINE_FIBER_THREADS 为0时pthread_create()创建真正的线程，默认1
+ *          MYCOROUTINE_STACK_SIZE    协程栈大小（字节），默认8MB（与线程默认栈相同，按需分配物理页）；
+ *                                    pthread_attr中指定了栈大小时使用指定值
+ */
+
+#include <mycoroutine/iomanager.h>   // IO管理器
+#include <mycoroutine/fiber_sync.h>  // 协程条件变量（pthread_join）
+
+#include <dlfcn.h>              // dlsym
+#include <pthread.h>            // pthread_create/pthread_join
+#include <unistd.h>             // sysconf
+#include <stdlib.h>             // getenv
+#include <mutex>                // 互斥锁
+#include <condition_variable>   // 非协程线程的join
+#include <unordered_set>        // 协程线程句柄
+#include <memory>               // 智能指针
+
+namespace mycoroutine {
+
+/**
+ * @brief 预加载配置
+ */
+struct PreloadConfig
+{
+    size_t threads = 1;                     // 工作线程数
+    bool fiber_main = true;                 // main()是否作为协程运行
+    bool fiber_threads = true;              // pthread_create()是否创建协程
+    size_t stack_size = 8 * 1024 * 1024;    // 协程栈大小
+};
+
+/**
+ * @brief 以协程运行的“线程”
+ * @details 指针本身作为pthread_t句柄返回给程序
+ */
+struct FiberThread
+{
+    void* (*start)(void*) = nullptr;        // 线程入口
+    void* arg = nullptr;                    // 入口参数
+    void* retval = nullptr;                 // 返回值
+    std::mutex mutex;                       // 保护以下状态
+    std::condition_variable cond;           // 唤醒非协程线程中的join
+    FiberCondition fiber_cond;              // 唤醒协程中的join
+    bool done = false;                      // 是否已结束
+    bool detached = false;                  // 是否已分离
+};
+
+typedef int (*pthread_create_fun)(pthread_t*, const pthread_attr_t*, void* (*)(void*), void*);
+typedef int (*pthread_join_fun)(pthread_t, void**);
+typedef int (*pthread_detach_fun)(pthread_t);
+typedef int (*pthread_setname_np_fun)(pthread_t, const char*);
+typedef int (*main_fun)(int, char**, char**);
+typedef int (*libc_start_main_fun)(main_fun, int, char**, void (*)(void), void (*)(void), void (*)(void), void*);
+
+static pthread_create_fun s_pthread_create = nullptr;
+static pthread_join_fun s_pthread_join = nullptr;
+static pthread_detach_fun s_pthread_detach = nullptr;
+static pthread_setname_np_fun s_pthread_setname_np = nullptr;
+static main_fun s_main = nullptr;
+
+static PreloadConfig s_config;
+static IOManager* s_iom = nullptr;
+static std::once_flag s_iomOnce;
+
+static std::mutex s_handlesMutex;
+static std::unordered_set<FiberThread*>* s_handles = new std::unordered_set<FiberThread*>();  // 有意不析构
+
+// 当前线程是否为引导线程：其中的pthread_create用于创建调度器工作线程，不改写
+static thread_local bool t_internal = false;
+
+/**
+ * @brief 读取布尔型环境变量
+ */
+static bool env_bool(const char* name, bool def)
+{
+    const char* v = getenv(name);
+    return v && *v ? !(v[0] == '0' && v[1] == '\0') : def;
+}
+
+/**
+ * @brief 读取整型环境变量
+ */
+static size_t env_size(const char* name, size_t def)
+{
+    const char* v = getenv(name);
+    if(!v || !*v)
+    {
+        return def;
+    }
+    size_t n = strtoull(v, nullptr, 10);
+    return n ? n : def;
+}
+
+/**
+ * @brief 解析原始函数与配置（库加载时执行）
+ */
+__attribute__((constructor)) static void preload_init()
+{
+    s_pthread_create = (pthread_create_fun)dlsym(RTLD_NEXT, "pthread_create");
+    s_pthread_join = (pthread_join_fun)dlsym(RTLD_NEXT, "pthread_join");
+    s_pthread_detach = (pthread_detach_fun)dlsym(RTLD_NEXT, "pthread_detach");
+    s_pthread_setname_np = (pthread_setname_np_fun)dlsym(RTLD_NEXT, "pthread_setname_np");
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    s_config.threads = env_size("MYCOROUTINE_THREADS", cpus > 0 ? cpus : 1);
+    s_config.fiber_main = env_bool("MYCOROUTINE_FIBER_MAIN", true);
+    s_config.fiber_threads = env_bool("MYCOROUTINE_FIBER_THREADS", true);
+    s_config.stack_size = env_size("MYCOROUTINE_STACK_SIZE", s_config.stack_size);
+}
+
+/**
+ * @brief 引导线程：创建IOManager，工作线程启用钩子
+ * @details 在单独的线程中构造，调度器不会改写程序主线程的线程名和线程局部的调度器指针
+ */
+static void* bootstrap(void*)
+{
+    t_internal = true;
+    WarmupConfig warmup;
+    warmup.hook_enable = true;
+    s_iom = new IOManager(s_config.threads, false, "mycoroutine_preload", warmup);
+    return nullptr;
+}
+
+/**
+ * @brief 获取隐藏的IOManager，首次调用时创建（有意不析构，进程退出时随之结束）
+ */
+static IOManager* preload_iom()
+{
+    std::call_once(s_iomOnce, []()
+    {
+        pthread_t tid;
+        if(s_pthread_create(&tid, nullptr, &bootstrap, nullptr) == 0)
+        {
+            s_pthread_join(tid, nullptr);
+        }
+    });
+    return s_iom;
+}
+
+/**
+ * @brief 在IOManager中以协程运行cb
+ * @param cb 协程入口
+ * @param stack_size 栈大小
+ */
+static void spawn_fiber(std::function<void()> cb, size_t stack_size)
+{
+    s_iom->scheduleLock(Fiber::Create(cb, stack_size));
+}
+
+/**
+ * @brief 查找并注销协程线程句柄
+ * @param remove 是否注销
+ * @return 是协程线程句柄时返回对象，否则返回nullptr
+ */
+static FiberThread* find_handle(pthread_t thread, bool remove)
+{
+    FiberThread* ft = (FiberThread*)thread;
+    std::lock_guard<std::mutex> lock(s_handlesMutex);
+    auto it = s_handles->find(ft);
+    if(it == s_handles->end())
+    {
+        return nullptr;
+    }
+    if(remove)
+    {
+        s_handles->erase(it);
+    }
+    return ft;
+}
+
+/**
+ * @brief 协程线程入口
+ */
+static void run_fiber_thread(FiberThread* ft)
+{
+    void* retval = ft->start(ft->arg);
+
+    bool detached;
+    {
+        std::lock_guard<std::mutex> lock(ft->mutex);
+        ft->retval = retval;
+        ft->done = true;
+        detached = ft->detached;
+        ft->cond.notify_all();
+        ft->fiber_cond.notifyAll();
+    }
+    if(detached)
+    {
+        delete ft;
+    }
+}
+
+/**
+ * @brief 包装后的main：在IOManager中以协程运行，主线程等待其返回
+ */
+static int fiber_main(int argc, char** argv, char** envp)
+{
+    if(!s_config.fiber_main || !preload_iom())
+    {
+        return s_main(argc, argv, envp);
+    }
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool done = false;
+    int rc = 0;
+    spawn_fiber([&]()
+    {
+        int r = s_main(argc, argv, envp);
+        std::lock_guard<std::mutex> lock(mutex);
+        rc = r;
+        done = true;
+        cond.notify_all();
+    }, s_config.stack_size);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [&]() {return done;});
+    // 返回后__libc_start_main调用exit(rc)，与原程序从main返回的行为一致
+    return rc;
+}
+
+} // end namespace mycoroutine
+
+using namespace mycoroutine;
+
+extern "C"
+{
+
+/**
+ * @brief 程序入口钩子：记录真正的main，换成fiber_main
+ */
+int __libc_start_main(main_fun main, int argc, char** argv, void (*init)(void), void (*fini)(void),
+                      void (*rtld_fini)(void), void* stack_end)
+{
+    libc_start_main_fun real = (libc_start_main_fun)dlsym(RTLD_NEXT, "__libc_start_main");
+    s_main = main;
+    return real(&fiber_main, argc, argv, init, fini, rtld_fini, stack_end);
+}
+
+/**
+ * @brief pthread_create钩子：按配置创建协程而不是线程
+ * @details 运行时内部线程、IOManager尚未创建成功时，以及MYCOROUTINE_FIBER_THREADS=0时创建真正的线程
+ */
+int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*start)(void*), void* arg)
+{
+    if(!s_pthread_create)
+    {
+        preload_init();
+    }
+    if(t_internal || !s_config.fiber_threads || !preload_iom())
+    {
+        return s_pthread_create(thread, attr, start, arg);
+    }
+
+    size_t stack_size = s_config.stack_size;
+    if(attr)
+    {
+        size_t size = 0;
+        if(pthread_attr_getstacksize(attr, &size) == 0 && size)
+        {
+            stack_size = size;
+        }
+    }
+
+    FiberThread* ft = new FiberThread();
+    ft->start = start;
+    ft->arg = arg;
+    int detach_state = PTHREAD_CREATE_JOINABLE;
+    if(attr && pthread_attr_getdetachstate(attr, &detach_state) == 0 && detach_state == PTHREAD_CREATE_DETACHED)
+    {
+        ft->detached = true;
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(s_handlesMutex);
+        s_handles->insert(ft);
+    }
+
+    *thread = (pthread_t)ft;
+    spawn_fiber(std::bind(&run_fiber_thread, ft), stack_size);
+    return 0;
+}
+
+/**
+ * @brief pthread_join钩子：等待协程线程结束
+ * @details 在协程中只挂起当前协程，在普通线程中阻塞等待
+ */
+int pthread_join(pthread_t thread, void** retval)
+{
+    if(!s_pthread_join)
+    {
+        preload_init();
+    }
+    FiberThread* ft = find_handle(thread, true);
+    if(!ft)
+    {
+        return s_pthread_join(thread, retval);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(ft->mutex);
+        while(!ft->done)
+        {
+            if(Scheduler::GetThis() == s_iom)
+            {
+                ft->fiber_cond.wait(lock);
+            }
+            else
+            {
+                ft->cond.wait(lock);
+            }
+        }
+        if(retval)
+        {
+            *retval = ft->retval;
+        }
+    }
+    delete ft;
+    return 0;
+}
+
+/**
+ * @brief pthread_detach钩子：协程线程结束后自行释放
+ */
+int pthread_detach(pthread_t thread)
+{
+    if(!s_pthread_detach)
+    {
+        preload_init();
+    }
+    FiberThread* ft = find_handle(thread, true);
+    if(!ft)
+    {
+        return s_pthread_detach(thread);
+    }
+
+    bool done;
+    {
+        std::lock_guard<std::mutex> lock(ft->mutex);
+        done = ft->done;
+        ft->detached = true;
+    }
+    if(done)
+    {
+        delete ft;
+    }
+    return 0;
+}
+
+/**
+ * @brief pthread_setname_np钩子：协程线程没有内核线程可命名，直接忽略
+ */
+int pthread_setname_np(pthread_t thread, const char* name)
+{
+    if(!s_pthread_setname_np)
+    {
+        preload_init();
+    }
+    if(find_handle(thread, false))
+    {
+        return 0;
+    }
+    return s_pthread_setname_np(thread, name);
+}
+
+} // extern "C"
@@ -0,0 +1,486 @@
+#include <mycoroutine/process.h>     // 子进程管理头文件
+#include <mycoroutine/fiber_sync.h>  // 协程条件变量（communicate汇合）
+#include <mycoroutine/hook.h>        // 原始系统调用
+#include <mycoroutine/utils.h>       // steady_ms
+
+#include <spawn.h>         // posix_spawnp
+#include <fcntl.h>         // pipe2/fcntl
+#include <unistd.h>        // close
+#include <signal.h>        // sigset_t
+#include <sys/wait.h>      // waitpid
+#include <sys/syscall.h>   // SYS_pidfd_open
+#include <errno.h>         // errno
+#include <algorithm>       // std::min
+
+extern char** environ;
+
+namespace mycoroutine {
+
+/**
+ * @brief 获取当前线程的IO管理器
+ * @return 不在IOManager中时返回nullptr并设置errno为EAGAIN（与hook后的IO一致：无法挂起等待）
+ */
+static IOManager* current_iom()
+{
+    IOManager* iom = IOManager::GetThis();
+    if(!iom)
+    {
+        errno = EAGAIN;
+    }
+    return iom;
+}
+
+/**
+ * @brief 挂起当前协程指定时间
+ * @param ms 毫秒
+ * @return 成功返回0，不在IOManager中返回-1
+ */
+static int fiber_sleep(uint64_t ms)
+{
+    IOManager* iom = current_iom();
+    if(!iom)
+    {
+        return -1;
+    }
+    std::shared_ptr<Fiber> fiber = Fiber::GetThis();
+    iom->addTimer(ms, [fiber, iom](){iom->scheduleLock(fiber, -1);});
+    fiber->yield();
+    return 0;
+}
+
+/**
+ * @brief 打开进程文件描述符
+ * @return 成功返回pidfd，内核不支持（ENOSYS）或失败返回-1
+ */
+static int open_pidfd(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    // pidfd_open返回的fd默认带有O_CLOEXEC
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    return -1;
+#endif
+}
+
+/**
+ * @brief 关闭一对管道中仍然打开的端
+ */
+static void close_pipe(int fds[2])
+{
+    for(int i = 0; i < 2; ++i)
+    {
+        if(fds[i] >= 0)
+        {
+            close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+
+/**
+ * @brief 创建子进程
+ * @param argv 命令及参数
+ * @param options 启动参数
+ * @return 成功返回进程对象，失败返回nullptr
+ */
+std::shared_ptr<Process> Process::Spawn(const std::vector<std::string>& argv, const ProcessOptions& options)
+{
+    if(argv.empty())
+    {
+        errno = EINVAL;
+        return nullptr;
+    }
+
+    // 1 创建管道：两端都带O_CLOEXEC，子进程中dup2到0/1/2的那一端会清除该标志
+    int in[2] = {-1, -1}, out[2] = {-1, -1}, err[2] = {-1, -1};
+    if((options.pipe_stdin && pipe2(in, O_CLOEXEC) < 0) ||
+       (options.pipe_stdout && pipe2(out, O_CLOEXEC) < 0) ||
+       (options.pipe_stderr && pipe2(err, O_CLOEXEC) < 0))
+    {
+        int saved = errno;
+        close_pipe(in);
+        close_pipe(out);
+        close_pipe(err);
+        errno = saved;
+        return nullptr;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if(in[0] >= 0)  posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+    if(out[1] >= 0) posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+    if(err[1] >= 0) posix_spawn_file_actions_adddup2(&actions, err[1], STDERR_FILENO);
+    if(!options.cwd.empty())
+    {
+        posix_spawn_file_actions_addchdir_np(&actions, options.cwd.c_str());
+    }
+
+    // 2 子进程清空信号屏蔽字，SIGPIPE恢复默认处理
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t mask, defaults;
+    sigemptyset(&mask);
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    std::vector<char*> args;
+    for(const std::string& arg : argv)
+    {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    std::vector<char*> envs;
+    char** envp = environ;
+    if(!options.env.empty())
+    {
+        for(const std::string& e : options.env)
+        {
+            envs.push_back(const_cast<char*>(e.c_str()));
+        }
+        envs.push_back(nullptr);
+        envp = envs.data();
+    }
+
+    // 3 创建子进程（glibc使用CLONE_VFORK，不复制父进程页表）
+    pid_t pid = -1;
+    int rt = posix_spawnp(&pid, args[0], &actions, &attr, args.data(), envp);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    // 关闭子进程使用的一端
+    if(in[0] >= 0)  {close(in[0]);  in[0] = -1;}
+    if(out[1] >= 0) {close(out[1]); out[1] = -1;}
+    if(err[1] >= 0) {close(err[1]); err[1] = -1;}
+
+    if(rt != 0)
+    {
+        close_pipe(in);
+        close_pipe(out);
+        close_pipe(err);
+        errno = rt;
+        return nullptr;
+    }
+
+    // 4 父进程一端设为非阻塞，由waitEvent等待就绪
+    for(int fd : {in[1], out[0], err[0]})
+    {
+        if(fd >= 0)
+        {
+            fcntl_f(fd, F_SETFL, fcntl_f(fd, F_GETFL, 0) | O_NONBLOCK);
+        }
+    }
+
+    return std::make_shared<Process>(pid, open_pidfd(pid), in[1], out[0], err[0]);
+}
+
+/**
+ * @brief 构造函数
+ */
+Process::Process(pid_t pid, int pidfd, int in, int out, int err):
+    m_pid(pid), m_pidfd(pidfd), m_stdin(in), m_stdout(out), m_stderr(err)
+{
+}
+
+/**
+ * @brief 析构函数，关闭管道和pidfd，回收已退出的子进程
+ */
+Process::~Process()
+{
+    // 子进程已经退出时顺便回收，不留下僵尸进程；仍在运行时不等待
+    if(!m_exited)
+    {
+        reap();
+    }
+    for(int fd : {m_stdin, m_stdout, m_stderr, m_pidfd})
+    {
+        if(fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+/**
+ * @brief 向标准输入写入全部数据
+ * @param data 数据
+ * @param len 数据长度
+ * @return 成功返回len，失败返回-1
+ */
+ssize_t Process::write(const void* data, size_t len)
+{
+    if(m_stdin < 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    const char* p = (const char*)data;
+    size_t left = len;
+    while(left)
+    {
+        ssize_t n = write_f(m_stdin, p, left);
+        if(n > 0)
+        {
+            p += n;
+            left -= n;
+            continue;
+        }
+        if(n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n < 0 && errno == EAGAIN)
+        {
+            IOManager* iom = current_iom();
+            if(iom && iom->waitEvent(m_stdin, IOManager::WRITE) == 0)
+            {
+                continue;
+            }
+        }
+        return -1;
+    }
+    return len;
+}
+
+/**
+ * @brief 关闭标准输入
+ */
+void Process::closeStdin()
+{
+    if(m_stdin >= 0)
+    {
+        close(m_stdin);
+        m_stdin = -1;
+    }
+}
+
+/**
+ * @brief 从标准输出或标准错误读取数据
+ * @param stream STDOUT或STDERR
+ * @param buf 缓冲区
+ * @param len 缓冲区大小
+ * @param timeout_ms 超时时间（毫秒）
+ * @return 读取的字节数，0表示EOF，-1表示出错或超时
+ */
+ssize_t Process::read(Stream stream, void* buf, size_t len, uint64_t timeout_ms)
+{
+    int fd = stream == STDOUT ? m_stdout : m_stderr;
+    if(fd < 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    while(true)
+    {
+        ssize_t n = read_f(fd, buf, len);
+        if(n >= 0)
+        {
+            return n;
+        }
+        if(errno == EINTR)
+        {
+            continue;
+        }
+        if(errno != EAGAIN)
+        {
+            return -1;
+        }
+        IOManager* iom = current_iom();
+        if(!iom || iom->waitEvent(fd, IOManager::READ, timeout_ms))
+        {
+            return -1;
+        }
+    }
+}
+
+/**
+ * @brief 读取直到EOF
+ * @param stream STDOUT或STDERR
+ * @param out 输出参数
+ * @return 读到EOF返回true，出错返回false
+ */
+bool Process::readAll(Stream stream, std::string& out)
+{
+    char buf[16384];
+    while(true)
+    {
+        ssize_t n = read(stream, buf, sizeof(buf));
+        if(n <= 0)
+        {
+            return n == 0;
+        }
+        out.append(buf, n);
+    }
+}
+
+/**
+ * @brief 非阻塞回收子进程
+ * @return 已回收返回1，仍在运行返回0，出错返回-1（例如ECHILD：SIGCHLD被忽略时内核已自动回收）
+ */
+int Process::reap()
+{
+    if(m_exited)
+    {
+        return 1;
+    }
+
+    int status = 0;
+    pid_t rt;
+    do
+    {
+        rt = waitpid(m_pid, &status, WNOHANG);
+    } while(rt < 0 && errno == EINTR);
+
+    if(rt == m_pid)
+    {
+        m_exited = true;
+        m_status = status;
+        return 1;
+    }
+    return rt < 0 ? -1 : 0;
+}
+
+/**
+ * @brief 等待子进程退出并回收
+ * @param timeout_ms 超时时间（毫秒）
+ * @return 退出码；被信号终止返回128+信号值；超时或出错返回-1
+ */
+int Process::wait(uint64_t timeout_ms)
+{
+    uint64_t deadline = timeout_ms == (uint64_t)-1 ? (uint64_t)-1 : steady_ms() + timeout_ms;
+    uint64_t interval = 1;
+    int rt;
+    while((rt = reap()) == 0)
+    {
+        uint64_t now = steady_ms();
+        if(now >= deadline)
+        {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+
+        if(m_pidfd >= 0)
+        {
+            // pidfd在进程退出时变为可读
+            uint64_t left = deadline == (uint64_t)-1 ? (uint64_t)-1 : deadline - now;
+            IOManager* iom = current_iom();
+            if(!iom || iom->waitEvent(m_pidfd, IOManager::READ, left))
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            // 没有pidfd：定时轮询，间隔从1ms逐步退避到50ms
+            if(fiber_sleep(std::min(interval, deadline - now)))
+            {
+                return -1;
+            }
+            interval = std::min<uint64_t>(interval * 2, 50);
+        }
+    }
+    if(rt < 0)
+    {
+        return -1;
+    }
+
+    if(WIFEXITED(m_status))
+    {
+        return WEXITSTATUS(m_status);
+    }
+    if(WIFSIGNALED(m_status))
+    {
+        return 128 + WTERMSIG(m_status);
+    }
+    return -1;
+}
+
+/**
+ * @brief 写入输入、同时读取标准输出和标准错误直到EOF，然后等待退出
+ * @param input 写入标准输入的数据
+ * @param out 输出参数，标准输出
+ * @param err 输出参数，标准错误
+ * @return 同wait()
+ */
+int Process::communicate(const std::string& input, std::string& out, std::string& err)
+{
+    IOManager* iom = current_iom();
+    if(!iom)
+    {
+        return -1;
+    }
+    std::mutex mutex;
+    FiberCondition cond;
+    int pending = (m_stdin >= 0) + (m_stderr >= 0);
+
+    auto done = [&]()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(--pending == 0)
+        {
+            cond.notifyAll();
+        }
+    };
+
+    if(m_stdin >= 0)
+    {
+        iom->scheduleLock([&]()
+        {
+            if(!input.empty())
+            {
+                write(input.data(), input.size());
+            }
+            closeStdin();
+            done();
+        });
+    }
+    if(m_stderr >= 0)
+    {
+        iom->scheduleLock([&]()
+        {
+            readAll(STDERR, err);
+            done();
+        });
+    }
+    if(m_stdout >= 0)
+    {
+        readAll(STDOUT, out);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(pending)
+        {
+            cond.wait(lock);
+        }
+    }
+    return wait();
+}
+
+/**
+ * @brief 向子进程发送信号
+ * @param sig 信号
+ * @return 成功返回true
+ */
+bool Process::kill(int sig)
+{
+    if(m_exited)
+    {
+        return false;
+    }
+#ifdef SYS_pidfd_send_signal
+    if(m_pidfd >= 0)
+    {
+        return syscall(SYS_pidfd_send_signal, m_pidfd, sig, nullptr, 0) == 0;
+    }
+#endif
+    return ::kill(m_pid, sig) == 0;
+}
+
+} // end namespace mycoroutine
@@ -1,13 +1,27 @@
 #include <mycoroutine/scheduler.h>
+#include <mycoroutine/buffer_pool.h>  // 预热读缓冲区
+#include <mycoroutine/epoch.h>        // 纪元回收（调度循环是静止点）
+#include <mycoroutine/hook.h>         // 调度线程启用钩子
+#include <mycoroutine/metrics.h>      // 共享内存指标
+#include <malloc.h>                   // malloc_trim
 
 // 调试开关，设置为true可以输出更多调试信息
-static bool debug = true;
+static bool debug = false;
 
 namespace mycoroutine {
 
 // 线程局部存储，指向当前线程的调度器实例
 static thread_local Scheduler* t_scheduler = nullptr;
 
+// 线程局部存储，t_scheduler是IOManager时指向它，总是与t_scheduler一起更新
+static thread_local IOManager* t_io_manager = nullptr;
+
+// 当前线程已领取槽位的指标区域
+static thread_local MetricsRegion* t_metrics = nullptr;
+
+// 线程局部的回调协程池，执行完毕的回调协程放回池中复用，避免每个任务重新分配协程和栈
+static thread_local std::vector<std::shared_ptr<Fiber>> t_fiber_pool;
+
 /**
  * @brief 获取当前线程的调度器实例
  * @return 当前线程的调度器指针
@@ -23,6 +37,29 @@ Scheduler* Scheduler::GetThis()
 void Scheduler::SetThis()
 {
     t_scheduler = this;
+    t_io_manager = m_ioManager;
+}
+
+/**
+ * @brief 获取当前线程的IO管理器
+ * @return IO管理器指针，当前线程的调度器不是IOManager时为nullptr
+ */
+IOManager* Scheduler::GetThisIOManager()
+{
+    return t_io_manager;
+}
+
+/**
+ * @brief 登记派生的IO管理器
+ * @param iom IO管理器
+ */
+void Scheduler::setIOManager(IOManager* iom)
+{
+    m_ioManager = iom;
+    if(t_scheduler == this)
+    {
+        t_io_manager = iom;
+    }
 }
 
 /**
@@ -34,17 +71,19 @@ void Scheduler::SetThis()
 Scheduler::Scheduler(size_t threads, bool use_caller, const std::string &name):
     m_name(name), m_useCaller(use_caller)
 {
-    assert(threads>0 && Scheduler::GetThis()==nullptr);
-
-    // 设置当前线程的调度器
-    SetThis();
-
-    // 设置线程名称
-    Thread::SetName(m_name);
+    assert(threads>0);
 
     // 使用主线程当作工作线程
     if(use_caller)
     {
+        assert(Scheduler::GetThis()==nullptr);
+
+        // 设置当前线程的调度器；不使用调用者线程时它不属于本调度器，不改写其调度器指针和线程名
+        SetThis();
+
+        // 设置线程名称
+        Thread::SetName(m_name);
+
         // 主线程也作为工作线程，所以额外创建的线程数减1
         threads --;
 
@@ -52,7 +91,7 @@ Scheduler::Scheduler(size_t threads, bool use_caller, const std::string &name):
         Fiber::GetThis();
 
         // 创建调度协程，参数为run函数，栈大小为0（使用默认值），false表示该协程退出后返回主协程
-        m_schedulerFiber.reset(new Fiber(std::bind(&Scheduler::run, this), 0, false)); 
+        m_schedulerFiber = Fiber::Create(std::bind(&Scheduler::run, this), 0, false);
         Fiber::SetSchedulerFiber(m_schedulerFiber.get());
         
         // 记录主线程ID
@@ -74,6 +113,7 @@ Scheduler::~Scheduler()
     if (GetThis() == this) 
     {
         t_scheduler = nullptr;
+        t_io_manager = nullptr;
     }
     if(debug) std::cout << "Scheduler::~Scheduler() success\n";
 }
@@ -84,25 +124,168 @@ Scheduler::~Scheduler()
  */
 void Scheduler::start()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if(m_stopping)
     {
-        std::cerr << "Scheduler is stopped" << std::endl;
-        return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_stopping)
+        {
+            std::cerr << "Scheduler is stopped" << std::endl;
+            return;
+        }
+
+        assert(m_threads.empty());
+        // 调整线程池大小
+        m_threads.resize(m_threadCount);
+        for(size_t i=0;i<m_threadCount;i++)
+        {
+            // 创建工作线程，每个线程执行run函数
+            m_threads[i].reset(new Thread(std::bind(&Scheduler::run, this), m_name + "_" + std::to_string(i)));
+            m_threadIds.push_back(m_threads[i]->getId());
+        }
     }
 
-    assert(m_threads.empty());
-    // 调整线程池大小
-    m_threads.resize(m_threadCount);
+    // 等待所有工作线程完成预热，start()返回后第一批任务不会再撞上冷启动开销；
+    // 等待时不持有m_mutex，预热期间其他线程仍可以投递任务或导出指标
     for(size_t i=0;i<m_threadCount;i++)
     {
-        // 创建工作线程，每个线程执行run函数
-        m_threads[i].reset(new Thread(std::bind(&Scheduler::run, this), m_name + "_" + std::to_string(i)));
-        m_threadIds.push_back(m_threads[i]->getId());
+        m_warmupSem.wait();
+    }
+    if(m_useCaller)
+    {
+        warmupThread(false);
     }
     if(debug) std::cout << "Scheduler::start() success\n";
 }
 
+/**
+ * @brief 设置启动预热配置
+ * @param warmup 预热配置
+ */
+void Scheduler::setWarmup(const WarmupConfig& warmup)
+{
+    m_warmup = warmup;
+    if(m_warmup.fiber_stacks)
+    {
+        Fiber::SetStackCacheSize(m_warmup.fiber_stacks);
+    }
+}
+
+/**
+ * @brief 预热当前线程的线程局部结构
+ * @param worker 是否是线程池中的工作线程
+ */
+void Scheduler::warmupThread(bool worker)
+{
+    // 回调协程池：每个协程运行一次空函数，使其进入TERM状态以便reset复用
+    while(worker && t_fiber_pool.size() < m_warmup.pooled_fibers)
+    {
+        std::shared_ptr<Fiber> fiber = Fiber::Create([](){});
+        fiber->resume();
+        t_fiber_pool.push_back(fiber);
+    }
+    if(m_warmup.fiber_stacks)
+    {
+        Fiber::PrefaultStacks(m_warmup.fiber_stacks);
+    }
+    if(m_warmup.read_buffers)
+    {
+        BufferPool::Reserve(m_warmup.read_buffers);
+    }
+    if(m_warmup.hook_enable)
+    {
+        set_hook_enable(true);
+    }
+}
+
+/**
+ * @brief 获取线程池中工作线程的ID
+ * @return 工作线程ID列表（不包含调用者线程）
+ */
+std::vector<int> Scheduler::getWorkerThreadIds()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<int> ids;
+    for(auto& thread : m_threads)
+    {
+        ids.push_back(thread->getId());
+    }
+    return ids;
+}
+
+/**
+ * @brief 导出运行时计数器到共享内存
+ * @param slots 最多记录的线程数
+ * @param dir 文件所在目录
+ * @return 文件路径，失败返回空字符串
+ */
+std::string Scheduler::exportMetrics(size_t slots, const std::string& dir)
+{
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_metricsOwner)
+        {
+            return m_metricsOwner->getPath();
+        }
+        m_metricsOwner = MetricsRegion::Create(m_name, slots, dir);
+        if(!m_metricsOwner)
+        {
+            return "";
+        }
+        m_metrics.store(m_metricsOwner.get(), std::memory_order_release);
+        for(auto& thread : m_threads)
+        {
+            ids.push_back(thread->getId());
+        }
+    }
+
+    // 给每个工作线程投递一个空任务，阻塞在epoll_wait中的线程也立即回到调度循环领取槽位；
+    // 调用者线程只在stop()时进入调度循环，届时自行领取，不能给它投递（任务会一直留在队列中）
+    for(int id : ids)
+    {
+        scheduleLock([](){}, id);
+    }
+    return getMetricsRegion()->getPath();
+}
+
+/**
+ * @brief 清空当前线程缓存的协程池、协程栈和缓冲区
+ */
+static void trim_thread_caches()
+{
+    t_fiber_pool.clear();
+    t_fiber_pool.shrink_to_fit();
+    Fiber::TrimStackCache();
+    BufferPool::Trim();
+}
+
+/**
+ * @brief 释放各调度线程缓存的内存
+ */
+void Scheduler::trimCaches()
+{
+    std::vector<int> ids = getWorkerThreadIds();
+    if(ids.empty())
+    {
+        trim_thread_caches();
+        malloc_trim(0);
+        return;
+    }
+
+    // 调用者线程只在stop()时进入调度循环，同样不能给它投递
+    std::shared_ptr<std::atomic<size_t>> remaining = std::make_shared<std::atomic<size_t>>(ids.size());
+    for(int id : ids)
+    {
+        scheduleLock([remaining]()
+        {
+            trim_thread_caches();
+            if(remaining->fetch_sub(1) == 1)
+            {
+                malloc_trim(0);
+            }
+        }, id);
+    }
+}
+
 /**
  * @brief 工作线程的主函数
  * 从任务队列获取任务并执行
@@ -124,14 +307,36 @@ void Scheduler::run()
     }
 
     // 创建空闲协程，当没有任务时执行
-    std::shared_ptr<Fiber> idle_fiber = std::make_shared<Fiber>(std::bind(&Scheduler::idle, this));
+    std::shared_ptr<Fiber> idle_fiber = Fiber::Create(std::bind(&Scheduler::idle, this));
     ScheduleTask task;
+
+    // 工作线程预热完成后通知start()
+    if(thread_id != m_rootThread)
+    {
+        warmupThread(true);
+        m_warmupSem.signal();
+    }
+
+    // 登记为在线读者：任务之间读取无锁发布的数据结构不需要EpochGuard
+    Epoch::Online();
     
     while(true)
     {
         task.reset();
         bool tickle_me = false;
 
+        // 回到调度循环即静止点：上一个任务持有的受保护指针都已失效
+        Epoch::Quiescent();
+
+        // 导出指标后领取本线程的槽位
+        MetricsRegion* metrics = getMetricsRegion();
+        if(metrics != t_metrics)
+        {
+            t_metrics = metrics;
+            MetricsRegion::SetThreadSlot(metrics ? metrics->acquireSlot(thread_id) : nullptr);
+        }
+        MetricsThreadSlot* slot = MetricsRegion::GetThreadSlot();
+
         {
             std::lock_guard<std::mutex> lock(m_mutex);
             auto it = m_tasks.begin();
@@ -154,6 +359,10 @@ void Scheduler::run()
                 break;
             }
             tickle_me = tickle_me || (it != m_tasks.end());
+            if(metrics)
+            {
+                metrics->getHeader()->queued_tasks.store(m_tasks.size(), std::memory_order_relaxed);
+            }
         }
 
         // 如果有其他线程的任务，唤醒其他线程
@@ -173,17 +382,41 @@ void Scheduler::run()
                     task.fiber->resume();    
                 }
             }
+            if(slot)
+            {
+                slot->onTask();
+            }
             m_activeThreadCount--;
             task.reset();
         }
         else if(task.cb)
         {
-            // 创建新的协程来执行回调函数
-            std::shared_ptr<Fiber> cb_fiber = std::make_shared<Fiber>(task.cb);
+            // 优先复用协程池中的协程，否则创建新的协程来执行回调函数
+            std::shared_ptr<Fiber> cb_fiber;
+            if(!t_fiber_pool.empty())
+            {
+                cb_fiber = std::move(t_fiber_pool.back());
+                t_fiber_pool.pop_back();
+                cb_fiber->reset(task.cb);
+            }
+            else
+            {
+                cb_fiber = Fiber::Create(task.cb);
+            }
             {
                 std::lock_guard<std::mutex> lock(cb_fiber->m_mutex);
                 cb_fiber->resume();            
             }
+            if(slot)
+            {
+                slot->onTask();
+            }
+            // 执行完毕且没有其他引用的协程放回池中
+            if(cb_fiber->getState() == Fiber::TERM && cb_fiber.use_count() == 1 &&
+               t_fiber_pool.size() < m_warmup.pooled_fibers && !m_cachePaused.load(std::memory_order_relaxed))
+            {
+                t_fiber_pool.push_back(std::move(cb_fiber));
+            }
             m_activeThreadCount--;
             task.reset();    
         }
@@ -197,12 +430,28 @@ void Scheduler::run()
                 break;
             }
             m_idleThreadCount++;
-            // 执行空闲协程
+            if(slot)
+            {
+                MetricsHeader* header = metrics->getHeader();
+                header->active_threads.store(m_activeThreadCount, std::memory_order_relaxed);
+                header->idle_threads.store(m_idleThreadCount, std::memory_order_relaxed);
+                slot->onIdleBegin(metrics_now_ns());
+            }
+            // 执行空闲协程（可能长时间阻塞在epoll_wait上，期间转为离线，不阻止纪元推进）
+            Epoch::Offline();
             idle_fiber->resume();                
+            Epoch::Online();
             m_idleThreadCount--;
+            if(slot)
+            {
+                slot->onIdleEnd(metrics_now_ns());
+            }
         }
     }
-    
+
+    Epoch::Offline();
+    t_metrics = nullptr;
+    MetricsRegion::SetThreadSlot(nullptr);
 }
 
 /**
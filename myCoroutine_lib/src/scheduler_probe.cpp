@@ -0,0 +1,178 @@
+#include <mycoroutine/scheduler_probe.h>  // 调度延迟探针头文件
+#include <mycoroutine/utils.h>            // steady_us
+
+namespace mycoroutine {
+
+/**
+ * @brief 从直方图生成摘要
+ * @param hist 直方图
+ */
+LatencySummary LatencySummary::FromHistogram(const Histogram& hist)
+{
+    LatencySummary summary;
+    summary.count = hist.count();
+    summary.mean  = hist.mean();
+    summary.p50   = hist.percentile(50);
+    summary.p90   = hist.percentile(90);
+    summary.p99   = hist.percentile(99);
+    summary.p999  = hist.percentile(99.9);
+    summary.max   = hist.max();
+    return summary;
+}
+
+/**
+ * @brief 构造函数
+ * @param iom 被探测的IO管理器
+ * @param interval_ms 探测间隔（毫秒）
+ * @param slots 滚动窗口的时间片数量
+ * @param slot_ms 每个时间片的长度（毫秒）
+ */
+SchedulerProbe::SchedulerProbe(IOManager* iom, uint64_t interval_ms, size_t slots, uint64_t slot_ms):
+    m_iom(iom), m_interval(interval_ms), m_slots(slots), m_slotMs(slot_ms), m_all(slots, slot_ms)
+{
+    assert(m_iom != nullptr);
+}
+
+/**
+ * @brief 析构函数，取消探测定时器
+ * @details 已投递的探测任务持有探针的共享指针，析构时一定没有探测任务在排队
+ */
+SchedulerProbe::~SchedulerProbe()
+{
+    stop();
+}
+
+/**
+ * @brief 开始探测
+ */
+void SchedulerProbe::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_timer)
+    {
+        return;
+    }
+
+    if(m_threads.empty())
+    {
+        for(int id : m_iom->getWorkerThreadIds())
+        {
+            m_threads.emplace_back(new ThreadProbe(id, m_slots, m_slotMs));
+        }
+    }
+
+    // 定时器只持有弱引用，探针销毁后回调自动失效
+    m_timer = m_iom->addConditionTimer(m_interval, std::bind(&SchedulerProbe::onTick, this),
+                                       weak_from_this(), true);
+}
+
+/**
+ * @brief 停止探测
+ */
+void SchedulerProbe::stop()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_timer)
+    {
+        m_timer->cancel();
+        m_timer.reset();
+    }
+}
+
+/**
+ * @brief 定时器回调，向每个工作线程投递探测任务
+ */
+void SchedulerProbe::onTick()
+{
+    std::shared_ptr<SchedulerProbe> self = shared_from_this();
+    for(auto& probe : m_threads)
+    {
+        // 上一个探测任务还在排队，说明该线程已经积压，不再追加
+        if(probe->pending.exchange(true, std::memory_order_acq_rel))
+        {
+            continue;
+        }
+        m_iom->scheduleLock(std::bind(&SchedulerProbe::onCanary, self, probe.get(), steady_us()), probe->thread);
+    }
+}
+
+/**
+ * @brief 探测任务，在目标线程上执行
+ * @param probe 目标线程的探测状态
+ * @param enqueue_us 入队时间（微秒）
+ */
+void SchedulerProbe::onCanary(ThreadProbe* probe, uint64_t enqueue_us)
+{
+    uint64_t delay = steady_us() - enqueue_us;
+    probe->delay.record(delay);
+    m_all.record(delay);
+    probe->pending.store(false, std::memory_order_release);
+}
+
+/**
+ * @brief 获取被探测的工作线程ID
+ */
+std::vector<int> SchedulerProbe::getThreadIds() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<int> ids;
+    for(auto& probe : m_threads)
+    {
+        ids.push_back(probe->thread);
+    }
+    return ids;
+}
+
+/**
+ * @brief 获取调度延迟
+ * @param thread 工作线程ID，-1表示所有线程汇总
+ */
+LatencySummary SchedulerProbe::getScheduleDelay(int thread) const
+{
+    Histogram hist;
+    if(thread == -1)
+    {
+        m_all.snapshot(hist);
+        return LatencySummary::FromHistogram(hist);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(auto& probe : m_threads)
+    {
+        if(probe->thread == thread)
+        {
+            probe->delay.snapshot(hist);
+            break;
+        }
+    }
+    return LatencySummary::FromHistogram(hist);
+}
+
+/**
+ * @brief 获取定时器延迟触发统计
+ */
+LatencySummary SchedulerProbe::getTimerLateness() const
+{
+    Histogram hist;
+    m_iom->getTimerLateness().snapshot(hist);
+    return LatencySummary::FromHistogram(hist);
+}
+
+/**
+ * @brief 获取尚未执行的探测任务数
+ */
+size_t SchedulerProbe::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = 0;
+    for(auto& probe : m_threads)
+    {
+        if(probe->pending.load(std::memory_order_acquire))
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+} // end namespace mycoroutine
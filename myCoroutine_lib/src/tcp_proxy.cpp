@@ -0,0 +1,252 @@
+#include <mycoroutine/tcp_proxy.h>   // 四层TCP转发头文件
+#include <mycoroutine/fiber_sync.h>  // 协程条件变量（两个方向汇合）
+#include <mycoroutine/fd_manager.h>  // 读写超时
+#include <mycoroutine/hook.h>        // 原始系统调用
+
+#include <fcntl.h>         // splice/pipe2/F_SETPIPE_SZ
+#include <unistd.h>        // close
+#include <sys/socket.h>    // shutdown
+#include <errno.h>         // errno
+#include <memory>          // 拷贝缓冲区
+
+namespace mycoroutine {
+
+/**
+ * @brief 获取套接字在FdCtx中记录的超时
+ * @param fd 套接字
+ * @param type SO_RCVTIMEO或SO_SNDTIMEO
+ * @return 超时时间（毫秒），未设置返回(uint64_t)-1
+ */
+static uint64_t fd_timeout(int fd, int type)
+{
+    std::shared_ptr<FdCtx> ctx = FdMgr::GetInstance()->get(fd);
+    return ctx ? ctx->getTimeout(type) : (uint64_t)-1;
+}
+
+/**
+ * @brief 把fd设为非阻塞（splice对套接字一端是否阻塞取决于O_NONBLOCK）
+ */
+static void set_nonblock(int fd)
+{
+    int flags = fcntl_f(fd, F_GETFL, 0);
+    if(!(flags & O_NONBLOCK))
+    {
+        fcntl_f(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+/**
+ * @brief 构造函数
+ */
+TcpProxy::TcpProxy(int client, int backend, const TcpProxyConfig& config):
+    m_client(client), m_backend(backend), m_config(config)
+{
+    if(m_config.chunk_size == 0)
+    {
+        m_config.chunk_size = 64 * 1024;
+    }
+}
+
+/**
+ * @brief 析构函数，关闭管道
+ */
+TcpProxy::~TcpProxy()
+{
+    for(int fd : {m_upPipe[0], m_upPipe[1], m_downPipe[0], m_downPipe[1]})
+    {
+        if(fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+/**
+ * @brief 双向转发直到两个方向都结束
+ * @return 正常结束返回0，出错或超时返回-1
+ */
+int TcpProxy::run()
+{
+    set_nonblock(m_client);
+    set_nonblock(m_backend);
+
+    if(m_config.use_splice)
+    {
+        // 管道创建失败（fd耗尽等）时退化为拷贝模式
+        if(pipe2(m_upPipe, O_CLOEXEC | O_NONBLOCK) < 0 || pipe2(m_downPipe, O_CLOEXEC | O_NONBLOCK) < 0)
+        {
+            m_config.use_splice = false;
+        }
+        else if(m_config.pipe_size)
+        {
+            // 调大管道可以减少大流量时的搬运次数；失败时保持默认容量（64KB）
+            fcntl_f(m_upPipe[1], F_SETPIPE_SZ, (int)m_config.pipe_size);
+            fcntl_f(m_downPipe[1], F_SETPIPE_SZ, (int)m_config.pipe_size);
+        }
+    }
+
+    std::mutex mutex;
+    FiberCondition cond;
+    bool up_done = false;
+    int up_err = 0;
+
+    IOManager::GetThis()->scheduleLock([&]()
+    {
+        int err = pump(m_client, m_backend, m_upPipe, m_upBytes);
+        std::lock_guard<std::mutex> lock(mutex);
+        up_err = err;
+        up_done = true;
+        cond.notifyAll();
+    });
+
+    int down_err = pump(m_backend, m_client, m_downPipe, m_downBytes);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while(!up_done)
+    {
+        cond.wait(lock);
+    }
+
+    int err = up_err ? up_err : down_err;
+    if(err)
+    {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 单方向转发直到EOF或出错
+ * @param in 读端套接字
+ * @param out 写端套接字
+ * @param pipe 该方向使用的管道
+ * @param bytes 字节计数
+ * @return 读到EOF返回0，出错或超时返回errno
+ */
+int TcpProxy::pump(int in, int out, int pipe[2], std::atomic<uint64_t>& bytes)
+{
+    uint64_t rto = fd_timeout(in, SO_RCVTIMEO);
+    uint64_t wto = fd_timeout(out, SO_SNDTIMEO);
+    int err = m_config.use_splice ? pumpSplice(in, out, pipe, rto, wto, bytes)
+                                  : pumpCopy(in, out, rto, wto, bytes);
+    if(err == 0)
+    {
+        // 半关闭：把EOF传给另一端，另一个方向继续转发
+        shutdown(out, SHUT_WR);
+    }
+    else
+    {
+        // 出错：关闭两端，等待中的另一个方向随即读到EOF或收到HUP
+        shutdown(in, SHUT_RDWR);
+        shutdown(out, SHUT_RDWR);
+    }
+    return err;
+}
+
+/**
+ * @brief splice实现：套接字 -> 管道 -> 套接字，数据只在内核中移动页引用
+ * @return 读到EOF返回0，出错或超时返回errno
+ */
+int TcpProxy::pumpSplice(int in, int out, int pipe[2], uint64_t rto, uint64_t wto, std::atomic<uint64_t>& bytes)
+{
+    IOManager* iom = IOManager::GetThis();
+    while(true)
+    {
+        // 1 套接字 -> 管道。每次都把管道排空，因此EAGAIN只可能来自套接字
+        ssize_t n = splice(in, nullptr, pipe[1], nullptr, m_config.chunk_size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if(n == 0)
+        {
+            return 0;
+        }
+        if(n < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            if(errno != EAGAIN || iom->waitEvent(in, IOManager::READ, rto))
+            {
+                return errno;
+            }
+            continue;
+        }
+
+        // 2 管道 -> 套接字
+        size_t left = n;
+        while(left)
+        {
+            ssize_t m = splice(pipe[0], nullptr, out, nullptr, left, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if(m > 0)
+            {
+                left -= m;
+                bytes.fetch_add(m, std::memory_order_relaxed);
+                continue;
+            }
+            if(m < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if(m < 0 && errno == EAGAIN && iom->waitEvent(out, IOManager::WRITE, wto) == 0)
+            {
+                continue;
+            }
+            return m < 0 ? errno : EPIPE;
+        }
+    }
+}
+
+/**
+ * @brief read/send拷贝实现
+ * @return 读到EOF返回0，出错或超时返回errno
+ */
+int TcpProxy::pumpCopy(int in, int out, uint64_t rto, uint64_t wto, std::atomic<uint64_t>& bytes)
+{
+    IOManager* iom = IOManager::GetThis();
+    std::unique_ptr<char[]> buf(new char[m_config.chunk_size]);
+    while(true)
+    {
+        ssize_t n = read_f(in, buf.get(), m_config.chunk_size);
+        if(n == 0)
+        {
+            return 0;
+        }
+        if(n < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            if(errno != EAGAIN || iom->waitEvent(in, IOManager::READ, rto))
+            {
+                return errno;
+            }
+            continue;
+        }
+
+        const char* p = buf.get();
+        size_t left = n;
+        while(left)
+        {
+            ssize_t m = send_f(out, p, left, MSG_NOSIGNAL);
+            if(m > 0)
+            {
+                p += m;
+                left -= m;
+                bytes.fetch_add(m, std::memory_order_relaxed);
+                continue;
+            }
+            if(m < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if(m < 0 && errno == EAGAIN && iom->waitEvent(out, IOManager::WRITE, wto) == 0)
+            {
+                continue;
+            }
+            return m < 0 ? errno : EPIPE;
+        }
+    }
+}
+
+} // end namespace mycoroutine
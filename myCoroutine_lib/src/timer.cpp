@@ -279,6 +279,12 @@ void TimerManager::listExpiredCb(std::vector<std::function<void()>>& cbs)
         std::shared_ptr<Timer> temp = *m_timers.begin();
         // 从时间堆中移除
         m_timers.erase(m_timers.begin());
+
+        // 记录实际取出时间相对于到期时间的延迟（时钟回退时没有意义，跳过）
+        if(!rollover)
+        {
+            m_lateness.record(std::chrono::duration_cast<std::chrono::microseconds>(now - temp->m_next).count());
+        }
         
         // 将回调函数添加到结果容器中
         cbs.push_back(temp->m_cb); 
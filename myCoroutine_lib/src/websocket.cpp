@@ -0,0 +1,766 @@
+#include <mycoroutine/websocket.h>   // WebSocket服务端头文件
+#include <mycoroutine/fd_manager.h>  // 文件描述符管理器（读取接收超时）
+#include <mycoroutine/hook.h>        // 原始系统调用
+#include <mycoroutine/utils.h>       // steady_ms
+
+#include <sys/socket.h>  // recv/shutdown
+#include <errno.h>       // errno
+#include <strings.h>     // strncasecmp
+#include <cstring>       // memcpy/memmove
+#include <algorithm>     // std::max/std::remove
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>   // SSE2/AVX2 intrinsics
+#define MYCOROUTINE_WS_X86 1
+#endif
+
+namespace mycoroutine {
+
+// RFC 6455规定的握手GUID
+static const char kWebSocketGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// 升级请求最大长度
+static const size_t kMaxHandshakeSize = 8192;
+
+// ============================================================================
+// 握手：SHA-1与Base64
+// ============================================================================
+
+/**
+ * @brief 计算SHA-1摘要
+ * @param data 输入数据
+ * @param len 输入长度
+ * @param out 输出20字节摘要
+ */
+static void sha1(const uint8_t* data, size_t len, uint8_t out[20])
+{
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    // 填充：0x80、若干0、64位大端比特长度
+    std::string msg((const char*)data, len);
+    msg.push_back((char)0x80);
+    while(msg.size() % 64 != 56)
+    {
+        msg.push_back(0);
+    }
+    uint64_t bits = (uint64_t)len * 8;
+    for(int i = 7; i >= 0; --i)
+    {
+        msg.push_back((char)(bits >> (i * 8)));
+    }
+
+    for(size_t off = 0; off < msg.size(); off += 64)
+    {
+        const uint8_t* p = (const uint8_t*)msg.data() + off;
+        uint32_t w[80];
+        for(int i = 0; i < 16; ++i)
+        {
+            w[i] = (uint32_t)p[i * 4] << 24 | (uint32_t)p[i * 4 + 1] << 16 | (uint32_t)p[i * 4 + 2] << 8 | p[i * 4 + 3];
+        }
+        for(int i = 16; i < 80; ++i)
+        {
+            uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+            w[i] = (x << 1) | (x >> 31);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for(int i = 0; i < 80; ++i)
+        {
+            uint32_t f, k;
+            if(i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+            else if(i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+            else if(i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else            { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+            uint32_t t = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = (b << 30) | (b >> 2);
+            b = a;
+            a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    for(int i = 0; i < 5; ++i)
+    {
+        out[i * 4]     = (uint8_t)(h[i] >> 24);
+        out[i * 4 + 1] = (uint8_t)(h[i] >> 16);
+        out[i * 4 + 2] = (uint8_t)(h[i] >> 8);
+        out[i * 4 + 3] = (uint8_t)h[i];
+    }
+}
+
+/**
+ * @brief Base64编码
+ */
+static std::string base64_encode(const uint8_t* data, size_t len)
+{
+    static const char kTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((len + 2) / 3 * 4);
+    for(size_t i = 0; i < len; i += 3)
+    {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if(i + 1 < len) v |= (uint32_t)data[i + 1] << 8;
+        if(i + 2 < len) v |= data[i + 2];
+        out.push_back(kTable[(v >> 18) & 0x3f]);
+        out.push_back(kTable[(v >> 12) & 0x3f]);
+        out.push_back(i + 1 < len ? kTable[(v >> 6) & 0x3f] : '=');
+        out.push_back(i + 2 < len ? kTable[v & 0x3f] : '=');
+    }
+    return out;
+}
+
+/**
+ * @brief 判断逗号分隔的头部值中是否包含指定token（不区分大小写）
+ */
+static bool header_has_token(const HttpHeader* header, const char* token)
+{
+    if(!header)
+    {
+        return false;
+    }
+    size_t n = strlen(token);
+    std::string_view v = header->value;
+    while(!v.empty())
+    {
+        size_t comma = v.find(',');
+        std::string_view item = v.substr(0, comma);
+        while(!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+        while(!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+        if(item.size() == n && strncasecmp(item.data(), token, n) == 0)
+        {
+            return true;
+        }
+        if(comma == std::string_view::npos)
+        {
+            break;
+        }
+        v.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+/**
+ * @brief 非阻塞接收，没有数据时挂起当前协程等待READ事件
+ * @return 接收的字节数，0表示对端关闭，-1表示出错
+ */
+static ssize_t recv_wait(int fd, char* buf, size_t len)
+{
+    // 接收超时沿用FdCtx中通过setsockopt(SO_RCVTIMEO)设置的值
+    uint64_t timeout = (uint64_t)-1;
+    std::shared_ptr<FdCtx> ctx = FdMgr::GetInstance()->get(fd);
+    if(ctx)
+    {
+        timeout = ctx->getTimeout(SO_RCVTIMEO);
+    }
+
+    while(true)
+    {
+        ssize_t n = recv_f(fd, buf, len, MSG_DONTWAIT);
+        if(n >= 0)
+        {
+            return n;
+        }
+        if(errno == EINTR)
+        {
+            continue;
+        }
+        IOManager* iom = IOManager::GetThis();
+        if(errno != EAGAIN || !iom || iom->waitEvent(fd, IOManager::READ, timeout))
+        {
+            return -1;
+        }
+    }
+}
+
+/**
+ * @brief 发送一段数据并等待发送完毕（用于握手应答）
+ */
+static bool send_all(int fd, std::string data)
+{
+    std::shared_ptr<WriteQueue> queue = std::make_shared<WriteQueue>(fd);
+    return queue->push(std::move(data)) && queue->flush();
+}
+
+// ============================================================================
+// 掩码
+// ============================================================================
+
+#ifdef MYCOROUTINE_WS_X86
+
+/**
+ * @brief AVX2：每次异或32字节
+ * @return 已处理的字节数（4的倍数，掩码相位不变）
+ */
+__attribute__((target("avx2")))
+static size_t mask_avx2(char* data, size_t len, uint32_t key)
+{
+    const __m256i k = _mm256_set1_epi32((int)key);
+    size_t i = 0;
+    for(; i + 32 <= len; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+        _mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(v, k));
+    }
+    return i;
+}
+
+/**
+ * @brief SSE2：每次异或16字节（x86-64基线指令集）
+ * @return 已处理的字节数
+ */
+static size_t mask_sse2(char* data, size_t len, uint32_t key)
+{
+    const __m128i k = _mm_set1_epi32((int)key);
+    size_t i = 0;
+    for(; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(v, k));
+    }
+    return i;
+}
+
+/**
+ * @brief 检测AVX2支持
+ */
+static bool detect_avx2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+static const bool s_has_avx2 = detect_avx2();
+
+#endif // MYCOROUTINE_WS_X86
+
+/**
+ * @brief 对负载原地加/去掩码
+ * @param data 负载
+ * @param len 负载长度
+ * @param key 4字节掩码
+ */
+void websocket_mask(char* data, size_t len, const uint8_t key[4])
+{
+    size_t i = 0;
+#ifdef MYCOROUTINE_WS_X86
+    // 按内存顺序读出4字节掩码，广播后与数据逐字节对应
+    uint32_t k;
+    memcpy(&k, key, 4);
+    i = s_has_avx2 ? mask_avx2(data, len, k) : 0;
+    i += mask_sse2(data + i, len - i, k);
+#endif
+    for(; i < len; ++i)
+    {
+        data[i] ^= key[i & 3];
+    }
+}
+
+// ============================================================================
+// WebSocket
+// ============================================================================
+
+/**
+ * @brief 判断请求是否是合法的WebSocket升级请求
+ * @param req 已解析的请求
+ */
+bool WebSocket::IsUpgradeRequest(const HttpRequest& req)
+{
+    if(req.method != "GET" || req.minorVersion < 1)
+    {
+        return false;
+    }
+    const HttpHeader* version = req.findHeader("Sec-WebSocket-Version");
+    const HttpHeader* key = req.findHeader("Sec-WebSocket-Key");
+    return header_has_token(req.findHeader("Upgrade"), "websocket") &&
+           header_has_token(req.findHeader("Connection"), "upgrade") &&
+           version && version->value == "13" &&
+           key && key->value.size() == 24;  // 16字节随机数的Base64编码
+}
+
+/**
+ * @brief 读取并解析升级请求，完成握手
+ * @param fd 已连接的套接字
+ * @param config 连接配置
+ */
+std::shared_ptr<WebSocket> WebSocket::Accept(int fd, const WebSocketConfig& config)
+{
+    std::vector<char> buf(kMaxHandshakeSize);
+    size_t len = 0;
+    HttpRequest req;
+    while(true)
+    {
+        ssize_t n = recv_wait(fd, buf.data() + len, buf.size() - len);
+        if(n <= 0)
+        {
+            return nullptr;
+        }
+        len += n;
+
+        int parsed = parse_http_request(buf.data(), len, req);
+        if(parsed > 0)
+        {
+            return Upgrade(fd, req, buf.data() + parsed, len - parsed, config);
+        }
+        if(parsed == -1 || len == buf.size())
+        {
+            send_all(fd, "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            return nullptr;
+        }
+    }
+}
+
+/**
+ * @brief 使用已解析的请求完成握手
+ * @param fd 已连接的套接字
+ * @param req 已解析的升级请求
+ * @param extra 请求头之后已经读入的数据
+ * @param extra_len extra的长度
+ * @param config 连接配置
+ */
+std::shared_ptr<WebSocket> WebSocket::Upgrade(int fd, const HttpRequest& req, const char* extra,
+                                              size_t extra_len, const WebSocketConfig& config)
+{
+    if(!IsUpgradeRequest(req))
+    {
+        send_all(fd, "HTTP/1.1 400 Bad Request\r\nSec-WebSocket-Version: 13\r\n"
+                     "Content-Length: 0\r\nConnection: close\r\n\r\n");
+        return nullptr;
+    }
+
+    // Sec-WebSocket-Accept = Base64(SHA1(key + GUID))
+    std::string key(req.findHeader("Sec-WebSocket-Key")->value);
+    key += kWebSocketGuid;
+    uint8_t digest[20];
+    sha1((const uint8_t*)key.data(), key.size(), digest);
+
+    std::shared_ptr<WebSocket> ws = std::make_shared<WebSocket>(fd, config);
+    ws->m_queue->push("HTTP/1.1 101 Switching Protocols\r\n"
+                      "Upgrade: websocket\r\n"
+                      "Connection: Upgrade\r\n"
+                      "Sec-WebSocket-Accept: " + base64_encode(digest, sizeof(digest)) + "\r\n\r\n");
+    if(extra_len)
+    {
+        ws->m_rbuf.assign(extra, extra + extra_len);
+        ws->m_rend = extra_len;
+    }
+    ws->startKeepalive();
+    return ws;
+}
+
+/**
+ * @brief 编码一个服务端帧（不加掩码）
+ * @param opcode 帧类型
+ * @param data 负载
+ * @param len 负载长度
+ */
+WriteQueue::Buffer WebSocket::EncodeFrame(Opcode opcode, const void* data, size_t len)
+{
+    std::string frame;
+    frame.reserve(len + 10);
+    frame.push_back((char)(0x80 | opcode));  // FIN=1，不分片
+    if(len < 126)
+    {
+        frame.push_back((char)len);
+    }
+    else if(len <= 0xffff)
+    {
+        frame.push_back((char)126);
+        frame.push_back((char)(len >> 8));
+        frame.push_back((char)len);
+    }
+    else
+    {
+        frame.push_back((char)127);
+        for(int i = 7; i >= 0; --i)
+        {
+            frame.push_back((char)((uint64_t)len >> (i * 8)));
+        }
+    }
+    frame.append((const char*)data, len);
+    return std::make_shared<const std::string>(std::move(frame));
+}
+
+/**
+ * @brief 构造函数
+ * @param fd 套接字文件描述符
+ * @param config 连接配置
+ */
+WebSocket::WebSocket(int fd, const WebSocketConfig& config):
+    m_fd(fd), m_config(config), m_iom(IOManager::GetThis()),
+    m_queue(std::make_shared<WriteQueue>(fd, config.high_watermark, IOManager::GetThis()))
+{
+    m_lastActive = steady_ms();
+}
+
+/**
+ * @brief 析构函数，停止保活定时器
+ */
+WebSocket::~WebSocket()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_timer)
+    {
+        m_timer->cancel();
+    }
+}
+
+/**
+ * @brief 启动保活定时器
+ * @details 周期取ping间隔和空闲超时中较小的非零值，定时器只持有连接的弱引用
+ */
+void WebSocket::startKeepalive()
+{
+    uint64_t period = m_config.ping_interval_ms;
+    if(m_config.idle_timeout_ms && (!period || m_config.idle_timeout_ms < period))
+    {
+        period = m_config.idle_timeout_ms;
+    }
+    if(!period)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_timer = m_iom->addConditionTimer(period, std::bind(&WebSocket::onKeepalive, this), weak_from_this(), true);
+}
+
+/**
+ * @brief 保活定时器回调
+ * @details 空闲超时则关闭套接字读写，唤醒挂起在recvMessage()中的协程；否则发送ping
+ */
+void WebSocket::onKeepalive()
+{
+    if(m_closed)
+    {
+        return;
+    }
+    if(m_config.idle_timeout_ms && steady_ms() - m_lastActive > m_config.idle_timeout_ms)
+    {
+        ::shutdown(m_fd, SHUT_RDWR);
+        return;
+    }
+    if(m_config.ping_interval_ms)
+    {
+        // 定时器回调不能被反压挂起，发送队列已满时跳过本次ping
+        sendFrame(EncodeFrame(PING, nullptr, 0), false);
+    }
+}
+
+/**
+ * @brief 读取更多数据到接收缓冲区
+ * @param need 从m_rpos开始至少需要的字节数
+ */
+ssize_t WebSocket::fill(size_t need)
+{
+    // 至少留出4KB空闲空间，减少小块读取的次数
+    need = std::max(need, m_rend - m_rpos + 4096);
+    if(m_rbuf.size() - m_rpos < need)
+    {
+        // 先把未解析的数据移到开头，空间仍不够再扩容
+        if(m_rpos)
+        {
+            memmove(m_rbuf.data(), m_rbuf.data() + m_rpos, m_rend - m_rpos);
+            m_rend -= m_rpos;
+            m_rpos = 0;
+        }
+        if(m_rbuf.size() < need)
+        {
+            m_rbuf.resize(std::max(need, m_rbuf.size() * 2));
+        }
+    }
+
+    ssize_t n = recv_wait(m_fd, m_rbuf.data() + m_rend, m_rbuf.size() - m_rend);
+    if(n > 0)
+    {
+        m_rend += n;
+    }
+    return n;
+}
+
+/**
+ * @brief 因协议错误关闭连接
+ * @param code 关闭码
+ */
+bool WebSocket::fail(uint16_t code)
+{
+    close(code);
+    return false;
+}
+
+/**
+ * @brief 接收一条完整消息
+ * @param msg 输出参数，收到的消息
+ * @return 收到消息返回true；连接关闭、超时或协议错误返回false
+ */
+bool WebSocket::recvMessage(Message& msg)
+{
+    bool fragmented = false;
+    msg.data.clear();
+
+    while(!m_closed)
+    {
+        // 1 帧头：2字节基本头 + 扩展长度 + 4字节掩码
+        size_t avail = m_rend - m_rpos;
+        const uint8_t* h = (const uint8_t*)m_rbuf.data() + m_rpos;
+        size_t hlen = 2;
+        if(avail >= 2)
+        {
+            hlen += (h[1] & 0x7f) == 126 ? 2 : ((h[1] & 0x7f) == 127 ? 8 : 0);
+            hlen += (h[1] & 0x80) ? 4 : 0;
+        }
+        if(avail < hlen)
+        {
+            if(fill(hlen) <= 0)
+            {
+                m_closed = true;
+                return false;
+            }
+            continue;
+        }
+
+        bool fin = h[0] & 0x80;
+        Opcode opcode = (Opcode)(h[0] & 0x0f);
+        uint64_t len = h[1] & 0x7f;
+        if(len == 126)
+        {
+            len = (uint64_t)h[2] << 8 | h[3];
+        }
+        else if(len == 127)
+        {
+            len = 0;
+            for(int i = 0; i < 8; ++i)
+            {
+                len = len << 8 | h[2 + i];
+            }
+        }
+
+        // 2 校验：没有协商扩展时RSV必须为0；客户端帧必须加掩码；控制帧不能分片且负载不超过125
+        if((h[0] & 0x70) || !(h[1] & 0x80))
+        {
+            return fail(1002);
+        }
+        bool control = opcode & 0x8;
+        if(control ? (opcode != CLOSE && opcode != PING && opcode != PONG) || !fin || len > 125
+                   : opcode != CONTINUATION && opcode != TEXT && opcode != BINARY)
+        {
+            return fail(1002);
+        }
+        if(!control && (len > m_config.max_message_size || msg.data.size() + len > m_config.max_message_size))
+        {
+            return fail(1009);
+        }
+
+        // 3 等待完整负载
+        if(avail < hlen + len)
+        {
+            if(fill(hlen + len) <= 0)
+            {
+                m_closed = true;
+                return false;
+            }
+            continue;
+        }
+
+        uint8_t key[4];
+        memcpy(key, h + hlen - 4, 4);
+        char* payload = m_rbuf.data() + m_rpos + hlen;
+        websocket_mask(payload, len, key);
+        m_rpos += hlen + len;
+        m_lastActive = steady_ms();
+
+        // 4 按帧类型处理
+        switch(opcode)
+        {
+        case PING:
+            sendFrame(EncodeFrame(PONG, payload, len));
+            break;
+        case PONG:
+            break;
+        case CLOSE:
+        {
+            // 回复相同的关闭码；没有关闭码时回复1000
+            uint16_t code = len >= 2 ? (uint16_t)((uint8_t)payload[0] << 8 | (uint8_t)payload[1]) : 1000;
+            close(len == 1 ? 1002 : code);
+            return false;
+        }
+        case TEXT:
+        case BINARY:
+            if(fragmented)
+            {
+                return fail(1002);
+            }
+            msg.opcode = opcode;
+            msg.data.assign(payload, len);
+            if(fin)
+            {
+                return true;
+            }
+            fragmented = true;
+            break;
+        case CONTINUATION:
+            if(!fragmented)
+            {
+                return fail(1002);
+            }
+            msg.data.append(payload, len);
+            if(fin)
+            {
+                return true;
+            }
+            break;
+        }
+
+        // 接收缓冲区已全部解析时，过大的缓冲区直接释放，避免空闲连接长期占用
+        if(m_rpos == m_rend)
+        {
+            m_rpos = m_rend = 0;
+            if(m_rbuf.size() > 64 * 1024)
+            {
+                std::vector<char>().swap(m_rbuf);
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 发送一条消息
+ * @param data 消息内容
+ * @param opcode TEXT或BINARY
+ */
+bool WebSocket::send(const std::string& data, Opcode opcode)
+{
+    return sendFrame(EncodeFrame(opcode, data.data(), data.size()));
+}
+
+/**
+ * @brief 发送已编码的帧
+ * @param frame EncodeFrame()得到的帧
+ * @param wait 发送队列已满时是否挂起等待
+ */
+bool WebSocket::sendFrame(const WriteQueue::Buffer& frame, bool wait)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_closeSent)
+        {
+            return false;
+        }
+    }
+    // 与close()并发时由写队列保证顺序：close帧与队列关闭是一次原子操作，之后的入队一定失败
+    return wait ? m_queue->push(frame) : m_queue->tryPush(frame);
+}
+
+/**
+ * @brief 关闭连接
+ * @param code 关闭码
+ * @param reason 关闭原因
+ */
+void WebSocket::close(uint16_t code, const std::string& reason)
+{
+    bool send_close = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_closeSent)
+        {
+            m_closeSent = true;
+            send_close = true;
+        }
+        if(m_timer)
+        {
+            m_timer->cancel();
+            m_timer.reset();
+        }
+    }
+    m_closed = true;
+
+    // close帧入队与关闭写队列一次完成，检查过m_closeSent的并发sendFrame()不会把数据帧排在close帧之后（RFC 6455 §5.5.1）
+    if(send_close)
+    {
+        std::string payload;
+        payload.push_back((char)(code >> 8));
+        payload.push_back((char)code);
+        payload.append(reason, 0, 123);  // 控制帧负载不超过125字节
+        m_queue->closeWith(EncodeFrame(CLOSE, payload.data(), payload.size()));
+    }
+    else
+    {
+        m_queue->close();
+    }
+
+    // 对端不再读取时发送队列永远不会清空：超时后关闭连接，刷新协程的发送随即失败退出
+    uint64_t timeout = m_config.close_timeout_ms ? m_config.close_timeout_ms : (uint64_t)-1;
+    if(!m_queue->flush(timeout) && errno == ETIMEDOUT)
+    {
+        shutdown(m_fd, SHUT_RDWR);
+    }
+}
+
+// ============================================================================
+// WebSocketGroup
+// ============================================================================
+
+/**
+ * @brief 加入连接
+ */
+void WebSocketGroup::add(const std::shared_ptr<WebSocket>& ws)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_members.push_back(ws);
+}
+
+/**
+ * @brief 移除连接
+ */
+void WebSocketGroup::remove(const std::shared_ptr<WebSocket>& ws)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_members.erase(std::remove(m_members.begin(), m_members.end(), ws), m_members.end());
+}
+
+/**
+ * @brief 获取连接数
+ */
+size_t WebSocketGroup::size()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_members.size();
+}
+
+/**
+ * @brief 广播消息
+ * @param data 消息内容
+ * @param opcode TEXT或BINARY
+ */
+size_t WebSocketGroup::broadcast(const std::string& data, WebSocket::Opcode opcode)
+{
+    return broadcastFrame(WebSocket::EncodeFrame(opcode, data.data(), data.size()));
+}
+
+/**
+ * @brief 广播已编码的帧
+ * @param frame EncodeFrame()得到的帧
+ * @details 先复制成员列表再投递，投递期间不持有组锁
+ */
+size_t WebSocketGroup::broadcastFrame(const WriteQueue::Buffer& frame)
+{
+    std::vector<std::shared_ptr<WebSocket>> members;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        members = m_members;
+    }
+
+    size_t delivered = 0;
+    for(auto& ws : members)
+    {
+        if(ws->sendFrame(frame, false))
+        {
+            ++delivered;
+        }
+    }
+    return delivered;
+}
+
+} // end namespace mycoroutine
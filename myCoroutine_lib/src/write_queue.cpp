@@ -0,0 +1,295 @@
+#include <mycoroutine/write_queue.h>  // 合并写队列头文件
+#include <mycoroutine/fd_manager.h>   // 文件描述符管理器（读取发送超时）
+#include <mycoroutine/hook.h>         // 原始系统调用
+#include <mycoroutine/utils.h>        // steady_ms
+
+#include <sys/socket.h>  // sendmsg
+#include <sys/uio.h>     // iovec
+#include <limits.h>      // IOV_MAX
+#include <errno.h>       // errno
+#include <cstring>       // memset
+
+namespace mycoroutine {
+
+/**
+ * @brief 构造函数
+ * @param fd 套接字文件描述符
+ * @param high_watermark 高水位（字节）
+ * @param iom 刷新协程所在的IO管理器
+ */
+WriteQueue::WriteQueue(int fd, size_t high_watermark, IOManager* iom):
+    m_fd(fd), m_highWatermark(high_watermark), m_lowWatermark(high_watermark / 2), m_iom(iom)
+{
+    assert(m_iom != nullptr);
+}
+
+/**
+ * @brief 析构函数
+ * @details 刷新协程持有队列的共享指针，析构时一定没有刷新协程在运行
+ */
+WriteQueue::~WriteQueue()
+{
+}
+
+/**
+ * @brief 入队（需持有m_mutex）
+ * @param buf 要发送的缓冲区
+ */
+void WriteQueue::enqueue(Buffer buf)
+{
+    m_pendingBytes += buf->size();
+    m_queue.push_back(std::move(buf));
+    if(!m_flushing)
+    {
+        m_flushing = true;
+        m_iom->scheduleLock(std::bind(&WriteQueue::flushLoop, shared_from_this()));
+    }
+}
+
+/**
+ * @brief 投递缓冲区，队列已满时挂起当前协程
+ * @param buf 要发送的缓冲区
+ * @return 成功入队返回true；队列已关闭或连接出错返回false
+ */
+bool WriteQueue::push(Buffer buf)
+{
+    if(!buf || buf->empty())
+    {
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // 反压：待发送数据超过高水位时挂起生产者，直到刷新协程把数据降到低水位以下
+    while(!m_closed && !m_error && m_pendingBytes >= m_highWatermark)
+    {
+        m_notFull.wait(lock);
+    }
+    if(m_closed || m_error)
+    {
+        return false;
+    }
+    enqueue(std::move(buf));
+    return true;
+}
+
+/**
+ * @brief 投递数据（拷贝一次到内部缓冲区）
+ * @param data 要发送的数据
+ * @return 成功入队返回true；队列已关闭或连接出错返回false
+ */
+bool WriteQueue::push(std::string data)
+{
+    return push(std::make_shared<const std::string>(std::move(data)));
+}
+
+/**
+ * @brief 非阻塞投递
+ * @param buf 要发送的缓冲区
+ * @return 成功入队返回true；队列已满、已关闭或出错返回false
+ */
+bool WriteQueue::tryPush(Buffer buf)
+{
+    if(!buf || buf->empty())
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_closed || m_error || m_pendingBytes >= m_highWatermark)
+    {
+        return false;
+    }
+    enqueue(std::move(buf));
+    return true;
+}
+
+/**
+ * @brief 挂起当前协程直到队列中的数据全部发送完毕
+ * @param timeout_ms 最长等待时间（毫秒），(uint64_t)-1表示不限制
+ * @return 全部发送成功返回true；连接出错返回false；超时返回false并设置errno为ETIMEDOUT
+ */
+bool WriteQueue::flush(uint64_t timeout_ms)
+{
+    uint64_t deadline = timeout_ms == (uint64_t)-1 ? (uint64_t)-1 : steady_ms() + timeout_ms;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(!m_error && m_pendingBytes > 0)
+    {
+        if(deadline == (uint64_t)-1)
+        {
+            m_drained.wait(lock);
+            continue;
+        }
+        uint64_t now = steady_ms();
+        if(now >= deadline)
+        {
+            errno = ETIMEDOUT;
+            return false;
+        }
+        m_drained.waitFor(lock, deadline - now);
+    }
+    return m_error == 0;
+}
+
+/**
+ * @brief 关闭队列
+ */
+void WriteQueue::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+    }
+    // 唤醒被反压挂起的生产者，让它们返回false
+    m_notFull.notifyAll();
+}
+
+/**
+ * @brief 投递最后一个缓冲区并关闭队列
+ * @param buf 最后一个缓冲区
+ * @return 成功入队返回true；队列已关闭或连接出错返回false
+ */
+bool WriteQueue::closeWith(Buffer buf)
+{
+    bool ok = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_closed && !m_error)
+        {
+            if(buf && !buf->empty())
+            {
+                enqueue(std::move(buf));
+            }
+            ok = true;
+        }
+        m_closed = true;
+    }
+    m_notFull.notifyAll();
+    return ok;
+}
+
+/**
+ * @brief 获取待发送字节数
+ */
+size_t WriteQueue::pendingBytes()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pendingBytes;
+}
+
+/**
+ * @brief 获取发送错误码
+ */
+int WriteQueue::getError()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+/**
+ * @brief 从队头消费已发送的字节（需持有m_mutex）
+ * @param n 已发送字节数
+ */
+void WriteQueue::consume(size_t n)
+{
+    m_pendingBytes -= n;
+    while(n > 0)
+    {
+        size_t left = m_queue.front()->size() - m_frontOffset;
+        if(n < left)
+        {
+            m_frontOffset += n;
+            break;
+        }
+        n -= left;
+        m_frontOffset = 0;
+        m_queue.pop_front();
+    }
+}
+
+/**
+ * @brief 刷新协程主函数
+ * @details 每轮最多取IOV_MAX个缓冲区组成一次sendmsg；若本批之后队列中还有数据则带上MSG_MORE，
+ *          让内核把多批数据合并成满MSS的报文。发送缓冲区满时在WRITE事件上挂起。
+ *          只有刷新协程会出队，因此iovec引用的缓冲区在发送期间不会被释放
+ */
+void WriteQueue::flushLoop()
+{
+    struct iovec iov[IOV_MAX];
+
+    // 发送超时沿用FdCtx中通过setsockopt(SO_SNDTIMEO)设置的值
+    uint64_t timeout = (uint64_t)-1;
+    std::shared_ptr<FdCtx> ctx = FdMgr::GetInstance()->get(m_fd);
+    if(ctx)
+    {
+        timeout = ctx->getTimeout(SO_SNDTIMEO);
+    }
+
+    while(true)
+    {
+        int iovcnt = 0;
+        bool more = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(m_queue.empty() || m_error)
+            {
+                m_flushing = false;
+                break;
+            }
+
+            size_t offset = m_frontOffset;
+            for(auto it = m_queue.begin(); it != m_queue.end() && iovcnt < IOV_MAX; ++it)
+            {
+                iov[iovcnt].iov_base = (void*)((*it)->data() + offset);
+                iov[iovcnt].iov_len  = (*it)->size() - offset;
+                offset = 0;
+                ++iovcnt;
+            }
+            more = m_queue.size() > (size_t)iovcnt;
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov    = iov;
+        msg.msg_iovlen = iovcnt;
+
+        int flags = MSG_NOSIGNAL | MSG_DONTWAIT | (more ? MSG_MORE : 0);
+        ssize_t n = sendmsg_f(m_fd, &msg, flags);
+        if(n >= 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            consume(n);
+            if(m_pendingBytes <= m_lowWatermark)
+            {
+                m_notFull.notifyAll();
+            }
+            continue;
+        }
+
+        if(errno == EINTR)
+        {
+            continue;
+        }
+        if(errno == EAGAIN)
+        {
+            // 发送缓冲区已满，等待可写
+            if(m_iom->waitEvent(m_fd, IOManager::WRITE, timeout) == 0)
+            {
+                continue;
+            }
+        }
+
+        // 发送失败：丢弃剩余数据，唤醒所有等待者
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_error = errno ? errno : EIO;
+        m_queue.clear();
+        m_frontOffset = 0;
+        m_pendingBytes = 0;
+        m_flushing = false;
+        break;
+    }
+
+    m_notFull.notifyAll();
+    m_drained.notifyAll();
+}
+
+} // end namespace mycoroutine
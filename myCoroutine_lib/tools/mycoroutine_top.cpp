@@ -0,0 +1,218 @@
+/**
+ * @file mycoroutine_top.cpp
+ * @brief 运行时指标查看器
+ * @details 读取Scheduler::exportMetrics()导出的共享内存文件，按刷新间隔计算速率，
+ *          以top的方式显示每个调度线程的任务、协程切换、epoll、定时器和忙碌比例。
+ *          只读映射文件，不需要被观察的进程配合，也不占用其调度时间
+ *
+ * 用法：mycoroutine_top [-i 刷新间隔ms] [-n 次数] [-b] [-l] [-d 目录] [文件|PID]
+ *       不指定文件时选择目录中的第一个指标文件；-b为批处理模式（不清屏），-l列出指标文件
+ */
+
+#include "mycoroutine/metrics.h"   // 指标读取端
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <map>
+
+using namespace mycoroutine;
+
+/**
+ * @brief 命令行参数
+ */
+struct Options
+{
+    uint64_t interval_ms = 1000;   // 刷新间隔
+    long iterations = -1;          // 刷新次数，-1表示直到被观察进程退出
+    bool batch = false;            // 批处理模式
+    bool list = false;             // 只列出指标文件
+    std::string dir = "/dev/shm";  // 指标文件目录
+    std::string target;            // 文件路径或PID
+};
+
+/**
+ * @brief 根据参数确定指标文件
+ * @return 找不到时返回空字符串
+ */
+static std::string resolve(const Options& opt)
+{
+    std::vector<std::string> paths = MetricsReader::List(opt.dir);
+    if(opt.target.empty())
+    {
+        return paths.empty() ? "" : paths.front();
+    }
+    if(opt.target.find('/') != std::string::npos)
+    {
+        return opt.target;
+    }
+    // 按PID匹配文件名后缀
+    std::string suffix = "." + opt.target;
+    for(const auto& path : paths)
+    {
+        if(path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0)
+        {
+            return path;
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief 计算每秒速率
+ */
+static double rate(uint64_t cur, uint64_t prev, double seconds)
+{
+    return seconds > 0 && cur >= prev ? (cur - prev) / seconds : 0;
+}
+
+/**
+ * @brief 输出一帧
+ * @param reader 读取端
+ * @param cur 本次快照
+ * @param prev 上次快照（按线程ID索引），为空时速率按启用以来的平均值计算
+ */
+static void print_frame(const Options& opt, const MetricsReader& reader, const MetricsSnapshot& cur,
+                        const std::map<int, MetricsThreadSnapshot>& prev, uint64_t prev_time)
+{
+    if(!opt.batch)
+    {
+        printf("\033[H\033[2J");
+    }
+    double seconds = (cur.time_ns - prev_time) / 1e9;
+    printf("%s  pid %d  threads %zu  active %lu  idle %lu  queued %lu  pending io %lu  fds %lu/%lu  interval %.2fs\n",
+           reader.getName().c_str(), reader.getPid(), cur.threads.size(), (unsigned long)cur.active_threads,
+           (unsigned long)cur.idle_threads, (unsigned long)cur.queued_tasks, (unsigned long)cur.pending_events,
+           (unsigned long)cur.fd_contexts, (unsigned long)cur.fd_table_size, seconds);
+    printf("%8s %12s %12s %10s %12s %10s %7s %5s\n",
+           "TID", "TASKS/s", "SWITCH/s", "EPOLL/s", "EVENTS/s", "TIMERS/s", "BUSY%", "STATE");
+
+    MetricsThreadSnapshot total;
+    double total_busy = 0;
+    for(const auto& t : cur.threads)
+    {
+        MetricsThreadSnapshot p;
+        auto it = prev.find(t.thread_id);
+        if(it != prev.end())
+        {
+            p = it->second;
+        }
+        uint64_t busy = t.busy_ns - std::min(p.busy_ns, t.busy_ns);
+        uint64_t idle = t.idle_ns - std::min(p.idle_ns, t.idle_ns);
+        double busy_pct = busy + idle ? 100.0 * busy / (busy + idle) : 0;
+        printf("%8d %12.0f %12.0f %10.0f %12.0f %10.0f %6.1f%% %5s\n", t.thread_id,
+               rate(t.tasks, p.tasks, seconds), rate(t.switches, p.switches, seconds),
+               rate(t.epoll_waits, p.epoll_waits, seconds), rate(t.epoll_events, p.epoll_events, seconds),
+               rate(t.timers_fired, p.timers_fired, seconds), busy_pct, t.idle ? "idle" : "busy");
+
+        total.tasks += t.tasks - std::min(p.tasks, t.tasks);
+        total.switches += t.switches - std::min(p.switches, t.switches);
+        total.epoll_waits += t.epoll_waits - std::min(p.epoll_waits, t.epoll_waits);
+        total.epoll_events += t.epoll_events - std::min(p.epoll_events, t.epoll_events);
+        total.timers_fired += t.timers_fired - std::min(p.timers_fired, t.timers_fired);
+        total_busy += busy_pct;
+    }
+    printf("%8s %12.0f %12.0f %10.0f %12.0f %10.0f %6.1f%%\n", "TOTAL",
+           rate(total.tasks, 0, seconds), rate(total.switches, 0, seconds), rate(total.epoll_waits, 0, seconds),
+           rate(total.epoll_events, 0, seconds), rate(total.timers_fired, 0, seconds),
+           cur.threads.empty() ? 0 : total_busy / cur.threads.size());
+    if(opt.batch)
+    {
+        printf("\n");
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    int c;
+    while((c = getopt(argc, argv, "i:n:bld:h")) != -1)
+    {
+        switch(c)
+        {
+        case 'i': opt.interval_ms = strtoull(optarg, nullptr, 10); break;
+        case 'n': opt.iterations = strtol(optarg, nullptr, 10); break;
+        case 'b': opt.batch = true; break;
+        case 'l': opt.list = true; break;
+        case 'd': opt.dir = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-i interval_ms] [-n iterations] [-b] [-l] [-d dir] [file|pid]\n", argv[0]);
+            return 1;
+        }
+    }
+    if(optind < argc)
+    {
+        opt.target = argv[optind];
+    }
+
+    if(opt.list)
+    {
+        for(const auto& path : MetricsReader::List(opt.dir))
+        {
+            std::unique_ptr<MetricsReader> reader = MetricsReader::Open(path);
+            printf("%s", path.c_str());
+            if(reader)
+            {
+                printf("  name=%s pid=%d%s", reader->getName().c_str(), reader->getPid(),
+                       reader->isAlive() ? "" : " (exited)");
+            }
+            printf("\n");
+        }
+        return 0;
+    }
+
+    std::string path = resolve(opt);
+    if(path.empty())
+    {
+        fprintf(stderr, "no metrics file found in %s\n", opt.dir.c_str());
+        return 1;
+    }
+    std::string error;
+    std::unique_ptr<MetricsReader> reader = MetricsReader::Open(path, &error);
+    if(!reader)
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // 第一帧的速率为启用以来的平均值
+    MetricsSnapshot snapshot;
+    std::map<int, MetricsThreadSnapshot> prev;
+    uint64_t prev_time = 0;
+    reader->read(snapshot);
+    for(const auto& t : snapshot.threads)
+    {
+        prev_time = prev_time ? std::min(prev_time, snapshot.time_ns - t.busy_ns - t.idle_ns) :
+                                snapshot.time_ns - t.busy_ns - t.idle_ns;
+    }
+    if(!prev_time)
+    {
+        prev_time = snapshot.time_ns;
+    }
+
+    for(long i = 0; opt.iterations < 0 || i < opt.iterations; ++i)
+    {
+        if(i > 0)
+        {
+            usleep(opt.interval_ms * 1000);
+            reader->read(snapshot);
+        }
+        print_frame(opt, *reader, snapshot, prev, prev_time);
+        prev.clear();
+        for(const auto& t : snapshot.threads)
+        {
+            prev[t.thread_id] = t;
+        }
+        prev_time = snapshot.time_ns;
+
+        if(!reader->isAlive())
+        {
+            printf("process %d exited\n", reader->getPid());
+            break;
+        }
+    }
+    return 0;
+}